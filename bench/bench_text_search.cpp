@@ -0,0 +1,122 @@
+// Microbenchmark: case-insensitive keyword search over log-like lines.
+//
+// Compares the SIMD core::find_ignore_case kernel against the approach it
+// replaced (lowercase a copy of each line, then std::string::find).
+//
+//   cmake -B build -DCMAKE_BUILD_TYPE=Release -DLOGSTORY_BUILD_BENCHMARKS=ON
+//   cmake --build build --target bench_text_search
+//   ./build/bench/bench_text_search [lines] [rounds]
+
+#include "logstory/core/text_search.hpp"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const std::vector<std::string_view> kKeywords = {
+    "fatal", "critical", "panic", "abort", "error", "exception", "failed",
+    "failure", "err:", "warn", "deprecated", "debug", "trace", "info", "start", "complete"
+};
+
+std::vector<std::string> make_lines(size_t count) {
+    static const char* const words[] = {
+        "request", "handled", "user", "session", "cache", "miss", "GET", "/api/v1/items",
+        "status=200", "latency=12ms", "db", "query", "pool", "connection", "opened", "closed",
+        "Retry", "Timeout", "ERROR", "Warn", "payload", "bytes=5120", "shard", "replica"
+    };
+    const size_t word_count = sizeof(words) / sizeof(words[0]);
+    
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<size_t> pick(0, word_count - 1);
+    std::uniform_int_distribution<int> length(6, 24);
+    
+    std::vector<std::string> lines;
+    lines.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        std::string line = "2024-01-15T10:00:00.000Z host-7 svc[1234]:";
+        int n = length(rng);
+        for (int w = 0; w < n; ++w) {
+            line += ' ';
+            line += words[pick(rng)];
+        }
+        lines.push_back(std::move(line));
+    }
+    return lines;
+}
+
+size_t count_lowercase_copy(const std::vector<std::string>& lines) {
+    size_t hits = 0;
+    for (const auto& line : lines) {
+        std::string lower = line;
+        std::transform(lower.begin(), lower.end(), lower.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        for (std::string_view keyword : kKeywords) {
+            if (lower.find(keyword) != std::string::npos) {
+                ++hits;
+            }
+        }
+    }
+    return hits;
+}
+
+size_t count_simd(const std::vector<std::string>& lines) {
+    size_t hits = 0;
+    for (const auto& line : lines) {
+        for (std::string_view keyword : kKeywords) {
+            if (logstory::core::contains_ignore_case(line, keyword)) {
+                ++hits;
+            }
+        }
+    }
+    return hits;
+}
+
+template <typename Fn>
+double best_seconds(Fn fn, const std::vector<std::string>& lines, int rounds, size_t& hits) {
+    double best = 1e300;
+    for (int r = 0; r < rounds; ++r) {
+        auto start = Clock::now();
+        hits = fn(lines);
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t line_count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 5;
+    
+    auto lines = make_lines(line_count);
+    size_t bytes = 0;
+    for (const auto& line : lines) {
+        bytes += line.size();
+    }
+    
+    size_t copy_hits = 0;
+    size_t simd_hits = 0;
+    double copy_s = best_seconds(count_lowercase_copy, lines, rounds, copy_hits);
+    double simd_s = best_seconds(count_simd, lines, rounds, simd_hits);
+    
+    const double mb = static_cast<double>(bytes) / (1024.0 * 1024.0);
+    std::printf("%zu lines, %.1f MB, %zu keywords, best of %d\n",
+                line_count, mb, kKeywords.size(), rounds);
+    std::printf("  lowercase copy + find : %8.2f ms  %8.1f MB/s  hits=%zu\n",
+                copy_s * 1e3, mb / copy_s, copy_hits);
+    std::printf("  find_ignore_case      : %8.2f ms  %8.1f MB/s  hits=%zu\n",
+                simd_s * 1e3, mb / simd_s, simd_hits);
+    std::printf("  speedup               : %8.2fx\n", copy_s / simd_s);
+    
+    return copy_hits == simd_hits ? 0 : 1;
+}
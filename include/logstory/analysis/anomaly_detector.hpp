@@ -1,8 +1,16 @@
 #pragma once
 
+#include "logstory/analysis/event_features.hpp"
+#include "logstory/analysis/event_view.hpp"
 #include "logstory/analysis/stats.hpp"
+#include "logstory/analysis/text_index.hpp"
 #include "logstory/core/event.hpp"
+#include <array>
 #include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace logstory::analysis {
@@ -12,7 +20,8 @@ struct Anomaly {
     enum class Type {
         ERROR_BURST,
         RESTART_LOOP,
-        MISSING_HEARTBEAT
+        MISSING_HEARTBEAT,
+        LEVEL_SHIFT
     };
     
     Type type;
@@ -21,6 +30,14 @@ struct Anomaly {
     double confidence; // 0.0 to 1.0
     std::optional<std::chrono::system_clock::time_point> start_time;
     std::optional<std::chrono::system_clock::time_point> end_time;
+    std::chrono::seconds window{0}; // Detection window, if windowed
+    std::string source;             // Source or partition it is scoped to (empty = all)
+    
+    // LEVEL_SHIFT: the series' severity and its rate (events per minute)
+    // before and after the change
+    core::Severity severity = core::Severity::UNKNOWN;
+    double rate_before = 0.0;
+    double rate_after = 0.0;
     
     Anomaly() : type(Type::ERROR_BURST), confidence(0.0) {}
 };
@@ -31,6 +48,13 @@ struct ErrorBurstConfig {
     double threshold_multiplier = 3.0; // Burst = N * baseline rate
     size_t min_errors_for_burst = 10;
     
+    // Bucket size to scan for bursts; must match a rollup level in Stats
+    // (built only when StatsConfig::rollup_resolutions is set). When unset,
+    // the base series is used unless it would exceed max_buckets, in which
+    // case the finest rollup that fits is chosen.
+    std::optional<std::chrono::minutes> resolution;
+    size_t max_buckets = 0; // 0 = no limit
+    
     ErrorBurstConfig() = default;
 };
 
@@ -40,23 +64,305 @@ public:
     explicit ErrorBurstDetector(const ErrorBurstConfig& config = ErrorBurstConfig());
     
     // Detect error bursts in event stream
-    std::vector<Anomaly> detect(const std::vector<core::Event>& events, const Stats& stats);
+    std::vector<Anomaly> detect(const EventView& events, const Stats& stats);
     
 private:
     ErrorBurstConfig config_;
     
-    double compute_baseline_rate(const Stats& stats) const;
+    const TimeSeries* select_series(const Stats& stats) const;
+    double compute_baseline_rate(const TimeSeries& error_series) const;
     std::vector<Anomaly> find_bursts(const TimeSeries& error_series, double baseline) const;
 };
 
+// Rolling-baseline burst detector configuration
+struct RollingBurstConfig {
+    std::chrono::minutes bucket_size = std::chrono::minutes(1);
+    double alpha = 0.1;               // EWMA weight of each new bucket
+    double hot_weight = 0.1;          // Fraction of alpha applied to the mean while hot
+    double sigma_threshold = 3.0;     // Hot = above mean + N * stddev ...
+    double threshold_multiplier = 3.0; // ... and at least N * mean
+    double min_relative_stddev = 0.1; // Stddev floor as a fraction of the mean
+    size_t min_errors_for_burst = 10;
+    size_t warmup_buckets = 10;       // Seed the baseline before judging buckets
+    size_t max_gap_buckets = 1440;    // Longer silences reset the baseline
+    size_t max_evidence = 10;         // Event IDs kept per burst
+    
+    RollingBurstConfig() = default;
+};
+
+// Streaming error burst detector
+// Keeps an EWMA of errors per bucket and its variance, updated in O(1) as each
+// bucket closes, so it runs while events are still arriving. The first
+// warmup_buckets buckets (again after a baseline reset) only seed the mean and
+// variance with their plain average and are never hot. After that a bucket is
+// hot when it clears both the sigma and multiplier thresholds (the stddev
+// never drops below the Poisson noise sqrt(mean), min_relative_stddev * mean,
+// or 1). Consecutive hot buckets
+// form one anomaly, emitted when the first non-hot bucket closes or on flush().
+// Hot buckets leave the variance alone and move the mean only by
+// hot_weight * alpha, so a sustained burst stays hot while a lasting level
+// shift is eventually absorbed.
+class RollingBurstDetector {
+public:
+    explicit RollingBurstDetector(const RollingBurstConfig& config = RollingBurstConfig());
+    
+    // Feed one error event; events should arrive in time order (late ones
+    // count toward the open bucket). Returns a burst closed by this event.
+    std::optional<Anomaly> add_error(std::chrono::system_clock::time_point tp,
+                                     core::EventId id = 0);
+    
+    // Feed a whole bucket; bucket starts must increase
+    std::optional<Anomaly> add_bucket(std::chrono::system_clock::time_point bucket_start,
+                                      size_t errors);
+    
+    // Close the open bucket and any burst still in progress
+    std::vector<Anomaly> flush();
+    
+    // Batch helpers on a fresh detector with this config: scan an error
+    // series (bucket_size taken from it), or the ERROR events of a
+    // time-ordered stream
+    std::vector<Anomaly> detect(const TimeSeries& error_series) const;
+    std::vector<Anomaly> detect(const EventView& events) const;
+    
+    // Scan each partition's error series against its own baseline, rolled up
+    // to bucket_size when that is a coarser multiple of the series' buckets
+    // (e.g. the resolution Stats::series_for_span picked for the overall
+    // scan); anomalies carry the partition label in `source`
+    std::vector<Anomaly> detect(const PartitionedStats& partitions,
+                                std::optional<std::chrono::minutes> bucket_size = std::nullopt) const;
+    
+    // Current expected errors per bucket
+    double baseline() const { return mean_; }
+    
+private:
+    struct Burst {
+        std::chrono::system_clock::time_point start;
+        std::chrono::system_clock::time_point end;
+        size_t errors = 0;
+        size_t peak = 0;
+        double baseline = 0.0;  // Expected errors per bucket when it started
+        double peak_ratio = 0.0;
+        std::vector<core::EventId> evidence;
+    };
+    
+    RollingBurstConfig config_;
+    double mean_ = 0.0;
+    double var_ = 0.0;
+    size_t baseline_buckets_ = 0;  // Buckets in the baseline, up to warmup_buckets
+    
+    // Bucket being filled by add_error
+    std::optional<std::chrono::system_clock::time_point> open_bucket_;
+    size_t open_count_ = 0;
+    std::vector<core::EventId> open_ids_;
+    
+    std::optional<std::chrono::system_clock::time_point> last_bucket_;
+    std::optional<Burst> burst_;
+    
+    std::chrono::system_clock::time_point bucket_of(std::chrono::system_clock::time_point tp) const;
+    std::optional<Anomaly> close_bucket(std::chrono::system_clock::time_point bucket_start,
+                                        size_t errors, const std::vector<core::EventId>& ids);
+    void update_baseline(double errors);
+    std::optional<Anomaly> end_burst();
+};
+
+// Multi-window burst detector configuration
+struct MultiWindowBurstConfig {
+    std::vector<std::chrono::seconds> windows = {
+        std::chrono::seconds(30), std::chrono::minutes(1),
+        std::chrono::minutes(5), std::chrono::minutes(15)
+    };
+    std::chrono::seconds resolution{10};            // Slot width of the count array
+    std::chrono::minutes baseline_span{60};         // Trailing history for the expected rate
+    double threshold_multiplier = 3.0;              // Hot = at least N * expected ...
+    double sigma_threshold = 3.0;                   // ... and expected + N * sqrt(expected)
+    size_t min_errors_for_burst = 10;
+    size_t max_slots = size_t(1) << 22;             // Coarsen resolution beyond this
+    size_t max_evidence = 10;
+    
+    MultiWindowBurstConfig() = default;
+};
+
+// Error burst detector over several window sizes in one pass
+// Error counts go into a dense array of `resolution` slots with prefix sums,
+// so the count of any window, and the rate over the trailing baseline_span
+// before it, are O(1). Each window size slides over the array; overlapping
+// hot windows merge into runs. Runs are then kept best-first (by how far they
+// clear their threshold), dropping any that overlap a kept run, so a sharp
+// spike is reported at 30s while a slow climb surfaces only at 15m.
+class MultiWindowBurstDetector {
+public:
+    explicit MultiWindowBurstDetector(const MultiWindowBurstConfig& config = MultiWindowBurstConfig());
+    
+    // Detect bursts among ERROR events (any order)
+    std::vector<Anomaly> detect(const EventView& events) const;
+    
+private:
+    MultiWindowBurstConfig config_;
+};
+
+// Missing-heartbeat detector configuration
+struct HeartbeatConfig {
+    std::string key_tag;                   // Stream key: this tag's value, or the source file if empty
+    double silence_multiplier = 5.0;       // Silent = gap over N * learned period ...
+    std::chrono::seconds min_silence{60};  // ... and at least this long
+    std::chrono::seconds min_interval{1};  // Arrivals closer than this are one beat
+    size_t min_intervals = 5;              // Intervals learned before a stream is judged
+    size_t max_streams = 100000;           // New streams beyond this are ignored
+    
+    // Also report streams still silent when the input ends. A source file
+    // whose rotation successor kept logging (app.log.1 ahead of app.log) is
+    // not reported; see check().
+    bool report_trailing = true;
+    
+    HeartbeatConfig() = default;
+};
+
+// Missing-heartbeat (source silence) detector
+// Each stream (a source file, or the value of key_tag) learns its typical
+// inter-arrival period online as the median of its last kGapWindow intervals,
+// so a stream costs a fixed ~80 bytes and each event O(1). Arrivals within
+// min_interval of the previous beat are folded into it, which keeps chatty
+// sources from learning a zero period. A gap longer than
+// max(silence_multiplier * period, min_silence) is a MISSING_HEARTBEAT
+// anomaly once the stream resumes; the gap itself is not learned, so an
+// outage does not stretch the period.
+class MissingHeartbeatDetector {
+public:
+    static constexpr size_t kGapWindow = 9;
+    
+    explicit MissingHeartbeatDetector(const HeartbeatConfig& config = HeartbeatConfig());
+    
+    // Feed one event (skipped without a timestamp or stream key). Returns the
+    // silence this event ends, if any.
+    std::optional<Anomaly> add_event(const core::Event& event);
+    
+    // Feed one arrival for a stream; per-stream arrivals should be in time
+    // order (older ones are ignored)
+    std::optional<Anomaly> add(const std::string& key, std::chrono::system_clock::time_point tp,
+                               core::EventId id = 0);
+    
+    // Streams that are silent at `now` (typically the end of the input).
+    // Source-keyed streams are skipped when another file of the same rotation
+    // stem (app.log.1 -> app.log) was seen after they stopped.
+    std::vector<Anomaly> check(std::chrono::system_clock::time_point now) const;
+    
+    // Batch helper on a fresh detector with this config: events in any
+    // order, then (with report_trailing) check() at the last timestamp
+    std::vector<Anomaly> detect(const EventView& events) const;
+    
+    // Learned period of a stream, once it has min_intervals intervals
+    std::optional<std::chrono::milliseconds> period(const std::string& key) const;
+    
+    size_t stream_count() const { return streams_.size(); }
+    
+private:
+    struct Stream {
+        std::chrono::system_clock::time_point last_seen;
+        std::chrono::system_clock::time_point beat;  // Start of the current interval
+        core::EventId last_id = 0;
+        std::array<float, kGapWindow> gaps{};        // Recent intervals in seconds (ring)
+        uint32_t intervals = 0;                      // Intervals learned (saturating)
+        uint8_t next = 0;                            // Ring position
+    };
+    
+    HeartbeatConfig config_;
+    std::unordered_map<std::string, Stream> streams_;
+    
+    double period_seconds(const Stream& stream) const;
+    double threshold_seconds(const Stream& stream) const;
+    Anomaly make_silence(const std::string& key, const Stream& stream,
+                         std::chrono::system_clock::time_point end,
+                         std::optional<core::EventId> resume_id) const;
+};
+
+// Change-point detector configuration
+struct ChangePointConfig {
+    size_t warmup_buckets = 10;        // Buckets that set the reference level
+    double drift = 0.5;                // CUSUM slack k, in reference sigmas
+    double threshold = 5.0;            // CUSUM decision level h, in reference sigmas
+    double z_clip = 4.0;               // Per-bucket deviation cap, so one spike cannot trip it
+    size_t confirm_buckets = 5;        // All but one of these recent buckets must have moved ...
+    double min_relative_change = 0.5;  // ... by at least this fraction of the reference
+    size_t min_events = 5;             // Events in the shifted run (at the higher level)
+    size_t max_gap_buckets = 1440;     // Longer gaps restart the warm-up
+    
+    ChangePointConfig() = default;
+};
+
+// Level-shift detector for event-count series (two-sided CUSUM)
+// The first warmup_buckets set a reference mean and sigma (never below the
+// Poisson noise sqrt(mean), or 0.5). Each later bucket adds its clipped
+// z-score minus `drift` to an upper and a lower cumulative sum; a sum that
+// passes `threshold` while recent buckets agree is a LEVEL_SHIFT
+// dated to where that sum left zero, with the rate before (reference) and
+// after (mean since the change). Detection then re-learns the reference, so
+// each bucket costs O(1) and a lasting shift is reported once. Short spikes
+// are left to the burst detectors.
+class ChangePointDetector {
+public:
+    explicit ChangePointDetector(const ChangePointConfig& config = ChangePointConfig());
+    
+    // Feed one bucket; starts must increase. Buckets skipped since the last
+    // call count as zero. Returns the shifts this bucket completes.
+    std::vector<Anomaly> add_bucket(std::chrono::system_clock::time_point bucket_start,
+                                    size_t count);
+    
+    // Batch helper on a fresh detector with this config: scan a series, with
+    // zero buckets from `from` and up to `to` (when given) so quiet stretches
+    // before the first and after the last event count
+    std::vector<Anomaly> detect(const TimeSeries& series,
+                                std::optional<std::chrono::system_clock::time_point> from = std::nullopt,
+                                std::optional<std::chrono::system_clock::time_point> to = std::nullopt) const;
+    
+    // Every severity series in `stats`, over the stats time range
+    std::vector<Anomaly> detect(const Stats& stats) const;
+    
+    // One severity's events per source file, each over that source's time range
+    std::vector<Anomaly> detect_by_source(const EventView& events, core::Severity sev,
+                                          std::chrono::minutes bucket_size = std::chrono::minutes(1)) const;
+    
+    // Bucket size used to fill gaps and express rates per minute
+    void set_bucket_size(std::chrono::minutes bucket_size) { bucket_size_ = bucket_size; }
+    
+private:
+    struct Run {
+        std::chrono::system_clock::time_point start;
+        double sum = 0.0;
+        size_t buckets = 0;
+    };
+    
+    ChangePointConfig config_;
+    std::chrono::minutes bucket_size_{1};
+    
+    // Warm-up (Welford) and the reference it produces
+    size_t warm_n_ = 0;
+    double warm_mean_ = 0.0;
+    double warm_m2_ = 0.0;
+    double ref_mean_ = 0.0;
+    double ref_sigma_ = 1.0;
+    
+    double s_hi_ = 0.0;
+    double s_lo_ = 0.0;
+    Run hi_run_;
+    Run lo_run_;
+    
+    // Last confirm_buckets counts (ring)
+    std::vector<double> recent_;
+    size_t recent_next_ = 0;
+    size_t recent_n_ = 0;
+    
+    std::optional<std::chrono::system_clock::time_point> last_bucket_;
+    
+    void reset();
+    std::optional<Anomaly> step(std::chrono::system_clock::time_point bucket_start, double count);
+    Anomaly make_shift(const Run& run, std::chrono::system_clock::time_point bucket_start) const;
+};
+
 // Restart loop detector configuration
 struct RestartLoopConfig {
     size_t min_restart_count = 3;
     std::chrono::minutes time_window = std::chrono::minutes(10);
-    std::vector<std::string> restart_keywords = {
-        "starting", "started", "shutdown", "stopping", "stopped",
-        "restarting", "restart", "initializing", "initialized"
-    };
+    std::vector<std::string> restart_keywords = default_keywords(Feature::RESTART);
     
     RestartLoopConfig() = default;
 };
@@ -67,14 +373,26 @@ public:
     explicit RestartLoopDetector(const RestartLoopConfig& config = RestartLoopConfig());
     
     // Detect restart loops in event stream
-    std::vector<Anomaly> detect(const std::vector<core::Event>& events);
+    std::vector<Anomaly> detect(const EventView& events);
+    
+    // Same, taking restart candidates from a text index built over `events`
+    std::vector<Anomaly> detect(const EventView& events,
+                                const TextIndex& text_index);
+    
+    // Same, taking restart candidates from the RESTART feature bit; falls
+    // back to scanning when the features weren't built over `events` with
+    // restart_keywords
+    std::vector<Anomaly> detect(const EventView& events,
+                                const EventFeatures& features);
     
 private:
     RestartLoopConfig config_;
     
     bool is_restart_event(const core::Event& event) const;
+    std::vector<Anomaly> detect_from(const std::vector<size_t>& restart_indices,
+                                     const EventView& events) const;
     std::vector<Anomaly> find_loops(const std::vector<size_t>& restart_indices, 
-                                     const std::vector<core::Event>& events) const;
+                                     const EventView& events) const;
 };
 
 } // namespace logstory::analysis
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "logstory/analysis/event_view.hpp"
+#include "logstory/core/event.hpp"
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace logstory::analysis {
+
+/// Configuration for cross-source clock skew estimation
+struct ClockSkewConfig {
+    /// Correlation tags joined across sources (see CorrelationExtractor)
+    std::vector<std::string> id_keys = {"request_id", "trace_id"};
+    
+    /// Shared IDs a pair of sources needs before its delta is trusted
+    size_t min_shared_ids = 3;
+    
+    /// IDs seen on more events than this are not request-scoped (e.g. a
+    /// constant placeholder) and are skipped
+    size_t max_events_per_id = 64;
+    
+    /// Per-ID deltas beyond this are a reused ID, not one request
+    std::chrono::milliseconds max_delta = std::chrono::hours(1);
+    
+    /// Offsets below this are left uncorrected: a delta also contains the
+    /// request's propagation time, so sub-second offsets are mostly latency
+    std::chrono::milliseconds min_offset = std::chrono::seconds(1);
+    
+    ClockSkewConfig() = default;
+};
+
+/// Estimated clock offset of one source relative to the reference source of
+/// its group (sources connected through shared IDs)
+struct SourceOffset {
+    std::string source;
+    std::chrono::milliseconds offset{0}; // How far this source's clock runs ahead
+    size_t shared_ids = 0;               // IDs shared with other sources
+    bool reference = false;              // Pinned to zero for its group
+    bool applied = false;                // At least min_offset, so corrected
+};
+
+/// Result of ClockSkewEstimator::estimate
+struct ClockSkewEstimate {
+    std::vector<SourceOffset> offsets; // Sorted by source path
+    size_t joined_ids = 0;             // IDs seen in two or more sources
+    
+    bool empty() const { return offsets.empty(); }
+    
+    /// Offset entry for a source, or nullptr if it shares no IDs
+    const SourceOffset* find(const std::string& source) const;
+    
+    /// Number of sources whose timestamps are corrected
+    size_t applied_count() const;
+};
+
+/// Estimates per-source clock offsets from events that share a correlation ID
+/// across sources, so timestamps from hosts whose clocks disagree can be
+/// compared.
+///
+/// IDs are hash-joined in one pass: each (key, value) maps to a dense slot,
+/// occurrences are bucketed by slot with a counting sort, and each ID that
+/// reached several sources contributes the delta between the sources' first
+/// sightings. Each source pair's delta is the median of its per-ID deltas,
+/// which shrugs off retries and slow requests. The per-source offsets then
+/// solve the weighted least-squares problem over the pair graph (weights are
+/// shared-ID counts), with the best-connected source of each group pinned to
+/// zero. Memory is linear in the number of tagged events.
+class ClockSkewEstimator {
+public:
+    explicit ClockSkewEstimator(const ClockSkewConfig& config = ClockSkewConfig());
+    
+    /// Estimate offsets; the result is empty when no ID spans two sources
+    ClockSkewEstimate estimate(const EventView& events) const;
+    
+    /// Shift the timestamps of sources with an applied offset back onto the
+    /// reference clock. Returns the number of events changed.
+    static size_t apply(const ClockSkewEstimate& estimate, std::vector<core::Event>& events);
+
+private:
+    ClockSkewConfig config_;
+};
+
+} // namespace logstory::analysis
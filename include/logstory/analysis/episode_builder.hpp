@@ -1,9 +1,13 @@
 #pragma once
 
 #include "logstory/analysis/episode.hpp"
+#include "logstory/analysis/event_view.hpp"
 #include "logstory/core/event.hpp"
 #include <vector>
 #include <chrono>
+#include <functional>
+#include <optional>
+#include <string>
 #include <unordered_set>
 
 namespace logstory::analysis {
@@ -15,38 +19,112 @@ struct EpisodeConfig {
     
     /// Whether to merge episodes with shared correlation IDs
     bool merge_by_correlation = true;
+    
+    /// Whether correlation merging also joins non-adjacent episodes
+    /// (e.g. a request resuming after a gap with another burst in between)
+    bool merge_across_gaps = true;
+    
+    /// Upper bound on events in a correlation-merged episode, so a hot shared
+    /// ID (health checks, a shared session) can't collapse the whole run
+    size_t max_merged_episode_events = 50000;
 };
 
-/// Builds episodes from a sequence of events
-class EpisodeBuilder {
+/// Builds episodes incrementally from an event stream
+///
+/// Events are fed one at a time in store order. Episode metadata (time range,
+/// max severity, highlights, correlation IDs) is maintained as events arrive,
+/// and finished episodes are handed to the callback once a time gap closes
+/// them. Memory is bounded by the open episode plus the one held back for a
+/// possible correlation merge with its successor.
+class StreamingEpisodeBuilder {
 public:
-    explicit EpisodeBuilder(EpisodeConfig config = EpisodeConfig())
-        : config_(config), next_episode_id_(1) {}
+    using EmitFn = std::function<void(Episode&&)>;
     
-    /// Build episodes from events
-    std::vector<Episode> build(const std::vector<core::Event>& events);
+    StreamingEpisodeBuilder(EpisodeConfig config, EmitFn emit, uint64_t first_episode_id = 1);
+    
+    /// Add the next event of the stream
+    void add(const core::Event& event);
+    
+    /// Close and emit all remaining episodes (call once at end of stream)
+    void flush();
+    
+    /// ID that the next opened episode will receive
+    uint64_t next_episode_id() const { return next_episode_id_; }
+    
+    /// Number of episodes currently held in memory
+    size_t open_episode_count() const;
 
 private:
+    /// Episode under construction plus running state for its highlights
+    struct OpenEpisode {
+        Episode episode;
+        std::unordered_set<std::string> corr_set;
+        core::EventId first_error_id = 0;
+        core::EventId max_severity_id = 0;
+        core::Severity max_severity_seen = core::Severity::UNKNOWN;
+    };
+    
     EpisodeConfig config_;
+    EmitFn emit_;
     uint64_t next_episode_id_;
     
-    /// Check if there's a significant time gap between events
-    bool has_time_gap(const core::Event& prev, const core::Event& next) const;
+    std::optional<OpenEpisode> current_;
+    std::optional<OpenEpisode> pending_;  // Closed, awaiting merge decision
+    std::optional<core::Timestamp> prev_ts_;
+    bool has_prev_ = false;
+    
+    /// Check if there's a significant time gap between consecutive events
+    bool has_time_gap(const std::optional<core::Timestamp>& prev,
+                      const std::optional<core::Timestamp>& next) const;
     
-    /// Extract correlation IDs from an event
-    std::vector<std::string> get_correlation_ids(const core::Event& event) const;
+    /// Fold one event into an open episode's metadata
+    void absorb(OpenEpisode& open, const core::Event& event) const;
+    
+    /// Close the current episode: merge into pending or emit pending
+    void close_current();
+    
+    /// Finalize highlights of a closed episode segment
+    static void finalize_highlights(OpenEpisode& open);
     
     /// Check if two episodes share correlation IDs
-    bool share_correlation_ids(const Episode& ep1, const Episode& ep2) const;
+    static bool share_correlation_ids(const OpenEpisode& a, const OpenEpisode& b);
+    
+    /// Append a later episode onto an earlier one without copying event IDs twice
+    static void merge_into(OpenEpisode& target, OpenEpisode&& source);
+    
+    /// Emit an episode to the callback
+    void emit(OpenEpisode&& open);
+};
+
+/// Merges episodes that share any correlation ID, adjacent or not
+///
+/// Each request_id/trace_id maps to a union-find set of episodes, so grouping
+/// is near-linear in the number of (episode, correlation ID) pairs. Unions that
+/// would exceed max_merged_episode_events are skipped.
+class CorrelationGrouper {
+public:
+    explicit CorrelationGrouper(EpisodeConfig config = EpisodeConfig())
+        : config_(config) {}
     
-    /// Merge two episodes
-    Episode merge_episodes(const Episode& ep1, const Episode& ep2);
+    /// Group episodes (in stream order); merged episodes keep the earliest ID
+    std::vector<Episode> group(std::vector<Episode>&& episodes) const;
     
-    /// Identify key events in an episode
-    void identify_highlights(Episode& episode, const std::vector<core::Event>& events);
+private:
+    EpisodeConfig config_;
+};
+
+/// Builds episodes from a sequence of events
+class EpisodeBuilder {
+public:
+    explicit EpisodeBuilder(EpisodeConfig config = EpisodeConfig())
+        : config_(config), next_episode_id_(1) {}
     
-    /// Update episode metadata (times, severity, correlation IDs)
-    void update_metadata(Episode& episode, const std::vector<core::Event>& events);
+    /// Build episodes from events
+    std::vector<Episode> build(const EventView& events);
+
+private:
+    EpisodeConfig config_;
+    uint64_t next_episode_id_;
 };
 
 } // namespace logstory::analysis
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "logstory/analysis/event_view.hpp"
+#include "logstory/core/event.hpp"
+#include "logstory/core/thread_pool.hpp"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace logstory::analysis {
+
+/// Keyword features detected in an event message, one bit each
+enum class Feature : uint32_t {
+    RESTART = 1u << 0,
+    CHANGE = 1u << 1,
+    RETRY = 1u << 2,
+    TIMEOUT = 1u << 3
+};
+
+using FeatureMask = uint32_t;
+
+inline constexpr FeatureMask feature_bit(Feature f) { return static_cast<FeatureMask>(f); }
+
+/// Case-insensitive multi-keyword matcher (Aho-Corasick)
+///
+/// Keywords compile to a DFA over a compact alphabet: bytes that occur in
+/// some keyword (either case) get their own class, everything else shares
+/// one. scan() is then a single table lookup per input byte and reports the
+/// union of the features of every keyword found.
+class KeywordAutomaton {
+public:
+    KeywordAutomaton();
+    
+    /// Register a keyword (ASCII, any case) for a feature; call build() after
+    void add(std::string_view keyword, FeatureMask features);
+    
+    /// Compile the DFA
+    void build();
+    
+    /// Features of all keywords occurring in text
+    FeatureMask scan(std::string_view text) const;
+    
+    size_t state_count() const { return output_.size(); }
+
+private:
+    uint8_t classes_[256];
+    size_t class_count_ = 1;                // Class 0 = bytes in no keyword
+    std::vector<std::vector<int32_t>> goto_; // Trie edges per state, -1 = none
+    std::vector<FeatureMask> output_;       // Features matched on entering a state
+    std::vector<uint32_t> next_;            // DFA: state * class_count_ + class
+    FeatureMask all_features_ = 0;
+    bool built_ = false;
+    
+    uint8_t class_of(unsigned char c);
+};
+
+/// Built-in keywords behind a feature; the single list that feature
+/// extraction, RestartLoopConfig and the built-in rules all default to
+const std::vector<std::string>& default_keywords(Feature f);
+
+/// Keywords behind each feature
+struct EventFeatureConfig {
+    std::vector<std::string> restart_keywords = default_keywords(Feature::RESTART);
+    std::vector<std::string> change_keywords = default_keywords(Feature::CHANGE);
+    std::vector<std::string> retry_keywords = default_keywords(Feature::RETRY);
+    std::vector<std::string> timeout_keywords = default_keywords(Feature::TIMEOUT);
+    
+    EventFeatureConfig() = default;
+    
+    /// Keywords configured for a feature
+    const std::vector<std::string>& keywords(Feature f) const;
+};
+
+/// Per-event feature bitmasks, extracted in one pass over the messages
+///
+/// Detectors and rules read bits by store position instead of rescanning
+/// message text for their own keywords. Like TextIndex, positions index the
+/// event view the features were built from.
+class EventFeatures {
+public:
+    explicit EventFeatures(const EventFeatureConfig& config = EventFeatureConfig());
+    
+    /// Scan every message once; chunks run on the pool when one is given
+    void build(const EventView& events, core::ThreadPool* pool = nullptr);
+    
+    /// Features of one message, using the configured keywords
+    FeatureMask classify(std::string_view message) const { return automaton_.scan(message); }
+    
+    /// Whether the bits of `f` were extracted with exactly these keywords;
+    /// consumers with their own keyword list check this before using bits
+    bool matches_keywords(Feature f, const std::vector<std::string>& keywords) const {
+        return config_.keywords(f) == keywords;
+    }
+    
+    FeatureMask mask(size_t pos) const { return masks_[pos]; }
+    bool has(size_t pos, Feature f) const { return (masks_[pos] & feature_bit(f)) != 0; }
+    
+    /// Ascending view positions of events with the feature
+    std::vector<size_t> positions(Feature f) const;
+    
+    size_t size() const { return masks_.size(); }
+
+private:
+    EventFeatureConfig config_;
+    KeywordAutomaton automaton_;
+    std::vector<FeatureMask> masks_;
+};
+
+} // namespace logstory::analysis
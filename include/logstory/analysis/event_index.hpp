@@ -1,25 +1,33 @@
 #pragma once
 
+#include "logstory/analysis/event_view.hpp"
+#include "logstory/analysis/posting_list.hpp"
 #include "logstory/core/event.hpp"
 #include "logstory/core/severity.hpp"
+#include <array>
 #include <vector>
 #include <unordered_map>
-#include <map>
+#include <cstdint>
+#include <utility>
 #include <chrono>
 
 namespace logstory::analysis {
 
 /// Index for fast event queries by time, severity, and correlation IDs
+///
+/// The index refers to an event view rather than copying events; the viewed
+/// store must outlive the index and must not be reallocated while it is in
+/// use. Positions index the view. ID lists are kept as compressed posting
+/// lists that can be combined with AND/OR.
 class EventIndex {
 public:
     using TimePoint = std::chrono::system_clock::time_point;
-    using TimeBucket = std::chrono::minutes;
     
-    /// Build index from a list of events
-    void build(const std::vector<core::Event>& events);
+    /// Build index over an event view (events not copied)
+    void build(const EventView& events);
     
     /// Get all events in the index
-    const std::vector<core::Event>& get_all_events() const { return events_; }
+    const EventView& get_all_events() const { return events_; }
     
     /// Get events by severity
     std::vector<core::EventId> get_by_severity(core::Severity sev) const;
@@ -27,26 +35,55 @@ public:
     /// Get events by correlation ID (request_id or trace_id)
     std::vector<core::EventId> get_by_correlation_id(const std::string& corr_id) const;
     
-    /// Get events in a time range (if timestamps available)
+    /// Get events with start <= ts <= end, in time order (timestamped events only)
     std::vector<core::EventId> get_by_time_range(TimePoint start, TimePoint end) const;
     
+    /// View positions of events with start <= ts <= end, in time order
+    std::vector<size_t> get_indices_by_time_range(TimePoint start, TimePoint end) const;
+    
+    /// Number of timestamped events with start <= ts <= end, O(log n)
+    size_t count_in_time_range(TimePoint start, TimePoint end) const;
+    
+    /// Number of events of a severity with start <= ts <= end, O(log n)
+    size_t count_by_severity_in_time_range(core::Severity sev, TimePoint start, TimePoint end) const;
+    
     /// Get count by severity
     size_t count_by_severity(core::Severity sev) const;
     
+    /// Posting list for a severity (empty list if none)
+    const PostingList& severity_postings(core::Severity sev) const;
+    
+    /// Posting list for a correlation ID (empty list if none)
+    const PostingList& correlation_postings(const std::string& corr_id) const;
+    
+    /// Events at or above a severity (OR across severity lists)
+    PostingList severity_at_least(core::Severity min_sev) const;
+    
 private:
-    std::vector<core::Event> events_;
+    static constexpr size_t kSeverityCount = static_cast<size_t>(core::Severity::FATAL) + 1;
+    
+    EventView events_;
+    
+    // Severity index: Severity -> event IDs
+    std::array<PostingList, kSeverityCount> severity_index_;
+    
+    // Correlation index: correlation_id -> event IDs
+    std::unordered_map<std::string, PostingList> correlation_index_;
     
-    // Severity index: Severity -> list of event IDs
-    std::unordered_map<core::Severity, std::vector<core::EventId>> severity_index_;
+    /// Timestamped event, ordered by (tp, index)
+    struct TimeEntry {
+        TimePoint tp;
+        size_t index;  // Position in the view
+    };
     
-    // Correlation index: correlation_id -> list of event IDs
-    std::unordered_map<std::string, std::vector<core::EventId>> correlation_index_;
+    // Time index: all timestamped events sorted by timestamp
+    std::vector<TimeEntry> time_index_;
     
-    // Time index: time bucket -> list of event IDs
-    std::map<int64_t, std::vector<core::EventId>> time_index_;
+    // severity_prefix_[s][i] = events of severity s among time_index_[0..i)
+    std::array<std::vector<uint32_t>, kSeverityCount> severity_prefix_;
     
-    /// Convert time_point to bucket key (minutes since epoch)
-    int64_t time_to_bucket(TimePoint tp) const;
+    /// Half-open range [first, last) of time_index_ covering start <= ts <= end
+    std::pair<size_t, size_t> time_range_bounds(TimePoint start, TimePoint end) const;
 };
 
 } // namespace logstory::analysis
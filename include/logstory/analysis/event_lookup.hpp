@@ -0,0 +1,63 @@
+#pragma once
+
+#include "logstory/analysis/event_view.hpp"
+#include "logstory/core/event.hpp"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace logstory::analysis {
+
+/// O(1) EventId -> position mapping over an event view, built once and
+/// shared by analysis, rules and narrative code instead of per-call scans.
+/// Positions index the view (store positions for a whole-store view).
+///
+/// EventParser hands out sequential IDs, so the common case is a contiguous
+/// range resolved by subtraction. Filtered stores (e.g. after --since) leave
+/// gaps; those use a dense offset table while the ID range stays compact,
+/// and fall back to a hash map only for arbitrary ID sets.
+class EventLookup {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    EventLookup() = default;
+
+    /// Build the mapping for an event view. The viewed store must outlive the
+    /// lookup and must not be reallocated while the lookup is in use.
+    explicit EventLookup(const EventView& events);
+
+    /// Rebuild the mapping for a (possibly different) event view
+    void build(const EventView& events);
+
+    /// Position of an event in the view, or npos if unknown
+    size_t index_of(core::EventId id) const;
+
+    /// Event with the given ID, or nullptr if unknown
+    const core::Event* find(core::EventId id) const;
+
+    /// Whether the ID belongs to the view
+    bool contains(core::EventId id) const { return index_of(id) != npos; }
+
+    /// Number of events covered by the lookup
+    size_t size() const { return events_.size(); }
+
+private:
+    enum class Mode {
+        EMPTY,
+        CONTIGUOUS,    // id == base_id_ + index
+        OFFSET_TABLE,  // offsets_[id - base_id_] holds index (or npos)
+        HASHED         // hashed_ maps id -> index
+    };
+
+    /// Offset tables are used while the ID span is at most this many times
+    /// the event count; sparser stores use the hash map.
+    static constexpr uint64_t kMaxSpanFactor = 4;
+
+    EventView events_;
+    Mode mode_ = Mode::EMPTY;
+    core::EventId base_id_ = 0;
+    std::vector<size_t> offsets_;
+    std::unordered_map<core::EventId, size_t> hashed_;
+};
+
+} // namespace logstory::analysis
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "logstory/core/error.hpp"
+#include "logstory/core/event.hpp"
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace logstory::analysis {
+
+/// Read-only view of an event store: the whole store, or a selection vector
+/// of ascending store positions (e.g. from a time window or a --where query).
+///
+/// Views never copy events; narrowing a view copies positions only. Batch
+/// analysis APIs take an EventView, and a std::vector<Event> lvalue converts
+/// to a whole-store view implicitly, so existing callers are unchanged; views
+/// of temporary vectors are rejected at compile time. The store must outlive
+/// the view and must not be reallocated while it is in use.
+class EventView {
+public:
+    class const_iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = core::Event;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const core::Event*;
+        using reference = const core::Event&;
+        
+        const_iterator() = default;
+        const_iterator(const EventView* view, size_t i) : view_(view), i_(i) {}
+        
+        reference operator*() const { return (*view_)[i_]; }
+        pointer operator->() const { return &(*view_)[i_]; }
+        reference operator[](difference_type n) const { return (*view_)[i_ + n]; }
+        
+        const_iterator& operator++() { ++i_; return *this; }
+        const_iterator operator++(int) { auto old = *this; ++i_; return old; }
+        const_iterator& operator--() { --i_; return *this; }
+        const_iterator operator--(int) { auto old = *this; --i_; return old; }
+        const_iterator& operator+=(difference_type n) { i_ += n; return *this; }
+        const_iterator& operator-=(difference_type n) { i_ -= n; return *this; }
+        const_iterator operator+(difference_type n) const { return {view_, i_ + n}; }
+        const_iterator operator-(difference_type n) const { return {view_, i_ - n}; }
+        friend const_iterator operator+(difference_type n, const const_iterator& it) { return it + n; }
+        difference_type operator-(const const_iterator& other) const {
+            return static_cast<difference_type>(i_) - static_cast<difference_type>(other.i_);
+        }
+        
+        bool operator==(const const_iterator& other) const { return i_ == other.i_; }
+        bool operator!=(const const_iterator& other) const { return i_ != other.i_; }
+        bool operator<(const const_iterator& other) const { return i_ < other.i_; }
+        bool operator>(const const_iterator& other) const { return i_ > other.i_; }
+        bool operator<=(const const_iterator& other) const { return i_ <= other.i_; }
+        bool operator>=(const const_iterator& other) const { return i_ >= other.i_; }
+    
+    private:
+        const EventView* view_ = nullptr;
+        size_t i_ = 0;
+    };
+    
+    EventView() = default;
+    
+    /// Whole-store view; implicit so vectors can be passed where views are taken
+    EventView(const std::vector<core::Event>& events) : store_(&events) {}
+    EventView(std::vector<core::Event>&&) = delete;
+    
+    /// Selection of `positions` (ascending, each < events.size())
+    EventView(const std::vector<core::Event>& events, std::vector<size_t> positions);
+    EventView(std::vector<core::Event>&&, std::vector<size_t>) = delete;
+    
+    size_t size() const {
+        if (!store_) {
+            return 0;
+        }
+        return full_ ? store_->size() : positions_.size();
+    }
+    bool empty() const { return size() == 0; }
+    
+    /// True if the view covers every event of its store
+    bool is_full() const { return full_ || size() == store_size(); }
+    
+    const core::Event& operator[](size_t i) const {
+        return full_ ? (*store_)[i] : (*store_)[positions_[i]];
+    }
+    
+    /// Store position of the i-th event in the view
+    size_t position(size_t i) const { return full_ ? i : positions_[i]; }
+    
+    const std::vector<core::Event>* store() const { return store_; }
+    
+    const_iterator begin() const { return {this, 0}; }
+    const_iterator end() const { return {this, size()}; }
+    
+    /// Narrower view of the events matching `pred`, in the same order
+    template <typename Pred>
+    EventView where(Pred&& pred) const {
+        std::vector<size_t> kept;
+        for (size_t i = 0; i < size(); ++i) {
+            if (pred((*this)[i])) {
+                kept.push_back(i);
+            }
+        }
+        return subset(std::move(kept));
+    }
+    
+    /// Narrower view of the events at `indices` (ascending indices into this
+    /// view, not store positions)
+    EventView subset(std::vector<size_t> indices) const;
+    
+    /// Copies of the viewed events, for callers that need an owned store
+    std::vector<core::Event> materialize() const;
+    
+    /// Keep only the viewed events in `store`: selected events are moved to the
+    /// front in order and the tail erased, so no event is copied. The view is
+    /// empty afterwards (its store changed). Fails with INVALID_INPUT, leaving
+    /// both untouched, if `store` is not the viewed store.
+    core::Status compact(std::vector<core::Event>& store);
+
+private:
+    const std::vector<core::Event>* store_ = nullptr;
+    bool full_ = true;
+    std::vector<size_t> positions_;
+    
+    size_t store_size() const { return store_ ? store_->size() : 0; }
+};
+
+} // namespace logstory::analysis
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "logstory/core/severity.hpp"
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace logstory::analysis {
+
+/// Bounded-memory heavy-hitter summary over string keys (SpaceSaving)
+///
+/// Keeps at most `capacity` counters. When a new key arrives and the summary
+/// is full, it takes over the smallest counter and inherits that count as its
+/// error. Every key whose true count exceeds total / capacity is tracked, a
+/// tracked count overstates the truth by at most its `error`, and untracked
+/// keys occurred at most error_bound() times. Summaries merge by summing
+/// counters (absent keys get the other side's minimum) and keeping the
+/// largest `capacity`, so per-thread or per-shard summaries combine with the
+/// same guarantees. Below capacity all counts are exact.
+class HeavyHitters {
+public:
+    struct Counter {
+        std::string key;
+        size_t count = 0;   // Upper bound on the true count
+        size_t error = 0;   // count - error is a lower bound
+        core::Severity max_severity = core::Severity::UNKNOWN;
+        
+        size_t guaranteed_count() const { return count - error; }
+    };
+    
+    explicit HeavyHitters(size_t capacity = 4096);
+    
+    /// Counters needed so no count errs by more than epsilon * total
+    static size_t capacity_for_error(double epsilon);
+    
+    /// Counters that fit in roughly `bytes`, given the average key length
+    static size_t capacity_for_budget(size_t bytes, size_t avg_key_bytes = 64);
+    
+    void add(const std::string& key, core::Severity sev, size_t count = 1);
+    void merge(const HeavyHitters& other);
+    
+    /// Largest n counters by count (ties by key)
+    std::vector<Counter> top(size_t n) const;
+    
+    /// Most an untracked key can have occurred (0 while below capacity)
+    size_t error_bound() const;
+    
+    size_t capacity() const { return capacity_; }
+    size_t size() const { return counters_.size(); }
+    size_t total() const { return total_; }
+    bool empty() const { return counters_.empty(); }
+
+private:
+    size_t capacity_;
+    size_t total_ = 0;
+    std::vector<Counter> counters_;
+    std::unordered_map<std::string, size_t> index_;  // key -> counters_ position
+    std::vector<size_t> heap_;                       // Min-heap of positions by count
+    std::vector<size_t> heap_slot_;                  // Position -> slot in heap_
+    
+    bool full() const { return counters_.size() >= capacity_; }
+    bool heap_less(size_t a, size_t b) const;
+    void heap_swap(size_t a, size_t b);
+    void sift_up(size_t slot);
+    void sift_down(size_t slot);
+    void rebuild(std::vector<Counter> counters);
+};
+
+} // namespace logstory::analysis
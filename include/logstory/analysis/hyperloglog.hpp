@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace logstory::analysis {
+
+/// Mergeable distinct-count sketch
+///
+/// Counts exactly (a set of 64-bit value hashes) until kExactThreshold
+/// distinct values, then switches to 2^kPrecision HyperLogLog registers
+/// (about 1.6% standard error in 4 KB). Merging takes the union of the
+/// exact sets or the register-wise max, so sketches from parallel workers
+/// combine without loss.
+class HyperLogLog {
+public:
+    static constexpr int kPrecision = 12;
+    static constexpr size_t kRegisters = size_t(1) << kPrecision;
+    static constexpr size_t kExactThreshold = 256;
+    
+    HyperLogLog() = default;
+    
+    void add(std::string_view value);
+    void add_hash(uint64_t hash);
+    void merge(const HyperLogLog& other);
+    
+    /// Estimated number of distinct values (exact while is_exact())
+    size_t estimate() const;
+    
+    bool is_exact() const { return registers_.empty(); }
+    bool empty() const { return registers_.empty() && exact_.empty(); }
+    
+    /// 64-bit value hash used by add()
+    static uint64_t hash(std::string_view value);
+
+private:
+    std::unordered_set<uint64_t> exact_;  // Value hashes while exact
+    std::vector<uint8_t> registers_;      // Empty while exact
+    
+    void to_registers();
+    void update_register(uint64_t hash);
+};
+
+} // namespace logstory::analysis
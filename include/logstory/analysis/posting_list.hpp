@@ -0,0 +1,92 @@
+#pragma once
+
+#include "logstory/core/event.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace logstory::analysis {
+
+/// Compressed, strictly ascending list of event IDs
+///
+/// IDs are stored as varint-encoded deltas, so runs of nearby IDs cost about
+/// one byte each. Every kSkipInterval entries a skip point records the ID and
+/// byte offset, letting a cursor jump ahead in O(log n) during intersections.
+class PostingList {
+public:
+    /// Entries between skip points
+    static constexpr size_t kSkipInterval = 128;
+    
+    /// Forward cursor over a posting list
+    class Cursor {
+    public:
+        explicit Cursor(const PostingList& list);
+        
+        /// Whether the cursor points at an entry
+        bool valid() const { return valid_; }
+        
+        /// Current ID (only if valid())
+        core::EventId value() const { return value_; }
+        
+        /// Advance to the next entry
+        void next();
+        
+        /// Advance to the first entry >= target
+        void seek(core::EventId target);
+    
+    private:
+        const PostingList* list_;
+        size_t offset_ = 0;   // Byte offset of the next undecoded entry
+        size_t ordinal_ = 0;  // Index of the current entry
+        core::EventId value_ = 0;
+        bool valid_ = false;
+        
+        void decode_next();
+    };
+    
+    PostingList() = default;
+    
+    /// Encode an arbitrary ID list (sorted and de-duplicated first)
+    static PostingList from_ids(std::vector<core::EventId> ids);
+    
+    /// Append an ID; must be greater than the last one (returns false otherwise)
+    bool append(core::EventId id);
+    
+    /// Number of IDs in the list
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    
+    /// Encoded size in bytes (excluding skip points)
+    size_t byte_size() const { return bytes_.size(); }
+    
+    /// Whether the list contains an ID
+    bool contains(core::EventId id) const;
+    
+    /// Decode all IDs in ascending order
+    std::vector<core::EventId> decode() const;
+    
+    Cursor cursor() const { return Cursor(*this); }
+    
+    /// IDs present in both lists
+    static PostingList intersect(const PostingList& a, const PostingList& b);
+    
+    /// IDs present in either list
+    static PostingList unite(const PostingList& a, const PostingList& b);
+    
+    /// Intersection / union of any number of lists (smallest lists first for AND)
+    static PostingList intersect_all(const std::vector<const PostingList*>& lists);
+    static PostingList unite_all(const std::vector<const PostingList*>& lists);
+
+private:
+    struct SkipPoint {
+        core::EventId id;   // ID of the entry at this point
+        size_t offset;      // Byte offset just past that entry
+        size_t ordinal;     // Index of that entry
+    };
+    
+    std::vector<uint8_t> bytes_;
+    std::vector<SkipPoint> skips_;
+    size_t size_ = 0;
+    core::EventId last_ = 0;
+};
+
+} // namespace logstory::analysis
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace logstory::analysis {
+
+/// Mergeable quantile sketch with relative-error guarantees (DDSketch)
+///
+/// Values map to logarithmic bins of ratio gamma = (1 + a) / (1 - a), so any
+/// quantile is returned within relative error `a` of the true value. Bins are
+/// dense per sign and capped at `max_bins`; past that the bins nearest zero
+/// are folded together, which only costs accuracy at the low end. Merging
+/// adds bin counts, so per-chunk or per-stream sketches combine exactly.
+class QuantileSketch {
+public:
+    explicit QuantileSketch(double relative_accuracy = 0.01, size_t max_bins = 2048);
+    
+    void add(double value, uint64_t count = 1);
+    void merge(const QuantileSketch& other);
+    
+    /// Value at quantile q in [0, 1] (0 when empty; q = 0 and 1 are exact)
+    double quantile(double q) const;
+    
+    uint64_t count() const { return count_; }
+    double sum() const { return sum_; }
+    double min() const { return count_ ? min_ : 0.0; }
+    double max() const { return count_ ? max_ : 0.0; }
+    double mean() const { return count_ ? sum_ / static_cast<double>(count_) : 0.0; }
+    bool empty() const { return count_ == 0; }
+    double relative_accuracy() const { return relative_accuracy_; }
+
+private:
+    // Dense counts for consecutive bin keys starting at offset
+    struct Store {
+        int offset = 0;
+        std::vector<uint64_t> bins;
+        
+        void add(int key, uint64_t count, size_t max_bins);
+        void extend(int lo, int hi, size_t max_bins);
+    };
+    
+    double relative_accuracy_;
+    double gamma_;
+    double log_gamma_;
+    size_t max_bins_;
+    Store positive_;
+    Store negative_;  // Keyed by magnitude
+    uint64_t zero_count_ = 0;
+    uint64_t count_ = 0;
+    double sum_ = 0.0;
+    double min_ = 0.0;
+    double max_ = 0.0;
+    
+    int key(double magnitude) const;
+    double value(int key) const;
+};
+
+} // namespace logstory::analysis
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "logstory/analysis/event_index.hpp"
+#include "logstory/analysis/event_lookup.hpp"
+#include "logstory/analysis/event_view.hpp"
+#include "logstory/analysis/text_index.hpp"
+#include "logstory/core/error.hpp"
+#include "logstory/core/event.hpp"
+#include "logstory/core/severity.hpp"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace logstory::analysis {
+
+/// Single comparison in a filter expression, e.g. `sev>=WARN`
+struct QueryPredicate {
+    enum class Field {
+        SEVERITY,  // sev, severity
+        TEXT,      // text, msg, message
+        SOURCE,    // src, source
+        TAG,       // tag.<key>
+        TIME,      // ts, time
+        ID         // id
+    };
+    
+    enum class Op { EQ, NE, LT, LE, GT, GE, CONTAINS };
+    
+    Field field = Field::TEXT;
+    Op op = Op::EQ;
+    std::string tag_key;
+    std::string value;
+    
+    // Value pre-parsed for the field
+    core::Severity sev_value = core::Severity::UNKNOWN;
+    std::chrono::system_clock::time_point time_value;
+    core::EventId id_value = 0;
+    std::string lower_value;
+    
+    /// Evaluate against one event (the scan path)
+    bool matches(const core::Event& event) const;
+};
+
+/// Parsed filter expression
+///
+/// Grammar (keywords are case-insensitive):
+///   expr      := and_expr ("or" and_expr)*
+///   and_expr  := unary ("and" unary)*
+///   unary     := "not" unary | "(" expr ")" | predicate
+///   predicate := field op value
+///   op        := = | == | != | < | <= | > | >= | ~ (case-insensitive contains)
+/// Values are bare words or double-quoted strings.
+struct Query {
+    struct Node {
+        enum class Kind { AND, OR, NOT, PREDICATE };
+        
+        Kind kind = Kind::PREDICATE;
+        std::vector<Node> children;
+        QueryPredicate predicate;
+    };
+    
+    Node root;
+    std::string text;  // Original expression
+    
+    /// Evaluate against one event without indexes
+    bool matches(const core::Event& event) const;
+};
+
+/// Parse a filter expression such as `sev>=WARN and tag.service=api and text~timeout`
+core::Status parse_query(const std::string& expr, Query& out);
+
+/// Executes queries over an event store
+///
+/// Predicates backed by an index (severity, correlation tags and time via
+/// EventIndex; text via TextIndex; id via EventLookup) are answered from
+/// posting lists and combined as bitmaps over view positions. AND children
+/// run index-backed predicates first, so the remaining predicates only scan
+/// events that are still candidates; OR children only scan events not yet
+/// matched. Without indexes every predicate falls back to a scan.
+class QueryEngine {
+public:
+    /// All referenced objects must outlive the engine, and indexes must be
+    /// built over `events`. Without a shared `lookup` the engine builds its
+    /// own for id predicates.
+    explicit QueryEngine(const EventView& events,
+                         const EventIndex* index = nullptr,
+                         const TextIndex* text_index = nullptr,
+                         const EventLookup* lookup = nullptr);
+    
+    /// Ascending positions of matching events in `events`
+    std::vector<size_t> select(const Query& query) const;
+    
+    /// Matching events as a narrower view of `events`, in the same order
+    EventView view(const Query& query) const;
+    
+    /// Copies of the matching events, in store order
+    std::vector<core::Event> filter(const Query& query) const;
+    
+    /// Human-readable execution plan (index vs scan per predicate)
+    std::string explain(const Query& query) const;
+
+private:
+    class Bitmap;
+    
+    EventView events_;
+    const EventIndex* index_;
+    const TextIndex* text_index_;
+    const EventLookup* shared_lookup_;
+    EventLookup own_lookup_;  // Only built without a shared lookup
+    
+    const EventLookup& lookup() const { return shared_lookup_ ? *shared_lookup_ : own_lookup_; }
+    
+    Bitmap evaluate(const Query::Node& node, const Bitmap& within) const;
+    Bitmap evaluate_predicate(const QueryPredicate& pred, const Bitmap& within) const;
+    bool is_indexed(const QueryPredicate& pred) const;
+    bool is_indexed(const Query::Node& node) const;
+    void explain_node(const Query::Node& node, int depth, std::string& out) const;
+};
+
+} // namespace logstory::analysis
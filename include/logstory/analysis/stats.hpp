@@ -1,9 +1,15 @@
 #pragma once
 
+#include "logstory/analysis/heavy_hitters.hpp"
+#include "logstory/analysis/hyperloglog.hpp"
+#include "logstory/analysis/quantile_sketch.hpp"
 #include "logstory/core/event.hpp"
 #include "logstory/core/severity.hpp"
 #include <chrono>
+#include <cstdint>
 #include <map>
+#include <optional>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -20,6 +26,10 @@ struct TimeSeriesPoint {
 };
 
 // Time-series data structure
+// Non-empty buckets are kept in `points` in time order. A dense slot array
+// indexed by (bucket - origin) maps each bucket to its point, so add_event is
+// O(1) for time-ordered input; series spanning more than kMaxDenseBuckets
+// fall back to binary search over `points`. Treat `points` as read-only.
 struct TimeSeries {
     std::vector<TimeSeriesPoint> points;
     std::chrono::minutes bucket_size;
@@ -28,19 +38,160 @@ struct TimeSeries {
     explicit TimeSeries(std::chrono::minutes bs) : bucket_size(bs) {}
     
     void add_event(std::chrono::system_clock::time_point tp);
+    void add_count(std::chrono::system_clock::time_point tp, size_t count);
     size_t total_count() const;
     std::optional<TimeSeriesPoint> max_point() const;
+    
+    // Add every bucket of `other` (same bucket size expected); an empty
+    // series adopts other's bucket size
+    void merge(const TimeSeries& other);
+    
+    // Largest bucket span tracked by the dense slot array
+    static constexpr int64_t kMaxDenseBuckets = int64_t(1) << 20;
+    
+private:
+    int64_t origin_ = 0;          // Bucket index of slots_[0]
+    std::vector<uint32_t> slots_; // Position in points + 1, or 0 if empty
+    bool sparse_ = false;         // Span exceeded kMaxDenseBuckets
+    
+    int64_t bucket_index(std::chrono::system_clock::time_point tp) const;
+    std::chrono::system_clock::time_point bucket_start(int64_t bucket) const;
+    bool ensure_slot(int64_t bucket);
+    void insert_point(int64_t bucket, size_t pos, size_t count);
+    void add_sparse(int64_t bucket, size_t count);
+};
+
+// Multi-resolution rollups of one TimeSeries (e.g. 1m/5m/1h/1d)
+// Coarser levels are built from the finest in a single pass; prefix sums over
+// each level answer range counts with a binary search.
+struct TimeSeriesPyramid {
+    std::vector<TimeSeries> levels;             // Finest first
+    std::vector<std::vector<size_t>> prefix;    // prefix[l][i] = sum of levels[l].points[0..i)
+    
+    TimeSeriesPyramid() = default;
+    
+    // Build rollups of `finest` at each resolution that is a multiple of its
+    // bucket size (others are skipped); the finest series is always level 0
+    static TimeSeriesPyramid build(const TimeSeries& finest,
+                                   const std::vector<std::chrono::minutes>& resolutions);
+    
+    // Level with exactly this bucket size, or nullptr
+    const TimeSeries* level(std::chrono::minutes bucket_size) const;
+    
+    // Finest level that covers `span` in at most `max_points` buckets
+    // (coarsest level if none does)
+    const TimeSeries& level_for_span(std::chrono::minutes span, size_t max_points) const;
+    
+    // Events in buckets starting within [start, end) at the given level, O(log n)
+    size_t range_count(std::chrono::system_clock::time_point start,
+                       std::chrono::system_clock::time_point end,
+                       size_t level_index = 0) const;
+    
+    bool empty() const { return levels.empty(); }
 };
 
 // Frequent message pattern
+// Counts come from a bounded HeavyHitters summary: `count` may overstate the
+// true count by at most `error`
 struct FrequentPattern {
     std::string pattern;
     size_t count;
     core::Severity max_severity;
+    size_t error = 0;
     
     FrequentPattern() : count(0), max_severity(core::Severity::UNKNOWN) {}
-    FrequentPattern(const std::string& p, size_t c, core::Severity s)
-        : pattern(p), count(c), max_severity(s) {}
+    FrequentPattern(const std::string& p, size_t c, core::Severity s, size_t e = 0)
+        : pattern(p), count(c), max_severity(s), error(e) {}
+    
+    // Lower bound on the true count
+    size_t guaranteed_count() const { return count - error; }
+};
+
+// A shift in one quantile of a numeric tag between adjacent buckets
+struct QuantileChange {
+    std::chrono::system_clock::time_point bucket; // Start of the bucket where it changed
+    double before = 0.0;
+    double after = 0.0;
+};
+
+// Distribution of one numeric tag (e.g. duration_ms), overall and per time
+// bucket. Memory is bounded by the sketch size times the number of buckets,
+// independent of how many values are added.
+struct NumericTagStats {
+    QuantileSketch overall;
+    std::map<std::chrono::system_clock::time_point, QuantileSketch> buckets;
+    
+    explicit NumericTagStats(double relative_accuracy = 0.01, size_t max_bins = 1024);
+    
+    // Add a value; bucket is the start of its time bucket, if timestamped
+    void add(double value, std::optional<std::chrono::system_clock::time_point> bucket);
+    void merge(const NumericTagStats& other);
+    
+    // Buckets with at least min_samples values whose quantile q differs from
+    // the previous such bucket by at least `factor` in either direction
+    std::vector<QuantileChange> changes(double q, double factor, size_t min_samples) const;
+
+private:
+    double relative_accuracy_;
+    size_t max_bins_;
+};
+
+// Severity counts and series of one partition (a source, or one tag value)
+struct PartitionStats {
+    size_t total_events = 0;
+    std::map<core::Severity, size_t> severity_counts;
+    std::map<core::Severity, TimeSeries> severity_time_series;
+    std::optional<std::chrono::system_clock::time_point> start_time;
+    std::optional<std::chrono::system_clock::time_point> end_time;
+    
+    void add(const core::Event& event, std::chrono::minutes bucket_size);
+    void merge(const PartitionStats& other);
+    
+    size_t count(core::Severity sev) const;
+    double error_rate() const; // Errors per event, as Stats::error_rate
+};
+
+// Statistics grouped by one dimension: the source file, or a tag key such as
+// service, host or pod
+struct PartitionedStats {
+    static constexpr const char* kSourceDimension = "source";
+    static constexpr const char* kOtherPartition = "(other)";
+    
+    std::string dimension;                             // Empty when not partitioned
+    std::map<std::string, PartitionStats> partitions;
+    size_t unkeyed_events = 0;                         // Events without the tag
+    
+    // Keys that get their own partition while adding and merging; events
+    // with any other key count toward kOtherPartition, so a high-cardinality
+    // dimension such as request_id can't grow one set of series per value.
+    // Unset means every key is admitted. StatsBuilder picks the keys from
+    // exact per-key counts before building (see StatsBuilder::build).
+    std::optional<std::set<std::string>> admitted;
+    
+    bool empty() const { return partitions.empty(); }
+    
+    // Partition key of an event (the source path or the tag value), or
+    // nullptr if it has none
+    const std::string* key_of(const core::Event& event) const;
+    
+    // Display name of a partition, e.g. "api.log" or "service=checkout"
+    std::string label(const std::string& key) const;
+    
+    void add(const core::Event& event, std::chrono::minutes bucket_size);
+    void merge(const PartitionedStats& other);
+    
+    // Keep the max_partitions largest partitions by event count and fold the
+    // rest into kOtherPartition
+    void fold_smallest(size_t max_partitions);
+    
+    // Keys of the k partitions with the highest error rate among those with
+    // at least min_events events (ties: more errors, then key order)
+    std::vector<std::string> top_by_error_rate(size_t k, size_t min_events = 1) const;
+    
+private:
+    // Key a new partition is stored under: its own, or kOtherPartition if
+    // it isn't admitted
+    const std::string& admit(const std::string& key) const;
 };
 
 // Overall statistics
@@ -51,12 +202,29 @@ struct Stats {
     // Time series by severity
     std::map<core::Severity, TimeSeries> severity_time_series;
     
+    // Rollup pyramids of severity_time_series; empty unless
+    // StatsConfig::rollup_resolutions is set
+    std::map<core::Severity, TimeSeriesPyramid> severity_pyramids;
+    
     // Source file counts
     std::map<std::string, size_t> source_counts;
     
     // Frequent patterns (top N)
     std::vector<FrequentPattern> frequent_patterns;
     
+    // Bounded heavy-hitter summary of patterns; frequent_patterns is its top N
+    HeavyHitters pattern_sketch;
+    
+    // Distinct values per tag key, overall and within each severity
+    std::map<std::string, HyperLogLog> tag_cardinality;
+    std::map<core::Severity, std::map<std::string, HyperLogLog>> severity_tag_cardinality;
+    
+    // Quantile sketches of numeric tag values (see core::parse_numeric_tag)
+    std::map<std::string, NumericTagStats> numeric_tags;
+    
+    // Per-partition counts and series (see StatsConfig::partition_by)
+    PartitionedStats partitions;
+    
     // Overall metrics
     size_t total_events = 0;
     std::optional<std::chrono::system_clock::time_point> start_time;
@@ -68,6 +236,27 @@ struct Stats {
     size_t error_count() const;
     size_t warn_count() const;
     double error_rate() const; // Errors per total events
+    
+    // Fold another partial into this one. Counts, time series, the pattern,
+    // tag and quantile sketches, partitions and time bounds combine
+    // associatively, so partials over disjoint event chunks can be merged in
+    // any grouping. The derived views
+    // (severity_pyramids, frequent_patterns) are cleared; rebuild them with
+    // StatsBuilder::finalize.
+    void merge(const Stats& other);
+    
+    // Estimated distinct values of a tag key, overall or within one severity
+    size_t distinct_tag_values(const std::string& key) const;
+    size_t distinct_tag_values(const std::string& key, core::Severity sev) const;
+    
+    // Series for a severity at the requested bucket size: the matching rollup
+    // level if one exists, else the base series if its size matches, else nullptr
+    const TimeSeries* series_at(core::Severity sev, std::chrono::minutes bucket_size) const;
+    
+    // Series for a severity at the finest resolution that covers the input's
+    // time span in at most max_points buckets (see level_for_span); the base
+    // series when no rollups were built. nullptr if the severity has none.
+    const TimeSeries* series_for_span(core::Severity sev, size_t max_points) const;
 };
 
 } // namespace logstory::analysis
@@ -1,8 +1,11 @@
 #pragma once
 
 #include "logstory/analysis/stats.hpp"
+#include "logstory/analysis/event_view.hpp"
 #include "logstory/core/event.hpp"
+#include "logstory/core/thread_pool.hpp"
 #include <chrono>
+#include <string>
 #include <vector>
 
 namespace logstory::analysis {
@@ -12,6 +15,28 @@ struct StatsConfig {
     size_t top_n_patterns = 10;
     size_t min_pattern_length = 10; // Min chars for pattern matching
     
+    // Counters kept for frequent patterns; reported counts err by at most
+    // total / capacity (see HeavyHitters::capacity_for_error/_for_budget)
+    size_t pattern_sketch_capacity = 4096;
+    size_t parallel_chunk_events = 16384; // Events per work unit in build_parallel
+    
+    // Tag keys whose numeric values get quantile sketches (overall and per
+    // time_bucket_size). Empty means every key with a numeric value except
+    // identifiers (keys ending in "id", e.g. request_id or pid)
+    std::vector<std::string> numeric_tag_keys;
+    double quantile_relative_accuracy = 0.01;
+    size_t quantile_max_bins = 1024; // Per sketch; bounds memory per bucket
+    
+    // Coarser rollups built on top of time_bucket_size (see TimeSeriesPyramid),
+    // e.g. {5min, 1h, 24h}. Only ErrorBurstDetector's resolution and
+    // max_buckets options read them, so none are built by default.
+    std::vector<std::chrono::minutes> rollup_resolutions;
+    
+    // Dimension for per-partition stats: "source" (the file) or a tag key
+    // such as service, host or pod. Empty disables partitioning.
+    std::string partition_by;
+    size_t max_partitions = 1000; // Smaller partitions beyond this fold into "(other)"
+    
     StatsConfig() = default;
 };
 
@@ -19,15 +44,45 @@ class StatsBuilder {
 public:
     explicit StatsBuilder(const StatsConfig& config = StatsConfig());
     
-    // Build statistics from a list of events
-    Stats build(const std::vector<core::Event>& events);
+    // Build statistics from a list of events. With partition_by set, a first
+    // pass counts events per key exactly; if there are more than
+    // max_partitions keys, only the largest get their own partition (as
+    // fold_smallest would keep them) and the rest go straight to "(other)".
+    Stats build(const EventView& events);
+    
+    // build() on the pool: each worker folds a fixed stride of chunks into
+    // one accumulator, and the accumulators merge in worker order, so memory
+    // grows with the worker count, not the input. Counts, series, time bounds
+    // and per-key partitions match build() exactly, since partition admission
+    // is decided once over the whole input before the workers start;
+    // sketch-backed results (pattern counts and their error bounds, distinct
+    // counts, quantiles) match within the sketches' error bounds, since a
+    // saturated summary depends on how the input was split. Partitions are
+    // reduced hash-partitioned: each worker splits its partitions into one
+    // shard per worker by key hash, and each shard is merged by its own task.
+    // Inputs of one chunk or less run inline.
+    Stats build_parallel(const EventView& events, core::ThreadPool& pool);
+    
+    // Mergeable partial over events[begin, end): counts, time series,
+    // pattern sketch and time bounds, without the derived views. Every
+    // partition key is kept; finalize() folds them down to max_partitions.
+    Stats build_partial(const EventView& events, size_t begin, size_t end) const;
+    
+    // Derive rollup pyramids and the top N patterns from merged partials, and
+    // fold partitions beyond max_partitions
+    void finalize(Stats& stats) const;
     
 private:
     StatsConfig config_;
     
     // Helper methods
-    void process_event(const core::Event& event, Stats& stats);
-    void compute_frequent_patterns(const std::vector<core::Event>& events, Stats& stats);
+    void init_partial(Stats& stats) const;
+    void admit_largest_partitions(const EventView& events, Stats& stats) const;
+    void accumulate(const EventView& events, size_t begin, size_t end, Stats& stats) const;
+    void process_event(const core::Event& event, Stats& stats) const;
+    void count_pattern(const core::Event& event, Stats& stats) const;
+    void add_numeric_tags(const core::Event& event, Stats& stats) const;
+    bool is_numeric_tag_key(const std::string& key) const;
     std::string extract_pattern(const std::string& message) const;
 };
 
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "logstory/analysis/event_lookup.hpp"
+#include "logstory/analysis/event_view.hpp"
+#include "logstory/analysis/posting_list.hpp"
+#include "logstory/core/event.hpp"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace logstory::analysis {
+
+/// Configuration for the full-text index
+struct TextIndexConfig {
+    /// Index lowercase character trigrams for substring queries; without them
+    /// substring queries fall back to scanning every message
+    bool index_ngrams = true;
+    
+    TextIndexConfig() = default;
+};
+
+/// Inverted index over event messages
+///
+/// Messages are split into lowercase alphanumeric tokens for whole-word
+/// lookups, and into lowercase byte trigrams so case-insensitive substring
+/// queries only verify events whose messages contain every trigram of the
+/// needle. Like EventIndex, it refers to an event view without copying events.
+class TextIndex {
+public:
+    explicit TextIndex(TextIndexConfig config = TextIndexConfig()) : config_(config) {}
+    
+    /// Build the index over an event view (events not copied). A shared
+    /// `lookup` over the same view is reused instead of building a private one.
+    void build(const EventView& events, const EventLookup* lookup = nullptr);
+    
+    /// Events containing a whole token (matched case-insensitively)
+    const PostingList& token(const std::string& tok) const;
+    
+    /// Events whose message contains the substring (case-insensitive)
+    PostingList containing(std::string_view needle) const;
+    
+    /// Events whose message contains any of the substrings
+    PostingList containing_any(const std::vector<std::string>& needles) const;
+    
+    /// Ascending view positions of events containing any of the substrings
+    std::vector<size_t> positions_containing_any(const std::vector<std::string>& needles) const;
+    
+    /// Number of distinct tokens
+    size_t token_count() const { return tokens_.size(); }
+
+private:
+    TextIndexConfig config_;
+    EventView events_;
+    const EventLookup* shared_lookup_ = nullptr;
+    EventLookup own_lookup_;  // Only built without a shared lookup
+    
+    std::unordered_map<std::string, PostingList> tokens_;
+    std::unordered_map<uint32_t, PostingList> trigrams_;
+    
+    const EventLookup& lookup() const { return shared_lookup_ ? *shared_lookup_ : own_lookup_; }
+    
+    /// Index one event's message
+    void add_message(core::EventId id, const std::string& message);
+};
+
+} // namespace logstory::analysis
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "logstory/analysis/event_view.hpp"
 #include "logstory/core/event.hpp"
 #include <chrono>
 #include <optional>
@@ -37,8 +38,8 @@ std::optional<std::chrono::system_clock::time_point> parse_relative_time(const s
 /// Parse time string (tries ISO8601 first, then relative)
 std::optional<std::chrono::system_clock::time_point> parse_time(const std::string& str);
 
-/// Filter events by time window
-std::vector<core::Event> filter_by_window(const std::vector<core::Event>& events,
-                                           const TimeWindow& window);
+/// Events inside a time window, as a view over the same store (no event is
+/// copied; an unconstrained window returns `events` unchanged)
+EventView filter_by_window(const EventView& events, const TimeWindow& window);
 
 } // namespace logstory::analysis
@@ -4,9 +4,14 @@
 #include "logstory/core/event.hpp"
 #include "logstory/core/error.hpp"
 #include "logstory/analysis/stats.hpp"
+#include "logstory/analysis/clock_skew.hpp"
 #include "logstory/analysis/episode.hpp"
+#include "logstory/analysis/event_lookup.hpp"
+#include "logstory/analysis/event_view.hpp"
 #include "logstory/rules/finding.hpp"
 #include "logstory/narrative/report.hpp"
+#include "logstory/io/file_reader.hpp"
+#include "logstory/parsing/event_parser.hpp"
 #include <vector>
 #include <string>
 
@@ -22,18 +27,26 @@ public:
     
 private:
     Args args_;
+    analysis::ClockSkewEstimate clock_skew_;  // Offsets applied during ingest
+    analysis::EventLookup lookup_;            // EventId -> event, shared by all stages
     
-    // Pipeline steps
-    core::Status ingest(std::vector<core::Event>& out_events);
-    core::Status analyze(const std::vector<core::Event>& events,
+    // Pipeline steps; ingest parses into `out_store` and selects the events
+    // that pass the filters as `out_events`, a view over it
+    core::Status ingest(std::vector<core::Event>& out_store, analysis::EventView& out_events);
+    core::Status analyze(const analysis::EventView& events,
                         analysis::Stats& out_stats,
                         std::vector<analysis::Episode>& out_episodes,
                         std::vector<rules::Finding>& out_findings);
-    core::Status generate_reports(const std::vector<core::Event>& events,
+    core::Status generate_reports(const analysis::EventView& events,
                                   const analysis::Stats& stats,
                                   const std::vector<analysis::Episode>& episodes,
                                   const std::vector<rules::Finding>& findings);
     
+    // Filter helpers
+    core::Status build_event_filter(parsing::EventFilter& out_filter) const;
+    bool file_outside_window(io::FileReader& reader, const std::string& path,
+                             const parsing::EventFilter& filter) const;
+    
     // Input helpers
     core::Status read_stdin(std::vector<core::Event>& out_events);
     core::Status read_file(const std::string& path, std::vector<core::Event>& out_events);
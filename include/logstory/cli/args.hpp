@@ -36,6 +36,16 @@ struct Args {
     // Filtering
     std::optional<std::string> since;  // Time filter start (ISO8601 or relative like "1h")
     std::optional<std::string> until;  // Time filter end
+    std::optional<std::string> min_severity; // Drop events below this level
+    std::optional<std::string> where;  // Filter expression, e.g. "sev>=WARN and text~timeout"
+    
+    // Analysis
+    std::optional<std::string> group_by; // Per-partition stats: "source" or a tag key
+    bool correct_clock_skew = true;      // Align source clocks via shared request/trace IDs
+    
+    // Indexing
+    bool time_index = false;           // Keep per-file time index sidecars
+    std::string time_index_dir;        // Sidecar directory (empty: next to each file)
     
     // Behavior
     Verbosity verbosity = Verbosity::NORMAL;
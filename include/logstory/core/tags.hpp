@@ -1,6 +1,8 @@
 #pragma once
 
+#include <optional>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 
 namespace logstory::core {
@@ -8,4 +10,10 @@ namespace logstory::core {
 /// Map of extracted metadata fields (key-value pairs)
 using TagMap = std::unordered_map<std::string, std::string>;
 
+/// Parse a tag value as a number, e.g. "1234", "87.5", "1.2s" or "512KB"
+/// Duration units (ns, us, ms, s) are normalized to milliseconds and size
+/// units (B, KB, MB, GB) to bytes. Returns nullopt for anything else,
+/// including IDs such as "0x1f" or "v2".
+std::optional<double> parse_numeric_tag(std::string_view value);
+
 } // namespace logstory::core
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+namespace logstory::core {
+
+/// ASCII lowercase of one byte; non-letters (and non-ASCII bytes) are unchanged
+constexpr char ascii_lower(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+/// ASCII case-insensitive substring search
+///
+/// `lower_needle` must already be lowercase. Returns the offset of the first
+/// match in `haystack`, or std::string_view::npos. An empty needle matches at
+/// 0. With SSE2 the haystack is filtered 16 positions at a time on the
+/// needle's first and last bytes, and only candidate positions get the folded
+/// compare of the middle bytes. Never allocates.
+size_t find_ignore_case(std::string_view haystack, std::string_view lower_needle);
+
+/// True if `haystack` contains `lower_needle`, ignoring ASCII case
+inline bool contains_ignore_case(std::string_view haystack, std::string_view lower_needle) {
+    return find_ignore_case(haystack, lower_needle) != std::string_view::npos;
+}
+
+/// ASCII case-insensitive equality (neither side needs to be lowercase)
+bool equals_ignore_case(std::string_view a, std::string_view b);
+
+} // namespace logstory::core
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace logstory::core {
+
+/// Fixed-size worker pool for data-parallel analysis passes
+class ThreadPool {
+public:
+    /// threads == 0 uses the hardware concurrency (at least 1)
+    explicit ThreadPool(size_t threads = 0);
+    ~ThreadPool();
+    
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    
+    /// Queue a task; tasks must not throw
+    void submit(std::function<void()> task);
+    
+    /// Block until every submitted task has finished
+    void wait();
+    
+    size_t size() const { return workers_.size(); }
+
+private:
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> queue_;
+    std::mutex mutex_;
+    std::condition_variable work_ready_;
+    std::condition_variable work_done_;
+    size_t active_ = 0;
+    bool stopping_ = false;
+    
+    void worker_loop();
+};
+
+} // namespace logstory::core
@@ -2,19 +2,128 @@
 
 #include "logstory/io/raw_line.hpp"
 #include "logstory/core/error.hpp"
+#include "logstory/core/time.hpp"
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <optional>
 #include <vector>
 #include <string>
 
 namespace logstory::io {
 
+class TimeIndex;
+
+/// Cheap summary of a file's time coverage, used to skip files unopened
+struct FileTimeBounds {
+    using time_point = std::chrono::system_clock::time_point;
+    
+    /// Slack on the mtime check for timestamps logged without a timezone
+    static constexpr std::chrono::hours kMtimeSlack{24};
+    
+    time_point mtime;
+    std::optional<core::Timestamp> first;  // First timestamp near the head
+    std::optional<core::Timestamp> last;   // Last timestamp near the tail
+    
+    /// Whether the file cannot hold events in [start, end]: it was last
+    /// written before start, or its first/last timestamps miss the window
+    /// widened by `jitter` (out-of-order lines near the head or tail may
+    /// still fall inside it)
+    bool outside(const std::optional<time_point>& start,
+                 const std::optional<time_point>& end,
+                 std::chrono::seconds jitter = std::chrono::seconds(0)) const;
+};
+
+/// Tuning for FileReader::read_window
+struct SeekConfig {
+    /// Files smaller than this are read in full
+    uintmax_t min_file_bytes = 1 << 20;
+    
+    /// Bisection stops once the candidate range is this small
+    uintmax_t block_bytes = 64 * 1024;
+    
+    /// How far past a probe point to look for a timestamped line
+    size_t probe_bytes = 64 * 1024;
+    
+    /// Out-of-order timestamps within this much are tolerated (thread jitter);
+    /// larger inversions make the file count as unordered
+    std::chrono::seconds jitter{2};
+    
+    /// Seek with a per-file TimeIndex sidecar instead of bisecting. A missing
+    /// or stale sidecar is rebuilt in the same pass that reads the window, so
+    /// the first run reads the file once. Files below min_file_bytes are read
+    /// whole and never get a sidecar.
+    bool use_time_index = false;
+    
+    /// Where sidecars are kept; empty stores them next to each source file
+    std::string time_index_dir;
+};
+
+/// Byte range chosen by FileReader::read_window
+struct SeekResult {
+    bool bisected = false;       // Range found by bisection
+    bool indexed = false;        // Range taken from a TimeIndex sidecar
+    uintmax_t start_offset = 0;
+    uintmax_t end_offset = 0;    // Exclusive
+    uint32_t start_line = 1;     // Line number at start_offset
+    std::string fallback_reason; // Why bisection was not used
+};
+
 /// Reads a file line-by-line and produces RawLine objects
 class FileReader {
 public:
+    FileReader() = default;
+    explicit FileReader(SeekConfig config) : seek_config_(config) {}
+    
+    const SeekConfig& seek_config() const { return seek_config_; }
+    
     /// Read all lines from the given file path
     /// Returns error status if file cannot be opened or read
     core::Status read(const std::string& path, std::vector<RawLine>& out_lines);
+    
+    /// Stat the file and, if read_timestamps is set, detect the first and last
+    /// timestamps within probe_bytes of its head and tail
+    core::Status probe_time_bounds(const std::string& path, FileTimeBounds& out,
+                                   bool read_timestamps = true,
+                                   size_t probe_bytes = 64 * 1024);
+
+    /// Read only the part of a time-ordered file that can hold events in
+    /// [start, end]. The byte range comes from the file's TimeIndex sidecar
+    /// when enabled, otherwise from bisecting on timestamps (widened by
+    /// SeekConfig::jitter); line numbers stay exact. Falls back to
+    /// reading the whole file when it is small or its timestamps are not
+    /// monotonic. Lines outside the window may still be returned, so callers
+    /// filter records as usual.
+    core::Status read_window(const std::string& path,
+                             const std::optional<FileTimeBounds::time_point>& start,
+                             const std::optional<FileTimeBounds::time_point>& end,
+                             std::vector<RawLine>& out_lines,
+                             SeekResult* result = nullptr);
 
 private:
+    SeekConfig seek_config_;
+    
+    /// Locate the byte range for [start, end]; false (with a reason) if the
+    /// file does not look time-ordered
+    bool bisect_window(std::ifstream& file, uintmax_t size,
+                       const std::optional<FileTimeBounds::time_point>& start,
+                       const std::optional<FileTimeBounds::time_point>& end,
+                       SeekResult& result) const;
+    
+    /// Read the whole file once, feeding every line to a begun `index` and
+    /// keeping only the lines the finished index would seek to for
+    /// [start, end]; `seek` gets that range. Lines are only meaningful if the
+    /// index is still ordered afterwards.
+    core::Status read_and_index(std::ifstream& file, const std::string& path,
+                                const std::optional<FileTimeBounds::time_point>& start,
+                                const std::optional<FileTimeBounds::time_point>& end,
+                                TimeIndex& index, std::vector<RawLine>& out_lines,
+                                SeekResult& seek);
+    
+    /// Read lines in [start_offset, end_offset), numbering from start_line
+    core::Status read_range(std::ifstream& file, const std::string& path,
+                            const SeekResult& range, std::vector<RawLine>& out_lines);
+    
     /// Normalize line endings by stripping trailing \r
     static void normalize_line_ending(std::string& line);
 };
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "logstory/core/error.hpp"
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace logstory::io {
+
+/// Sparse time -> byte offset index for one log file
+///
+/// Holds the first line of each granularity bucket (one per minute by
+/// default) with its exact line number, and is persisted as a sidecar file
+/// so repeated runs with different time windows can jump straight to the
+/// requested range. A fingerprint of size, mtime and content hash decides
+/// whether a stored index still describes the file.
+class TimeIndex {
+public:
+    using time_point = std::chrono::system_clock::time_point;
+    
+    /// Sidecar file extension
+    static constexpr const char* kExtension = ".tidx";
+    
+    /// Bytes hashed at each end of the file for the fingerprint
+    static constexpr size_t kHashBlockBytes = 64 * 1024;
+    
+    /// First timestamped line of a bucket
+    struct Entry {
+        time_point tp;
+        uint64_t offset = 0;   // Byte offset of the line start
+        uint32_t line_no = 1;  // 1-based line number
+    };
+    
+    /// Identifies the file contents an index was built from
+    struct Fingerprint {
+        uint64_t size = 0;
+        int64_t mtime_ns = 0;
+        uint64_t content_hash = 0;  // FNV-1a over the head and tail blocks
+        
+        bool operator==(const Fingerprint& other) const {
+            return size == other.size && mtime_ns == other.mtime_ns &&
+                   content_hash == other.content_hash;
+        }
+        bool operator!=(const Fingerprint& other) const { return !(*this == other); }
+    };
+    
+    /// Fingerprint the file as it is now
+    static core::Status compute_fingerprint(const std::string& path, Fingerprint& out);
+    
+    /// Sidecar location: next to the source, or inside dir when non-empty
+    static std::string sidecar_path(const std::string& source, const std::string& dir = "");
+    
+    /// Scan the whole file. Timestamps going backwards by more than jitter
+    /// mark the index unordered, which disables seeking.
+    core::Status build(const std::string& path,
+                       std::chrono::seconds granularity = std::chrono::seconds(60),
+                       std::chrono::seconds jitter = std::chrono::seconds(2));
+    
+    /// Incremental build for callers that read the file anyway: begin()
+    /// fingerprints the file as it is now, then add() takes every line in
+    /// file order with its timestamp, if it has one
+    core::Status begin(const std::string& path,
+                       std::chrono::seconds granularity = std::chrono::seconds(60),
+                       std::chrono::seconds jitter = std::chrono::seconds(2));
+    void add(const std::optional<time_point>& tp, uint64_t offset, uint32_t line_no);
+    
+    core::Status save(const std::string& sidecar) const;
+    core::Status load(const std::string& sidecar);
+    
+    /// Load the sidecar if it matches the file, otherwise build and save it.
+    /// A failed save is not an error; the index is still usable in memory.
+    core::Status load_or_build(const std::string& source, const std::string& dir,
+                               bool* rebuilt = nullptr);
+    
+    /// Whether the index still describes the file at path
+    bool matches(const std::string& path) const;
+    
+    /// Entry to start reading from so no line at or after start is skipped
+    Entry seek_start(time_point start) const;
+    
+    /// Offset after which every line is later than end
+    uint64_t seek_end(time_point end) const;
+    
+    bool ordered() const { return ordered_; }
+    const std::vector<Entry>& entries() const { return entries_; }
+    const Fingerprint& fingerprint() const { return fingerprint_; }
+
+private:
+    Fingerprint fingerprint_;
+    std::chrono::seconds granularity_{60};
+    std::chrono::seconds jitter_{2};
+    bool ordered_ = true;
+    std::vector<Entry> entries_;
+    
+    // Build state between begin() and the last add()
+    std::optional<time_point> latest_;
+    int64_t last_bucket_ = 0;
+};
+
+} // namespace logstory::io
@@ -4,6 +4,8 @@
 #include "logstory/core/event.hpp"
 #include "logstory/analysis/stats.hpp"
 #include "logstory/analysis/episode.hpp"
+#include "logstory/analysis/event_lookup.hpp"
+#include "logstory/analysis/event_view.hpp"
 #include "logstory/rules/finding.hpp"
 #include <vector>
 #include <map>
@@ -12,10 +14,22 @@ namespace logstory::narrative {
 
 // Configuration for report generation
 struct NarratorConfig {
+    // Highlights in the timeline; when errors outnumber them, errors are
+    // summarized per bucket at a resolution chosen for the input's span
     size_t max_timeline_highlights = 20;
     size_t max_evidence_excerpts = 50;
     size_t max_excerpt_length = 500;  // chars
     
+    // A numeric tag's p95 "changed" when it moves by this factor between
+    // buckets holding at least min_samples values
+    double quantile_change_factor = 2.0;
+    size_t quantile_change_min_samples = 5;
+    size_t max_quantile_changes = 5;  // Largest shifts kept per key
+    
+    // Partitions listed by error rate, and the events one needs to qualify
+    size_t max_partitions_reported = 10;
+    size_t partition_min_events = 10;
+    
     NarratorConfig() = default;
 };
 
@@ -24,14 +38,19 @@ class Narrator {
 public:
     explicit Narrator(const NarratorConfig& config = NarratorConfig());
     
-    // Generate a complete report
+    // Generate a complete report; evidence is resolved through `lookup` when
+    // the caller already has one over `events`
     Report generate(
-        const std::vector<core::Event>& events,
+        const analysis::EventView& events,
         const analysis::Stats& stats,
         const std::vector<analysis::Episode>& episodes,
-        const std::vector<rules::Finding>& findings
+        const std::vector<rules::Finding>& findings,
+        const analysis::EventLookup* lookup = nullptr
     );
     
+    // Record estimated clock offsets and summarize the corrections made
+    void describe_clock_skew(Report& report, const analysis::ClockSkewEstimate& estimate) const;
+    
 private:
     NarratorConfig config_;
     
@@ -39,21 +58,27 @@ private:
     void generate_summary(Report& report, const analysis::Stats& stats,
                          const std::vector<rules::Finding>& findings);
     
-    void generate_timeline(Report& report, const std::vector<core::Event>& events,
+    void generate_timeline(Report& report, const analysis::EventView& events,
+                          const analysis::Stats& stats,
                           const std::vector<analysis::Episode>& episodes,
                           const std::vector<rules::Finding>& findings);
     
-    void generate_evidence(Report& report, const std::vector<core::Event>& events,
+    // One highlight per error bucket, at most `budget` (the busiest)
+    void add_error_buckets(std::vector<TimelineHighlight>& highlights,
+                          const analysis::EventView& events,
+                          const analysis::TimeSeries& error_series, size_t budget) const;
+    
+    void generate_numeric_tags(Report& report, const analysis::Stats& stats);
+    
+    void generate_partitions(Report& report, const analysis::Stats& stats);
+    
+    void generate_evidence(Report& report, const analysis::EventLookup& lookup,
                           const std::vector<rules::Finding>& findings);
     
     // Helper methods
     std::string format_timestamp(const std::chrono::system_clock::time_point& tp) const;
     std::string format_duration(std::chrono::seconds duration) const;
     std::string truncate_text(const std::string& text, size_t max_len) const;
-    
-    // Event lookup
-    const core::Event* find_event_by_id(const std::vector<core::Event>& events,
-                                        core::EventId id) const;
 };
 
 } // namespace logstory::narrative
@@ -3,9 +3,11 @@
 #include "logstory/rules/finding.hpp"
 #include "logstory/core/event.hpp"
 #include "logstory/analysis/stats.hpp"
+#include "logstory/analysis/clock_skew.hpp"
 #include <string>
 #include <vector>
 #include <chrono>
+#include <map>
 
 namespace logstory::narrative {
 
@@ -38,6 +40,35 @@ struct EvidenceExcerpt {
     EvidenceExcerpt() : event_id(0) {}
 };
 
+// Distinct values seen for one tag key
+struct TagCardinality {
+    std::string key;
+    size_t distinct = 0;
+    bool exact = true;  // False if distinct is a HyperLogLog estimate
+    std::map<core::Severity, size_t> by_severity;
+};
+
+// Quantiles of one numeric tag, and the buckets where its p95 shifted
+struct NumericTagSummary {
+    std::string key;
+    size_t count = 0;
+    double min = 0.0;
+    double max = 0.0;
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double p99 = 0.0;
+    std::vector<analysis::QuantileChange> p95_changes;  // In time order
+};
+
+// Counts of one partition (a source, or one value of the grouping tag)
+struct PartitionSummary {
+    std::string key;    // Display label, e.g. "api.log" or "service=checkout"
+    size_t events = 0;
+    size_t errors = 0;
+    size_t warnings = 0;
+    double error_rate = 0.0;  // Errors per event
+};
+
 // Complete report structure
 struct Report {
     // Metadata
@@ -55,6 +86,15 @@ struct Report {
     size_t total_events = 0;
     size_t error_count = 0;
     size_t warning_count = 0;
+    std::vector<TagCardinality> tag_cardinality;
+    std::vector<NumericTagSummary> numeric_tags;
+    
+    // Partitions with the highest error rate (see StatsConfig::partition_by)
+    std::string partition_dimension;  // Empty when not partitioned
+    std::vector<PartitionSummary> top_partitions;
+    
+    // Estimated source clock offsets (see analysis::ClockSkewEstimator)
+    std::vector<analysis::SourceOffset> clock_offsets;
     
     // Timeline Highlights
     std::vector<TimelineHighlight> timeline;
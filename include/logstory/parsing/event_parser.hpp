@@ -5,10 +5,27 @@
 #include "logstory/parsing/timestamp_detector.hpp"
 #include "logstory/parsing/severity_detector.hpp"
 #include "logstory/parsing/kv_extractor.hpp"
+#include <chrono>
+#include <optional>
 #include <vector>
 
 namespace logstory::parsing {
 
+/// Filter applied right after timestamp and severity detection
+struct EventFilter {
+    std::optional<std::chrono::system_clock::time_point> start;  // Inclusive
+    std::optional<std::chrono::system_clock::time_point> end;    // Inclusive
+    core::Severity min_severity = core::Severity::UNKNOWN;
+    
+    /// Whether any constraint is set
+    bool is_active() const {
+        return start.has_value() || end.has_value() || min_severity != core::Severity::UNKNOWN;
+    }
+    
+    /// Time check; records without a timestamp fail a constrained window
+    bool accepts_time(const std::optional<core::Timestamp>& ts) const;
+};
+
 /// Converts Records to Events by parsing and extracting metadata
 class EventParser {
 public:
@@ -18,14 +35,27 @@ public:
     /// Parse a single record into an event
     core::Event parse(const io::Record& record);
     
-    /// Parse multiple records into events
+    /// Parse multiple records into events. With a filter set, rejected
+    /// records skip KV extraction, are not stored and consume no event ID.
     std::vector<core::Event> parse_all(const std::vector<io::Record>& records);
+    
+    /// Filter applied by parse_all
+    void set_filter(const EventFilter& filter) { filter_ = filter; }
+    
+    /// Records rejected by the filter so far
+    size_t filtered_count() const { return filtered_count_; }
 
 private:
     core::EventId next_id_;
+    EventFilter filter_;
+    size_t filtered_count_ = 0;
     TimestampDetector ts_detector_;
     SeverityDetector sev_detector_;
     KVExtractor kv_extractor_;
+    
+    /// Finish an event once timestamp and severity are known
+    core::Event build_event(const io::Record& record, std::optional<core::Timestamp> ts,
+                            core::Severity sev);
 };
 
 } // namespace logstory::parsing
@@ -17,7 +17,7 @@ public:
     
 private:
     bool is_change_event(const core::Event& event) const;
-    std::vector<size_t> find_change_events(const std::vector<core::Event>& events) const;
+    std::vector<size_t> find_change_events(const analysis::EventView& events) const;
 };
 
 } // namespace logstory::rules::builtin
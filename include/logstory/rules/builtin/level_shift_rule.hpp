@@ -0,0 +1,19 @@
+#pragma once
+
+#include "logstory/rules/rule.hpp"
+
+namespace logstory::rules::builtin {
+
+// Reports warning/error rates that stepped up and stayed up
+class LevelShiftRule : public Rule {
+public:
+    LevelShiftRule() = default;
+    
+    std::string id() const override { return "level-shift"; }
+    std::string name() const override { return "Sustained Rate Increase"; }
+    int priority() const override { return 75; }
+    
+    std::vector<Finding> evaluate(const RuleContext& context) override;
+};
+
+} // namespace logstory::rules::builtin
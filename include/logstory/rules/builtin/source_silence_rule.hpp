@@ -0,0 +1,19 @@
+#pragma once
+
+#include "logstory/rules/rule.hpp"
+
+namespace logstory::rules::builtin {
+
+// Reports sources that stopped logging (missing heartbeats)
+class SourceSilenceRule : public Rule {
+public:
+    SourceSilenceRule() = default;
+    
+    std::string id() const override { return "source-silence"; }
+    std::string name() const override { return "Source Silence Detection"; }
+    int priority() const override { return 80; }
+    
+    std::vector<Finding> evaluate(const RuleContext& context) override;
+};
+
+} // namespace logstory::rules::builtin
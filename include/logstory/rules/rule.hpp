@@ -5,6 +5,9 @@
 #include "logstory/analysis/stats.hpp"
 #include "logstory/analysis/episode.hpp"
 #include "logstory/analysis/anomaly_detector.hpp"
+#include "logstory/analysis/event_lookup.hpp"
+#include "logstory/analysis/event_view.hpp"
+#include "logstory/analysis/event_features.hpp"
 #include <vector>
 #include <memory>
 
@@ -12,10 +15,12 @@ namespace logstory::rules {
 
 // Context provided to rules during execution
 struct RuleContext {
-    const std::vector<core::Event>* events = nullptr;
+    const analysis::EventView* events = nullptr;
     const analysis::Stats* stats = nullptr;
     const std::vector<analysis::Episode>* episodes = nullptr;
     const std::vector<analysis::Anomaly>* anomalies = nullptr;
+    const analysis::EventLookup* lookup = nullptr;  // EventId -> event, O(1)
+    const analysis::EventFeatures* features = nullptr; // Keyword bits per event
     
     RuleContext() = default;
 };
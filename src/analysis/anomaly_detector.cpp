@@ -1,6 +1,12 @@
 #include "logstory/analysis/anomaly_detector.hpp"
+#include "logstory/core/text_search.hpp"
 #include <algorithm>
 #include <cctype>
+#include <cmath>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <string_view>
 
 namespace logstory::analysis {
 
@@ -12,43 +18,46 @@ ErrorBurstDetector::ErrorBurstDetector(const ErrorBurstConfig& config)
     : config_(config) {}
 
 std::vector<Anomaly> ErrorBurstDetector::detect(
-    const std::vector<core::Event>& events, 
+    const EventView& events, 
     const Stats& stats) {
     
     std::vector<Anomaly> anomalies;
     
-    // Get error time series
-    auto it = stats.severity_time_series.find(core::Severity::ERROR);
-    if (it == stats.severity_time_series.end()) {
+    // Get error time series at the configured resolution
+    const TimeSeries* error_series = select_series(stats);
+    if (error_series == nullptr || error_series->points.empty()) {
         return anomalies; // No errors
     }
     
-    const TimeSeries& error_series = it->second;
-    if (error_series.points.empty()) {
-        return anomalies;
-    }
-    
     // Compute baseline error rate
-    double baseline = compute_baseline_rate(stats);
+    double baseline = compute_baseline_rate(*error_series);
     
     // Find bursts
-    return find_bursts(error_series, baseline);
+    return find_bursts(*error_series, baseline);
 }
 
-double ErrorBurstDetector::compute_baseline_rate(const Stats& stats) const {
-    // Simple baseline: average errors per minute bucket
-    auto it = stats.severity_time_series.find(core::Severity::ERROR);
-    if (it == stats.severity_time_series.end() || it->second.points.empty()) {
-        return 0.0;
+const TimeSeries* ErrorBurstDetector::select_series(const Stats& stats) const {
+    if (config_.resolution.has_value()) {
+        return stats.series_at(core::Severity::ERROR, *config_.resolution);
     }
     
-    size_t total_errors = it->second.total_count();
-    size_t num_buckets = it->second.points.size();
+    // Zoom out on long inputs so the scan stays within max_buckets
+    if (config_.max_buckets > 0) {
+        return stats.series_for_span(core::Severity::ERROR, config_.max_buckets);
+    }
     
+    auto it = stats.severity_time_series.find(core::Severity::ERROR);
+    return it != stats.severity_time_series.end() ? &it->second : nullptr;
+}
+
+double ErrorBurstDetector::compute_baseline_rate(const TimeSeries& error_series) const {
+    // Simple baseline: average errors per non-empty bucket
+    size_t num_buckets = error_series.points.size();
     if (num_buckets == 0) {
         return 0.0;
     }
     
+    size_t total_errors = error_series.total_count();
     return static_cast<double>(total_errors) / static_cast<double>(num_buckets);
 }
 
@@ -59,30 +68,959 @@ std::vector<Anomaly> ErrorBurstDetector::find_bursts(
     std::vector<Anomaly> bursts;
     
     double threshold = baseline * config_.threshold_multiplier;
+    size_t burst_errors = 0;
     
     for (const auto& point : error_series.points) {
         if (point.count >= config_.min_errors_for_burst && 
             static_cast<double>(point.count) >= threshold) {
             
-            Anomaly anomaly;
-            anomaly.type = Anomaly::Type::ERROR_BURST;
-            anomaly.start_time = point.timestamp;
+            // Extend the previous burst if this bucket directly follows it
+            bool adjacent = !bursts.empty() && bursts.back().end_time == point.timestamp;
+            if (!adjacent) {
+                Anomaly anomaly;
+                anomaly.type = Anomaly::Type::ERROR_BURST;
+                anomaly.start_time = point.timestamp;
+                bursts.push_back(anomaly);
+                burst_errors = 0;
+            }
+            
+            Anomaly& anomaly = bursts.back();
             anomaly.end_time = point.timestamp + error_series.bucket_size;
+            burst_errors += point.count;
+            auto minutes = std::chrono::duration_cast<std::chrono::minutes>(
+                *anomaly.end_time - *anomaly.start_time);
             anomaly.description = "Error burst detected: " + 
-                std::to_string(point.count) + " errors in " +
-                std::to_string(error_series.bucket_size.count()) + " minutes";
+                std::to_string(burst_errors) + " errors in " +
+                std::to_string(minutes.count()) + " minutes";
             
-            // Confidence based on how much it exceeds threshold
+            // Confidence based on how much the peak bucket exceeds threshold
             double ratio = static_cast<double>(point.count) / threshold;
-            anomaly.confidence = std::min(1.0, ratio / 2.0);
-            
-            bursts.push_back(anomaly);
+            anomaly.confidence = std::max(anomaly.confidence, std::min(1.0, ratio / 2.0));
         }
     }
     
     return bursts;
 }
 
+// ============================================================================
+// RollingBurstDetector
+// ============================================================================
+
+RollingBurstDetector::RollingBurstDetector(const RollingBurstConfig& config)
+    : config_(config) {
+    if (config_.bucket_size.count() <= 0) {
+        config_.bucket_size = std::chrono::minutes(1);
+    }
+}
+
+std::optional<Anomaly> RollingBurstDetector::add_error(std::chrono::system_clock::time_point tp,
+                                                       core::EventId id) {
+    auto bucket = bucket_of(tp);
+    std::optional<Anomaly> closed;
+    if (open_bucket_.has_value() && bucket > *open_bucket_) {
+        closed = close_bucket(*open_bucket_, open_count_, open_ids_);
+        open_bucket_.reset();
+        open_count_ = 0;
+        open_ids_.clear();
+    }
+    
+    if (!open_bucket_.has_value()) {
+        open_bucket_ = bucket;
+    }
+    open_count_++;
+    if (id != 0 && open_ids_.size() < config_.max_evidence) {
+        open_ids_.push_back(id);
+    }
+    return closed;
+}
+
+std::optional<Anomaly> RollingBurstDetector::add_bucket(
+    std::chrono::system_clock::time_point bucket_start, size_t errors) {
+    return close_bucket(bucket_of(bucket_start), errors, {});
+}
+
+std::vector<Anomaly> RollingBurstDetector::flush() {
+    std::vector<Anomaly> closed;
+    if (open_bucket_.has_value()) {
+        if (auto anomaly = close_bucket(*open_bucket_, open_count_, open_ids_)) {
+            closed.push_back(std::move(*anomaly));
+        }
+        open_bucket_.reset();
+        open_count_ = 0;
+        open_ids_.clear();
+    }
+    if (auto anomaly = end_burst()) {
+        closed.push_back(std::move(*anomaly));
+    }
+    return closed;
+}
+
+std::vector<Anomaly> RollingBurstDetector::detect(const TimeSeries& error_series) const {
+    RollingBurstConfig config = config_;
+    config.bucket_size = error_series.bucket_size;
+    RollingBurstDetector scan(config);
+    
+    std::vector<Anomaly> anomalies;
+    for (const auto& point : error_series.points) {
+        if (auto anomaly = scan.add_bucket(point.timestamp, point.count)) {
+            anomalies.push_back(std::move(*anomaly));
+        }
+    }
+    for (auto& anomaly : scan.flush()) {
+        anomalies.push_back(std::move(anomaly));
+    }
+    return anomalies;
+}
+
+std::vector<Anomaly> RollingBurstDetector::detect(const EventView& events) const {
+    RollingBurstDetector scan(config_);
+    
+    std::vector<Anomaly> anomalies;
+    for (const auto& event : events) {
+        if (event.sev != core::Severity::ERROR || !event.ts.has_value()) {
+            continue;
+        }
+        if (auto anomaly = scan.add_error(event.ts->tp, event.id)) {
+            anomalies.push_back(std::move(*anomaly));
+        }
+    }
+    for (auto& anomaly : scan.flush()) {
+        anomalies.push_back(std::move(anomaly));
+    }
+    return anomalies;
+}
+
+std::vector<Anomaly> RollingBurstDetector::detect(const PartitionedStats& partitions,
+                                                  std::optional<std::chrono::minutes> bucket_size) const {
+    static const std::string kPrefix = "Error burst detected";
+    
+    std::vector<Anomaly> anomalies;
+    for (const auto& [key, partition] : partitions.partitions) {
+        auto series = partition.severity_time_series.find(core::Severity::ERROR);
+        if (series == partition.severity_time_series.end()) {
+            continue;
+        }
+        
+        // Roll up to the requested resolution, as TimeSeriesPyramid does
+        const TimeSeries* errors = &series->second;
+        TimeSeries rolled;
+        if (bucket_size.has_value() && *bucket_size > errors->bucket_size &&
+            bucket_size->count() % errors->bucket_size.count() == 0) {
+            rolled = TimeSeries(*bucket_size);
+            for (const auto& point : errors->points) {
+                rolled.add_count(point.timestamp, point.count);
+            }
+            errors = &rolled;
+        }
+        
+        std::string label = partitions.label(key);
+        for (auto& anomaly : detect(*errors)) {
+            anomaly.source = label;
+            if (anomaly.description.compare(0, kPrefix.size(), kPrefix) == 0) {
+                anomaly.description.insert(kPrefix.size(), " in '" + label + "'");
+            }
+            anomalies.push_back(std::move(anomaly));
+        }
+    }
+    return anomalies;
+}
+
+std::chrono::system_clock::time_point RollingBurstDetector::bucket_of(
+    std::chrono::system_clock::time_point tp) const {
+    auto width = std::chrono::duration_cast<std::chrono::system_clock::duration>(config_.bucket_size);
+    auto offset = tp.time_since_epoch() % width;
+    if (offset.count() < 0) {
+        offset += width;
+    }
+    return tp - offset;
+}
+
+std::optional<Anomaly> RollingBurstDetector::close_bucket(
+    std::chrono::system_clock::time_point bucket_start, size_t errors,
+    const std::vector<core::EventId>& ids) {
+    
+    std::optional<Anomaly> closed;
+    
+    // Buckets skipped since the last one had no errors: they end any burst
+    // and decay the baseline
+    if (last_bucket_.has_value() && bucket_start > *last_bucket_) {
+        auto gap = (bucket_start - *last_bucket_) / config_.bucket_size - 1;
+        if (gap > 0) {
+            closed = end_burst();
+            if (static_cast<size_t>(gap) > config_.max_gap_buckets) {
+                mean_ = 0.0;
+                var_ = 0.0;
+                baseline_buckets_ = 0;
+            } else {
+                for (decltype(gap) i = 0; i < gap; ++i) {
+                    update_baseline(0.0);
+                }
+            }
+        }
+    }
+    if (!last_bucket_.has_value() || bucket_start > *last_bucket_) {
+        last_bucket_ = bucket_start;
+    }
+    
+    double count = static_cast<double>(errors);
+    double sigma = std::max({std::sqrt(var_), std::sqrt(mean_),
+                             config_.min_relative_stddev * mean_, 1.0});
+    double threshold = std::max(mean_ + config_.sigma_threshold * sigma,
+                                mean_ * config_.threshold_multiplier);
+    bool warming_up = baseline_buckets_ < config_.warmup_buckets;
+    bool hot = !warming_up && errors >= config_.min_errors_for_burst && count > threshold;
+    
+    if (!hot) {
+        if (auto ended = end_burst()) {
+            closed = std::move(ended);
+        }
+        update_baseline(count);
+        return closed;
+    }
+    
+    if (!burst_.has_value()) {
+        burst_ = Burst();
+        burst_->start = bucket_start;
+        burst_->baseline = mean_;
+    }
+    burst_->end = bucket_start + config_.bucket_size;
+    burst_->errors += errors;
+    burst_->peak = std::max(burst_->peak, errors);
+    burst_->peak_ratio = std::max(burst_->peak_ratio, count / threshold);
+    for (core::EventId id : ids) {
+        if (burst_->evidence.size() >= config_.max_evidence) {
+            break;
+        }
+        burst_->evidence.push_back(id);
+    }
+    // Let the mean creep towards a sustained level, but keep the burst out
+    // of the variance so it can't raise its own threshold
+    mean_ += config_.alpha * config_.hot_weight * (count - mean_);
+    return closed;
+}
+
+void RollingBurstDetector::update_baseline(double errors) {
+    // Incremental EWMA mean and variance (West, 1979). While warming up the
+    // weight is 1/n, which makes them the plain mean and variance so far.
+    double a = config_.alpha;
+    if (baseline_buckets_ < config_.warmup_buckets) {
+        ++baseline_buckets_;
+        a = std::max(a, 1.0 / static_cast<double>(baseline_buckets_));
+    }
+    double diff = errors - mean_;
+    double incr = a * diff;
+    mean_ += incr;
+    var_ = (1.0 - a) * (var_ + diff * incr);
+}
+
+std::optional<Anomaly> RollingBurstDetector::end_burst() {
+    if (!burst_.has_value()) {
+        return std::nullopt;
+    }
+    
+    Anomaly anomaly;
+    anomaly.type = Anomaly::Type::ERROR_BURST;
+    anomaly.start_time = burst_->start;
+    anomaly.end_time = burst_->end;
+    anomaly.evidence_ids = std::move(burst_->evidence);
+    
+    auto minutes = std::chrono::duration_cast<std::chrono::minutes>(burst_->end - burst_->start);
+    std::ostringstream oss;
+    oss << "Error burst detected: " << burst_->errors << " errors in " << minutes.count()
+        << " minutes (peak " << burst_->peak << " per " << config_.bucket_size.count()
+        << "-minute bucket, baseline " << std::fixed << std::setprecision(1)
+        << burst_->baseline << ")";
+    anomaly.description = oss.str();
+    
+    // Same scale as ErrorBurstDetector: 2x the threshold is full confidence
+    anomaly.confidence = std::min(1.0, burst_->peak_ratio / 2.0);
+    
+    burst_.reset();
+    return anomaly;
+}
+
+// ============================================================================
+// MultiWindowBurstDetector
+// ============================================================================
+
+namespace {
+
+// "30s", "5m", "1h"
+std::string format_span(std::chrono::seconds span) {
+    auto secs = span.count();
+    if (secs >= 3600 && secs % 3600 == 0) {
+        return std::to_string(secs / 3600) + "h";
+    }
+    if (secs >= 60 && secs % 60 == 0) {
+        return std::to_string(secs / 60) + "m";
+    }
+    return std::to_string(secs) + "s";
+}
+
+} // namespace
+
+MultiWindowBurstDetector::MultiWindowBurstDetector(const MultiWindowBurstConfig& config)
+    : config_(config) {
+    if (config_.resolution.count() <= 0) {
+        config_.resolution = std::chrono::seconds(1);
+    }
+}
+
+std::vector<Anomaly> MultiWindowBurstDetector::detect(const EventView& events) const {
+    using clock = std::chrono::system_clock;
+    
+    std::vector<std::pair<clock::time_point, core::EventId>> errors;
+    for (const auto& event : events) {
+        if (event.sev == core::Severity::ERROR && event.ts.has_value()) {
+            errors.emplace_back(event.ts->tp, event.id);
+        }
+    }
+    if (errors.empty()) {
+        return {};
+    }
+    std::sort(errors.begin(), errors.end());
+    
+    // Slot width: the configured resolution, doubled until the span fits
+    auto resolution = std::chrono::duration_cast<clock::duration>(config_.resolution);
+    auto span = errors.back().first - errors.front().first;
+    while (static_cast<size_t>(span / resolution) + 1 > std::max<size_t>(1, config_.max_slots)) {
+        resolution *= 2;
+    }
+    
+    auto offset = errors.front().first.time_since_epoch() % resolution;
+    if (offset.count() < 0) {
+        offset += resolution;
+    }
+    clock::time_point origin = errors.front().first - offset;
+    size_t slots = static_cast<size_t>((errors.back().first - origin) / resolution) + 1;
+    
+    // prefix[i] = errors in slots [0, i)
+    std::vector<size_t> prefix(slots + 1, 0);
+    for (const auto& error : errors) {
+        prefix[static_cast<size_t>((error.first - origin) / resolution) + 1]++;
+    }
+    for (size_t i = 1; i <= slots; ++i) {
+        prefix[i] += prefix[i - 1];
+    }
+    
+    size_t baseline_slots = std::max<size_t>(1, static_cast<size_t>(
+        std::chrono::duration_cast<clock::duration>(config_.baseline_span) / resolution));
+    double overall_rate = static_cast<double>(errors.size()) / static_cast<double>(slots);
+    
+    // Runs of overlapping hot windows, per window size
+    struct Run {
+        size_t begin;
+        size_t end;
+        double score;
+        double expected;
+        std::chrono::seconds window;
+    };
+    std::vector<Run> runs;
+    
+    for (auto window : config_.windows) {
+        auto k = static_cast<size_t>(std::chrono::duration_cast<clock::duration>(window) / resolution);
+        if (k == 0 || k > slots) {
+            continue;  // Finer than a slot, or longer than the input
+        }
+        
+        std::optional<Run> open;
+        for (size_t end = k; end <= slots; ++end) {
+            size_t begin = end - k;
+            double count = static_cast<double>(prefix[end] - prefix[begin]);
+            if (count < static_cast<double>(config_.min_errors_for_burst)) {
+                continue;
+            }
+            
+            // Expected count from the trailing history, or from the whole
+            // input while less than one window of history exists
+            size_t history_begin = begin > baseline_slots ? begin - baseline_slots : 0;
+            size_t history = begin - history_begin;
+            double rate = history >= k
+                ? static_cast<double>(prefix[begin] - prefix[history_begin]) / static_cast<double>(history)
+                : overall_rate;
+            double expected = rate * static_cast<double>(k);
+            double threshold = std::max(expected * config_.threshold_multiplier,
+                                        expected + config_.sigma_threshold * std::sqrt(expected));
+            if (count <= threshold) {
+                continue;
+            }
+            
+            double score = count / std::max(threshold, 1.0);
+            if (open.has_value() && begin <= open->end) {
+                open->end = end;
+                if (score > open->score) {
+                    open->score = score;
+                    open->expected = expected;
+                }
+            } else {
+                if (open.has_value()) {
+                    runs.push_back(*open);
+                }
+                open = Run{begin, end, score, expected, window};
+            }
+        }
+        if (open.has_value()) {
+            runs.push_back(*open);
+        }
+    }
+    
+    // Trim each run to the slots that actually hold errors
+    for (auto& run : runs) {
+        while (run.begin < run.end && prefix[run.begin + 1] == prefix[run.begin]) {
+            ++run.begin;
+        }
+        while (run.end > run.begin && prefix[run.end] == prefix[run.end - 1]) {
+            --run.end;
+        }
+    }
+    
+    // Best runs first (the longer window on ties); a run overlapping a
+    // better one is the same incident
+    std::sort(runs.begin(), runs.end(), [](const Run& a, const Run& b) {
+        if (a.score != b.score) {
+            return a.score > b.score;
+        }
+        return a.window > b.window;
+    });
+    std::vector<Run> kept;
+    for (const auto& run : runs) {
+        bool overlaps = std::any_of(kept.begin(), kept.end(), [&run](const Run& other) {
+            return run.begin < other.end && other.begin < run.end;
+        });
+        if (!overlaps) {
+            kept.push_back(run);
+        }
+    }
+    std::sort(kept.begin(), kept.end(), [](const Run& a, const Run& b) { return a.begin < b.begin; });
+    
+    std::vector<Anomaly> anomalies;
+    for (const auto& run : kept) {
+        Anomaly anomaly;
+        anomaly.type = Anomaly::Type::ERROR_BURST;
+        anomaly.start_time = origin + resolution * static_cast<clock::rep>(run.begin);
+        anomaly.end_time = origin + resolution * static_cast<clock::rep>(run.end);
+        anomaly.window = run.window;
+        
+        size_t count = prefix[run.end] - prefix[run.begin];
+        auto length = std::chrono::duration_cast<std::chrono::seconds>(
+            *anomaly.end_time - *anomaly.start_time);
+        std::ostringstream oss;
+        oss << "Error burst detected: " << count << " errors in " << format_span(length)
+            << " (" << format_span(run.window) << " window, expected "
+            << std::fixed << std::setprecision(1) << run.expected << ")";
+        anomaly.description = oss.str();
+        anomaly.confidence = std::min(1.0, run.score / 2.0);
+        
+        auto it = std::lower_bound(errors.begin(), errors.end(),
+                                   std::make_pair(*anomaly.start_time, core::EventId(0)));
+        for (; it != errors.end() && it->first < *anomaly.end_time &&
+               anomaly.evidence_ids.size() < config_.max_evidence; ++it) {
+            anomaly.evidence_ids.push_back(it->second);
+        }
+        
+        anomalies.push_back(std::move(anomaly));
+    }
+    return anomalies;
+}
+
+// ============================================================================
+// MissingHeartbeatDetector
+// ============================================================================
+
+namespace {
+
+// "2.5s", "45s", "12m 30s", "3h 5m"
+std::string format_gap(double seconds) {
+    std::ostringstream oss;
+    if (seconds < 10.0 && std::floor(seconds) != seconds) {
+        oss << std::fixed << std::setprecision(1) << seconds << "s";
+        return oss.str();
+    }
+    auto secs = static_cast<long long>(std::llround(seconds));
+    if (secs < 60) {
+        oss << secs << "s";
+    } else if (secs < 3600) {
+        oss << secs / 60 << "m";
+        if (secs % 60 != 0) {
+            oss << " " << secs % 60 << "s";
+        }
+    } else {
+        oss << secs / 3600 << "h";
+        if ((secs % 3600) / 60 != 0) {
+            oss << " " << (secs % 3600) / 60 << "m";
+        }
+    }
+    return oss.str();
+}
+
+double to_seconds(std::chrono::system_clock::duration d) {
+    return std::chrono::duration<double>(d).count();
+}
+
+// Live file a rotated one was cut from: "app.log.1", "app.log.2.gz" and
+// "app.log-20240306" all map to "app.log". A numeric suffix is only dropped
+// when the rest still has an extension, so "node-1" and "node-2" stay apart.
+std::string_view rotation_stem(std::string_view path) {
+    for (std::string_view ext : {".gz", ".bz2", ".xz", ".zst"}) {
+        if (path.size() > ext.size() && path.substr(path.size() - ext.size()) == ext) {
+            path.remove_suffix(ext.size());
+            break;
+        }
+    }
+    while (true) {
+        size_t digits = path.size();
+        while (digits > 0 && std::isdigit(static_cast<unsigned char>(path[digits - 1]))) {
+            --digits;
+        }
+        if (digits == path.size() || digits < 2 || (path[digits - 1] != '.' && path[digits - 1] != '-')) {
+            return path;
+        }
+        std::string_view rest = path.substr(0, digits - 1);
+        size_t name = rest.find_last_of('/');
+        if (rest.find('.', name == std::string_view::npos ? 0 : name + 1) == std::string_view::npos) {
+            return path;
+        }
+        path = rest;
+    }
+}
+
+} // namespace
+
+MissingHeartbeatDetector::MissingHeartbeatDetector(const HeartbeatConfig& config)
+    : config_(config) {
+    config_.min_intervals = std::max<size_t>(1, config_.min_intervals);
+}
+
+std::optional<Anomaly> MissingHeartbeatDetector::add_event(const core::Event& event) {
+    if (!event.ts.has_value()) {
+        return std::nullopt;
+    }
+    if (config_.key_tag.empty()) {
+        return add(event.src.source_path, event.ts->tp, event.id);
+    }
+    auto it = event.tags.find(config_.key_tag);
+    if (it == event.tags.end() || it->second.empty()) {
+        return std::nullopt;
+    }
+    return add(it->second, event.ts->tp, event.id);
+}
+
+std::optional<Anomaly> MissingHeartbeatDetector::add(const std::string& key,
+                                                     std::chrono::system_clock::time_point tp,
+                                                     core::EventId id) {
+    auto it = streams_.find(key);
+    if (it == streams_.end()) {
+        if (streams_.size() < config_.max_streams) {
+            Stream stream;
+            stream.last_seen = tp;
+            stream.beat = tp;
+            stream.last_id = id;
+            streams_.emplace(key, stream);
+        }
+        return std::nullopt;
+    }
+    
+    Stream& stream = it->second;
+    if (tp < stream.last_seen) {
+        return std::nullopt;
+    }
+    
+    std::optional<Anomaly> silence;
+    double threshold = threshold_seconds(stream);
+    if (threshold > 0.0 && to_seconds(tp - stream.last_seen) > threshold) {
+        silence = make_silence(key, stream, tp, id);
+        stream.beat = tp;  // Measure the next interval from the resumption
+    } else if (tp - stream.beat >= config_.min_interval) {
+        stream.gaps[stream.next] = static_cast<float>(to_seconds(tp - stream.beat));
+        stream.next = static_cast<uint8_t>((stream.next + 1) % kGapWindow);
+        if (stream.intervals < UINT32_MAX) {
+            ++stream.intervals;
+        }
+        stream.beat = tp;
+    }
+    stream.last_seen = tp;
+    stream.last_id = id;
+    return silence;
+}
+
+std::vector<Anomaly> MissingHeartbeatDetector::check(std::chrono::system_clock::time_point now) const {
+    // Latest arrival per rotation stem: a source file whose successor (e.g.
+    // app.log after app.log.1) kept logging was rotated, not silenced
+    std::unordered_map<std::string_view, std::chrono::system_clock::time_point> latest_by_stem;
+    if (config_.key_tag.empty()) {
+        for (const auto& [key, stream] : streams_) {
+            auto [it, inserted] = latest_by_stem.try_emplace(rotation_stem(key), stream.last_seen);
+            if (!inserted && stream.last_seen > it->second) {
+                it->second = stream.last_seen;
+            }
+        }
+    }
+    
+    std::vector<Anomaly> anomalies;
+    for (const auto& [key, stream] : streams_) {
+        double threshold = threshold_seconds(stream);
+        if (threshold <= 0.0 || now <= stream.last_seen ||
+            to_seconds(now - stream.last_seen) <= threshold) {
+            continue;
+        }
+        auto rotated = latest_by_stem.find(rotation_stem(key));
+        if (rotated != latest_by_stem.end() && rotated->second > stream.last_seen) {
+            continue;
+        }
+        anomalies.push_back(make_silence(key, stream, now, std::nullopt));
+    }
+    std::sort(anomalies.begin(), anomalies.end(), [](const Anomaly& a, const Anomaly& b) {
+        return a.start_time < b.start_time;
+    });
+    return anomalies;
+}
+
+std::vector<Anomaly> MissingHeartbeatDetector::detect(const EventView& events) const {
+    std::vector<const core::Event*> timed;
+    timed.reserve(events.size());
+    for (const auto& event : events) {
+        if (event.ts.has_value()) {
+            timed.push_back(&event);
+        }
+    }
+    if (timed.empty()) {
+        return {};
+    }
+    std::stable_sort(timed.begin(), timed.end(), [](const core::Event* a, const core::Event* b) {
+        return a->ts->tp < b->ts->tp;
+    });
+    
+    MissingHeartbeatDetector detector(config_);
+    std::vector<Anomaly> anomalies;
+    for (const core::Event* event : timed) {
+        if (auto silence = detector.add_event(*event)) {
+            anomalies.push_back(std::move(*silence));
+        }
+    }
+    if (config_.report_trailing) {
+        for (auto& silence : detector.check(timed.back()->ts->tp)) {
+            anomalies.push_back(std::move(silence));
+        }
+    }
+    
+    std::stable_sort(anomalies.begin(), anomalies.end(), [](const Anomaly& a, const Anomaly& b) {
+        return a.start_time < b.start_time;
+    });
+    return anomalies;
+}
+
+std::optional<std::chrono::milliseconds> MissingHeartbeatDetector::period(const std::string& key) const {
+    auto it = streams_.find(key);
+    if (it == streams_.end() || it->second.intervals < config_.min_intervals) {
+        return std::nullopt;
+    }
+    return std::chrono::milliseconds(std::llround(period_seconds(it->second) * 1000.0));
+}
+
+double MissingHeartbeatDetector::period_seconds(const Stream& stream) const {
+    size_t n = std::min<size_t>(stream.intervals, kGapWindow);
+    if (n == 0) {
+        return 0.0;
+    }
+    std::array<float, kGapWindow> gaps = stream.gaps;
+    auto mid = gaps.begin() + static_cast<std::ptrdiff_t>(n / 2);
+    std::nth_element(gaps.begin(), mid, gaps.begin() + static_cast<std::ptrdiff_t>(n));
+    return static_cast<double>(*mid);
+}
+
+double MissingHeartbeatDetector::threshold_seconds(const Stream& stream) const {
+    if (stream.intervals < config_.min_intervals) {
+        return 0.0;
+    }
+    return std::max(config_.silence_multiplier * period_seconds(stream),
+                    to_seconds(config_.min_silence));
+}
+
+Anomaly MissingHeartbeatDetector::make_silence(const std::string& key, const Stream& stream,
+                                               std::chrono::system_clock::time_point end,
+                                               std::optional<core::EventId> resume_id) const {
+    double period = period_seconds(stream);
+    double silent = to_seconds(end - stream.last_seen);
+    double threshold = threshold_seconds(stream);
+    
+    Anomaly anomaly;
+    anomaly.type = Anomaly::Type::MISSING_HEARTBEAT;
+    anomaly.start_time = stream.last_seen;
+    anomaly.end_time = end;
+    anomaly.source = config_.key_tag.empty() ? key : config_.key_tag + "=" + key;
+    anomaly.evidence_ids.push_back(stream.last_id);
+    if (resume_id.has_value()) {
+        anomaly.evidence_ids.push_back(*resume_id);
+    }
+    
+    std::ostringstream oss;
+    if (config_.key_tag.empty()) {
+        oss << "Source '" << key << "'";
+    } else {
+        oss << config_.key_tag << "=" << key;
+    }
+    oss << (resume_id.has_value() ? " went silent for " : " silent for the last ")
+        << format_gap(silent) << " (normally every ~" << format_gap(period) << ")";
+    anomaly.description = oss.str();
+    
+    // Just past the threshold is a weak signal; 3x the threshold or more is
+    // as sure as this heuristic gets
+    anomaly.confidence = std::min(0.9, 0.5 + 0.2 * (silent / threshold - 1.0));
+    return anomaly;
+}
+
+// ============================================================================
+// ChangePointDetector
+// ============================================================================
+
+namespace {
+
+// Bucket containing tp, with the same rounding as TimeSeries
+std::chrono::system_clock::time_point bucket_floor(std::chrono::system_clock::time_point tp,
+                                                   std::chrono::minutes bucket_size) {
+    auto bucket = std::chrono::duration_cast<std::chrono::system_clock::duration>(bucket_size);
+    return std::chrono::system_clock::time_point((tp.time_since_epoch() / bucket) * bucket);
+}
+
+void describe_shift(Anomaly& anomaly) {
+    std::ostringstream oss;
+    if (anomaly.severity != core::Severity::UNKNOWN) {
+        oss << core::to_string(anomaly.severity) << " rate";
+    } else {
+        oss << "Event rate";
+    }
+    if (!anomaly.source.empty()) {
+        oss << " in '" << anomaly.source << "'";
+    }
+    oss << (anomaly.rate_after > anomaly.rate_before ? " rose" : " fell")
+        << " from " << std::fixed << std::setprecision(2) << anomaly.rate_before
+        << " to " << anomaly.rate_after << " per minute and stayed there";
+    anomaly.description = oss.str();
+}
+
+} // namespace
+
+ChangePointDetector::ChangePointDetector(const ChangePointConfig& config)
+    : config_(config) {
+    config_.warmup_buckets = std::max<size_t>(2, config_.warmup_buckets);
+    config_.confirm_buckets = std::max<size_t>(1, config_.confirm_buckets);
+    recent_.assign(config_.confirm_buckets, 0.0);
+}
+
+std::vector<Anomaly> ChangePointDetector::add_bucket(std::chrono::system_clock::time_point bucket_start,
+                                                     size_t count) {
+    std::vector<Anomaly> shifts;
+    auto bucket = std::chrono::duration_cast<std::chrono::system_clock::duration>(bucket_size_);
+    
+    if (last_bucket_.has_value()) {
+        if (bucket_start <= *last_bucket_) {
+            return shifts;
+        }
+        auto missing = static_cast<size_t>((bucket_start - *last_bucket_) / bucket) - 1;
+        if (missing > config_.max_gap_buckets) {
+            reset();
+        } else {
+            for (size_t i = 1; i <= missing; ++i) {
+                auto start = *last_bucket_ + bucket * static_cast<int64_t>(i);
+                if (auto shift = step(start, 0.0)) {
+                    shifts.push_back(std::move(*shift));
+                }
+            }
+        }
+    }
+    
+    if (auto shift = step(bucket_start, static_cast<double>(count))) {
+        shifts.push_back(std::move(*shift));
+    }
+    last_bucket_ = bucket_start;
+    return shifts;
+}
+
+std::vector<Anomaly> ChangePointDetector::detect(
+    const TimeSeries& series,
+    std::optional<std::chrono::system_clock::time_point> from,
+    std::optional<std::chrono::system_clock::time_point> to) const {
+    
+    ChangePointDetector detector(config_);
+    detector.set_bucket_size(series.bucket_size);
+    
+    std::vector<Anomaly> shifts;
+    auto feed = [&](std::chrono::system_clock::time_point start, size_t count) {
+        for (auto& shift : detector.add_bucket(start, count)) {
+            shifts.push_back(std::move(shift));
+        }
+    };
+    
+    if (from.has_value()) {
+        auto first = bucket_floor(*from, series.bucket_size);
+        if (series.points.empty() || first < series.points.front().timestamp) {
+            feed(first, 0);
+        }
+    }
+    for (const auto& point : series.points) {
+        feed(point.timestamp, point.count);
+    }
+    if (to.has_value()) {
+        auto last = bucket_floor(*to, series.bucket_size);
+        if (series.points.empty() || last > series.points.back().timestamp) {
+            feed(last, 0);
+        }
+    }
+    return shifts;
+}
+
+std::vector<Anomaly> ChangePointDetector::detect(const Stats& stats) const {
+    std::vector<Anomaly> shifts;
+    for (const auto& [sev, series] : stats.severity_time_series) {
+        for (auto& shift : detect(series, stats.start_time, stats.end_time)) {
+            shift.severity = sev;
+            describe_shift(shift);
+            shifts.push_back(std::move(shift));
+        }
+    }
+    return shifts;
+}
+
+std::vector<Anomaly> ChangePointDetector::detect_by_source(const EventView& events,
+                                                           core::Severity sev,
+                                                           std::chrono::minutes bucket_size) const {
+    using clock = std::chrono::system_clock;
+    
+    struct SourceSeries {
+        TimeSeries series;
+        clock::time_point first;
+        clock::time_point last;
+    };
+    std::map<std::string, SourceSeries> sources;
+    for (const auto& event : events) {
+        if (!event.ts.has_value()) {
+            continue;
+        }
+        auto tp = event.ts->tp;
+        auto [it, inserted] = sources.try_emplace(event.src.source_path,
+                                                  SourceSeries{TimeSeries(bucket_size), tp, tp});
+        SourceSeries& source = it->second;
+        source.first = std::min(source.first, tp);
+        source.last = std::max(source.last, tp);
+        if (event.sev == sev) {
+            source.series.add_event(tp);
+        }
+    }
+    
+    std::vector<Anomaly> shifts;
+    for (const auto& [path, source] : sources) {
+        for (auto& shift : detect(source.series, source.first, source.last)) {
+            shift.severity = sev;
+            shift.source = path;
+            describe_shift(shift);
+            shifts.push_back(std::move(shift));
+        }
+    }
+    return shifts;
+}
+
+void ChangePointDetector::reset() {
+    warm_n_ = 0;
+    warm_mean_ = 0.0;
+    warm_m2_ = 0.0;
+    s_hi_ = 0.0;
+    s_lo_ = 0.0;
+    hi_run_ = Run();
+    lo_run_ = Run();
+    std::fill(recent_.begin(), recent_.end(), 0.0);
+    recent_next_ = 0;
+    recent_n_ = 0;
+}
+
+std::optional<Anomaly> ChangePointDetector::step(std::chrono::system_clock::time_point bucket_start,
+                                                 double count) {
+    // Recent window, for confirming that a shift is still in place
+    recent_[recent_next_] = count;
+    recent_next_ = (recent_next_ + 1) % recent_.size();
+    recent_n_ = std::min(recent_n_ + 1, recent_.size());
+    
+    if (warm_n_ < config_.warmup_buckets) {
+        ++warm_n_;
+        double delta = count - warm_mean_;
+        warm_mean_ += delta / static_cast<double>(warm_n_);
+        warm_m2_ += delta * (count - warm_mean_);
+        if (warm_n_ == config_.warmup_buckets) {
+            ref_mean_ = warm_mean_;
+            double var = warm_m2_ / static_cast<double>(warm_n_ - 1);
+            ref_sigma_ = std::max({std::sqrt(var), std::sqrt(ref_mean_), 0.5});
+        }
+        return std::nullopt;
+    }
+    
+    double z = std::clamp((count - ref_mean_) / ref_sigma_, -config_.z_clip, config_.z_clip);
+    auto accumulate = [&](double& sum, Run& run, double deviation) {
+        double next = std::max(0.0, sum + deviation - config_.drift);
+        if (next > 0.0) {
+            if (sum == 0.0) {
+                run = Run{bucket_start, 0.0, 0};
+            }
+            run.sum += count;
+            ++run.buckets;
+        }
+        sum = next;
+    };
+    accumulate(s_hi_, hi_run_, z);
+    accumulate(s_lo_, lo_run_, -z);
+    
+    if (recent_n_ < recent_.size() ||
+        (s_hi_ <= config_.threshold && s_lo_ <= config_.threshold)) {
+        return std::nullopt;
+    }
+    
+    // All but one of the recent buckets must sit past the new level's side of
+    // the reference, so a spike of a bucket or two never confirms
+    double margin = config_.drift * ref_sigma_;
+    double up_level = std::max(ref_mean_ + margin, ref_mean_ * (1.0 + config_.min_relative_change));
+    double down_level = std::min(ref_mean_ - margin, ref_mean_ / (1.0 + config_.min_relative_change));
+    size_t above = 0;
+    size_t below = 0;
+    for (double value : recent_) {
+        above += value >= up_level ? 1 : 0;
+        below += value <= down_level ? 1 : 0;
+    }
+    size_t needed = std::max<size_t>(1, recent_.size() - 1);
+    
+    std::optional<Anomaly> shift;
+    if (s_hi_ > config_.threshold && above >= needed &&
+        hi_run_.sum >= static_cast<double>(config_.min_events)) {
+        shift = make_shift(hi_run_, bucket_start);
+    } else if (s_lo_ > config_.threshold && below >= needed &&
+               ref_mean_ * static_cast<double>(lo_run_.buckets) >= static_cast<double>(config_.min_events)) {
+        shift = make_shift(lo_run_, bucket_start);
+    }
+    
+    if (shift.has_value()) {
+        // Learn the new level as the reference before judging again
+        reset();
+    }
+    return shift;
+}
+
+Anomaly ChangePointDetector::make_shift(const Run& run,
+                                        std::chrono::system_clock::time_point bucket_start) const {
+    double minutes = static_cast<double>(bucket_size_.count());
+    
+    Anomaly anomaly;
+    anomaly.type = Anomaly::Type::LEVEL_SHIFT;
+    anomaly.start_time = run.start;
+    anomaly.end_time = bucket_start + bucket_size_;
+    anomaly.rate_before = ref_mean_ / minutes;
+    anomaly.rate_after = run.buckets > 0 ? run.sum / static_cast<double>(run.buckets) / minutes : 0.0;
+    describe_shift(anomaly);
+    
+    // A doubling (or halving) is a fair signal; 8x or a rate from nothing is
+    // as sure as it gets
+    double low = std::min(anomaly.rate_before, anomaly.rate_after);
+    double high = std::max(anomaly.rate_before, anomaly.rate_after);
+    anomaly.confidence = low > 0.0 ? std::min(0.95, 0.5 + 0.15 * std::log2(high / low)) : 0.95;
+    return anomaly;
+}
+
 // ============================================================================
 // RestartLoopDetector
 // ============================================================================
@@ -90,7 +1028,7 @@ std::vector<Anomaly> ErrorBurstDetector::find_bursts(
 RestartLoopDetector::RestartLoopDetector(const RestartLoopConfig& config)
     : config_(config) {}
 
-std::vector<Anomaly> RestartLoopDetector::detect(const std::vector<core::Event>& events) {
+std::vector<Anomaly> RestartLoopDetector::detect(const EventView& events) {
     std::vector<size_t> restart_indices;
     
     // Find all restart events
@@ -100,6 +1038,27 @@ std::vector<Anomaly> RestartLoopDetector::detect(const std::vector<core::Event>&
         }
     }
     
+    return detect_from(restart_indices, events);
+}
+
+std::vector<Anomaly> RestartLoopDetector::detect(const EventView& events,
+                                                 const TextIndex& text_index) {
+    return detect_from(text_index.positions_containing_any(config_.restart_keywords), events);
+}
+
+std::vector<Anomaly> RestartLoopDetector::detect(const EventView& events,
+                                                 const EventFeatures& features) {
+    if (features.size() != events.size() ||
+        !features.matches_keywords(Feature::RESTART, config_.restart_keywords)) {
+        return detect(events);
+    }
+    return detect_from(features.positions(Feature::RESTART), events);
+}
+
+std::vector<Anomaly> RestartLoopDetector::detect_from(
+    const std::vector<size_t>& restart_indices,
+    const EventView& events) const {
+    
     if (restart_indices.size() < config_.min_restart_count) {
         return {}; // Not enough restarts
     }
@@ -108,14 +1067,9 @@ std::vector<Anomaly> RestartLoopDetector::detect(const std::vector<core::Event>&
 }
 
 bool RestartLoopDetector::is_restart_event(const core::Event& event) const {
-    // Convert message to lowercase for case-insensitive matching
-    std::string lower_msg = event.message;
-    std::transform(lower_msg.begin(), lower_msg.end(), lower_msg.begin(),
-        [](unsigned char c) { return std::tolower(c); });
-    
-    // Check for restart keywords
+    // Check for restart keywords (case-insensitive)
     for (const auto& keyword : config_.restart_keywords) {
-        if (lower_msg.find(keyword) != std::string::npos) {
+        if (core::contains_ignore_case(event.message, keyword)) {
             return true;
         }
     }
@@ -125,7 +1079,7 @@ bool RestartLoopDetector::is_restart_event(const core::Event& event) const {
 
 std::vector<Anomaly> RestartLoopDetector::find_loops(
     const std::vector<size_t>& restart_indices,
-    const std::vector<core::Event>& events) const {
+    const EventView& events) const {
     
     std::vector<Anomaly> loops;
     
@@ -0,0 +1,288 @@
+#include "logstory/analysis/clock_skew.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <string_view>
+#include <unordered_map>
+
+namespace logstory::analysis {
+
+namespace {
+
+// One tagged event: the ID's dense slot, the source and the time in ms
+struct Occurrence {
+    uint32_t slot;
+    uint32_t source;
+    int64_t ms;
+};
+
+// Source pair (a < b) with o_b - o_a ~= delta ms, backed by `weight` IDs
+struct Edge {
+    uint32_t a;
+    uint32_t b;
+    double delta;
+    double weight;
+};
+
+// Neighbour's view of an edge: this node's offset ~= o_other + delta
+struct Link {
+    uint32_t other;
+    double delta;
+    double weight;
+};
+
+constexpr size_t kMaxSolverIterations = 10000;
+constexpr double kSolverTolerance = 1e-3;  // ms
+
+int64_t to_millis(std::chrono::system_clock::time_point tp) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(tp.time_since_epoch()).count();
+}
+
+uint64_t pair_key(uint32_t a, uint32_t b) {
+    return (static_cast<uint64_t>(a) << 32) | b;
+}
+
+double median(std::vector<int64_t>& values) {
+    size_t mid = values.size() / 2;
+    std::nth_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(mid), values.end());
+    double upper = static_cast<double>(values[mid]);
+    if (values.size() % 2 == 1) {
+        return upper;
+    }
+    double lower = static_cast<double>(*std::max_element(
+        values.begin(), values.begin() + static_cast<std::ptrdiff_t>(mid)));
+    return (lower + upper) / 2.0;
+}
+
+} // namespace
+
+const SourceOffset* ClockSkewEstimate::find(const std::string& source) const {
+    auto it = std::lower_bound(offsets.begin(), offsets.end(), source,
+        [](const SourceOffset& entry, const std::string& key) { return entry.source < key; });
+    return (it != offsets.end() && it->source == source) ? &*it : nullptr;
+}
+
+size_t ClockSkewEstimate::applied_count() const {
+    return static_cast<size_t>(std::count_if(offsets.begin(), offsets.end(),
+        [](const SourceOffset& entry) { return entry.applied; }));
+}
+
+ClockSkewEstimator::ClockSkewEstimator(const ClockSkewConfig& config) : config_(config) {}
+
+ClockSkewEstimate ClockSkewEstimator::estimate(const EventView& events) const {
+    ClockSkewEstimate result;
+    
+    // Views into the events' strings; the events outlive this call
+    std::unordered_map<std::string_view, uint32_t> source_ids;
+    std::vector<std::string_view> source_names;
+    auto intern_source = [&](std::string_view path) {
+        auto [it, inserted] = source_ids.try_emplace(path, static_cast<uint32_t>(source_names.size()));
+        if (inserted) {
+            source_names.push_back(path);
+        }
+        return it->second;
+    };
+    
+    std::unordered_map<uint64_t, std::vector<int64_t>> pair_deltas;
+    std::vector<Occurrence> occurrences;
+    std::vector<std::pair<uint32_t, int64_t>> first_seen;  // Per source, within one ID
+    
+    for (const auto& key : config_.id_keys) {
+        // Build side: (key, value) -> dense slot
+        std::unordered_map<std::string_view, uint32_t> slots;
+        occurrences.clear();
+        for (const auto& event : events) {
+            if (!event.ts.has_value() || event.src.source_path.empty()) {
+                continue;
+            }
+            auto tag = event.tags.find(key);
+            if (tag == event.tags.end() || tag->second.empty()) {
+                continue;
+            }
+            auto slot = slots.try_emplace(tag->second, static_cast<uint32_t>(slots.size())).first->second;
+            occurrences.push_back({slot, intern_source(event.src.source_path), to_millis(event.ts->tp)});
+        }
+        if (occurrences.empty()) {
+            continue;
+        }
+        
+        // Counting sort by slot so each ID's occurrences are contiguous
+        std::vector<size_t> start(slots.size() + 1, 0);
+        for (const auto& occ : occurrences) {
+            ++start[occ.slot + 1];
+        }
+        for (size_t s = 1; s < start.size(); ++s) {
+            start[s] += start[s - 1];
+        }
+        std::vector<Occurrence> by_slot(occurrences.size());
+        std::vector<size_t> fill(start.begin(), start.end() - 1);
+        for (const auto& occ : occurrences) {
+            by_slot[fill[occ.slot]++] = occ;
+        }
+        
+        // Probe: first sighting of each ID per source, then pairwise deltas
+        for (size_t s = 0; s + 1 < start.size(); ++s) {
+            size_t count = start[s + 1] - start[s];
+            if (count < 2 || count > config_.max_events_per_id) {
+                continue;
+            }
+            first_seen.clear();
+            for (size_t i = start[s]; i < start[s + 1]; ++i) {
+                const auto& occ = by_slot[i];
+                auto seen = std::find_if(first_seen.begin(), first_seen.end(),
+                    [&occ](const auto& entry) { return entry.first == occ.source; });
+                if (seen == first_seen.end()) {
+                    first_seen.emplace_back(occ.source, occ.ms);
+                } else {
+                    seen->second = std::min(seen->second, occ.ms);
+                }
+            }
+            if (first_seen.size() < 2) {
+                continue;
+            }
+            ++result.joined_ids;
+            
+            std::sort(first_seen.begin(), first_seen.end());
+            for (size_t i = 0; i < first_seen.size(); ++i) {
+                for (size_t j = i + 1; j < first_seen.size(); ++j) {
+                    int64_t delta = first_seen[j].second - first_seen[i].second;
+                    if (std::llabs(delta) > config_.max_delta.count()) {
+                        continue;
+                    }
+                    pair_deltas[pair_key(first_seen[i].first, first_seen[j].first)].push_back(delta);
+                }
+            }
+        }
+    }
+    
+    // One edge per well-supported pair, in key order for a deterministic solve
+    std::vector<Edge> edges;
+    for (auto& [key, deltas] : pair_deltas) {
+        if (deltas.size() < std::max<size_t>(1, config_.min_shared_ids)) {
+            continue;
+        }
+        edges.push_back({static_cast<uint32_t>(key >> 32), static_cast<uint32_t>(key & 0xffffffffu),
+                         median(deltas), static_cast<double>(deltas.size())});
+    }
+    if (edges.empty()) {
+        return result;
+    }
+    std::sort(edges.begin(), edges.end(), [](const Edge& x, const Edge& y) {
+        return pair_key(x.a, x.b) < pair_key(y.a, y.b);
+    });
+    
+    const size_t node_count = source_names.size();
+    std::vector<std::vector<Link>> links(node_count);
+    std::vector<size_t> shared(node_count, 0);
+    for (const auto& edge : edges) {
+        links[edge.b].push_back({edge.a, edge.delta, edge.weight});
+        links[edge.a].push_back({edge.b, -edge.delta, edge.weight});
+        shared[edge.a] += static_cast<size_t>(edge.weight);
+        shared[edge.b] += static_cast<size_t>(edge.weight);
+    }
+    
+    // Pin the best-connected source of each group to zero and seed the rest
+    // along a BFS tree, which is already exact when the group has no cycles
+    std::vector<double> offset(node_count, 0.0);
+    std::vector<int> group(node_count, -1);
+    std::vector<bool> is_reference(node_count, false);
+    std::vector<uint32_t> order(node_count);
+    for (uint32_t n = 0; n < node_count; ++n) {
+        order[n] = n;
+    }
+    std::sort(order.begin(), order.end(), [&](uint32_t x, uint32_t y) {
+        if (shared[x] != shared[y]) {
+            return shared[x] > shared[y];
+        }
+        return source_names[x] < source_names[y];
+    });
+    int group_count = 0;
+    for (uint32_t root : order) {
+        if (links[root].empty() || group[root] >= 0) {
+            continue;
+        }
+        is_reference[root] = true;
+        group[root] = group_count;
+        std::deque<uint32_t> queue = {root};
+        while (!queue.empty()) {
+            uint32_t node = queue.front();
+            queue.pop_front();
+            for (const auto& link : links[node]) {
+                if (group[link.other] < 0) {
+                    group[link.other] = group_count;
+                    offset[link.other] = offset[node] - link.delta;
+                    queue.push_back(link.other);
+                }
+            }
+        }
+        ++group_count;
+    }
+    
+    // Gauss-Seidel on the weighted least-squares normal equations: each free
+    // offset moves to the weighted mean of what its neighbours imply
+    for (size_t iter = 0; iter < kMaxSolverIterations; ++iter) {
+        double max_change = 0.0;
+        for (uint32_t node = 0; node < node_count; ++node) {
+            if (links[node].empty() || is_reference[node]) {
+                continue;
+            }
+            double sum = 0.0;
+            double weight = 0.0;
+            for (const auto& link : links[node]) {
+                sum += link.weight * (offset[link.other] + link.delta);
+                weight += link.weight;
+            }
+            double next = sum / weight;
+            max_change = std::max(max_change, std::abs(next - offset[node]));
+            offset[node] = next;
+        }
+        if (max_change < kSolverTolerance) {
+            break;
+        }
+    }
+    
+    for (uint32_t node = 0; node < node_count; ++node) {
+        if (links[node].empty()) {
+            continue;
+        }
+        SourceOffset entry;
+        entry.source = std::string(source_names[node]);
+        entry.offset = std::chrono::milliseconds(std::llround(offset[node]));
+        entry.shared_ids = shared[node];
+        entry.reference = is_reference[node];
+        entry.applied = !entry.reference &&
+                        std::chrono::abs(entry.offset) >= config_.min_offset;
+        result.offsets.push_back(std::move(entry));
+    }
+    std::sort(result.offsets.begin(), result.offsets.end(),
+        [](const SourceOffset& x, const SourceOffset& y) { return x.source < y.source; });
+    return result;
+}
+
+size_t ClockSkewEstimator::apply(const ClockSkewEstimate& estimate, std::vector<core::Event>& events) {
+    std::unordered_map<std::string_view, std::chrono::milliseconds> corrections;
+    for (const auto& entry : estimate.offsets) {
+        if (entry.applied) {
+            corrections.emplace(entry.source, entry.offset);
+        }
+    }
+    if (corrections.empty()) {
+        return 0;
+    }
+    
+    size_t changed = 0;
+    for (auto& event : events) {
+        if (!event.ts.has_value()) {
+            continue;
+        }
+        auto it = corrections.find(event.src.source_path);
+        if (it != corrections.end()) {
+            event.ts->tp -= it->second;
+            ++changed;
+        }
+    }
+    return changed;
+}
+
+} // namespace logstory::analysis
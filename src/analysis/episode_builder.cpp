@@ -1,234 +1,312 @@
 #include "logstory/analysis/episode_builder.hpp"
 #include <algorithm>
+#include <numeric>
 #include <unordered_map>
 
 namespace logstory::analysis {
 
-std::vector<Episode> EpisodeBuilder::build(const std::vector<core::Event>& events) {
-    if (events.empty()) {
-        return {};
+// ============================================================================
+// StreamingEpisodeBuilder
+// ============================================================================
+
+StreamingEpisodeBuilder::StreamingEpisodeBuilder(EpisodeConfig config, EmitFn emit,
+                                                 uint64_t first_episode_id)
+    : config_(config), emit_(std::move(emit)), next_episode_id_(first_episode_id) {}
+
+void StreamingEpisodeBuilder::add(const core::Event& event) {
+    // Start a new episode when the gap to the previous event is too large
+    if (current_.has_value() && has_prev_ && has_time_gap(prev_ts_, event.ts)) {
+        close_current();
     }
     
-    std::vector<Episode> episodes;
-    
-    // Phase 1: Group by time gaps
-    Episode current_episode(next_episode_id_++);
-    
-    for (size_t i = 0; i < events.size(); ++i) {
-        const auto& event = events[i];
-        
-        // Check if we should start a new episode
-        bool start_new = false;
-        if (!current_episode.empty() && i > 0) {
-            start_new = has_time_gap(events[i - 1], event);
-        }
-        
-        if (start_new) {
-            // Finalize current episode
-            update_metadata(current_episode, events);
-            identify_highlights(current_episode, events);
-            episodes.push_back(current_episode);
-            
-            // Start new episode
-            current_episode = Episode(next_episode_id_++);
-        }
-        
-        // Add event to current episode
-        current_episode.event_ids.push_back(event.id);
+    if (!current_.has_value()) {
+        current_.emplace();
+        current_->episode = Episode(next_episode_id_++);
     }
     
-    // Don't forget the last episode
-    if (!current_episode.empty()) {
-        update_metadata(current_episode, events);
-        identify_highlights(current_episode, events);
-        episodes.push_back(current_episode);
-    }
+    absorb(*current_, event);
     
-    // Phase 2: Merge adjacent episodes with shared correlation IDs
-    if (config_.merge_by_correlation && episodes.size() > 1) {
-        std::vector<Episode> merged;
-        merged.push_back(episodes[0]);
-        
-        for (size_t i = 1; i < episodes.size(); ++i) {
-            if (share_correlation_ids(merged.back(), episodes[i])) {
-                // Merge with previous episode
-                merged.back() = merge_episodes(merged.back(), episodes[i]);
-            } else {
-                merged.push_back(episodes[i]);
-            }
-        }
-        
-        return merged;
+    prev_ts_ = event.ts;
+    has_prev_ = true;
+}
+
+void StreamingEpisodeBuilder::flush() {
+    if (current_.has_value()) {
+        close_current();
     }
-    
-    return episodes;
+    if (pending_.has_value()) {
+        emit(std::move(*pending_));
+        pending_.reset();
+    }
+    prev_ts_.reset();
+    has_prev_ = false;
+}
+
+size_t StreamingEpisodeBuilder::open_episode_count() const {
+    return (current_.has_value() ? 1 : 0) + (pending_.has_value() ? 1 : 0);
 }
 
-bool EpisodeBuilder::has_time_gap(const core::Event& prev, const core::Event& next) const {
+bool StreamingEpisodeBuilder::has_time_gap(const std::optional<core::Timestamp>& prev,
+                                           const std::optional<core::Timestamp>& next) const {
     // If either event doesn't have a valid timestamp, don't break on time gap
-    if (!prev.ts.has_value() || !prev.ts->is_valid() ||
-        !next.ts.has_value() || !next.ts->is_valid()) {
+    if (!prev.has_value() || !prev->is_valid() ||
+        !next.has_value() || !next->is_valid()) {
         return false;
     }
     
-    auto gap = next.ts->tp - prev.ts->tp;
+    auto gap = next->tp - prev->tp;
     return gap > config_.time_gap_threshold;
 }
 
-std::vector<std::string> EpisodeBuilder::get_correlation_ids(const core::Event& event) const {
-    std::vector<std::string> ids;
+void StreamingEpisodeBuilder::absorb(OpenEpisode& open, const core::Event& event) const {
+    Episode& episode = open.episode;
+    episode.event_ids.push_back(event.id);
     
-    auto req_it = event.tags.find("request_id");
-    if (req_it != event.tags.end()) {
-        ids.push_back(req_it->second);
+    // Collect correlation IDs (first-seen order)
+    for (const char* key : {"request_id", "trace_id"}) {
+        auto it = event.tags.find(key);
+        if (it != event.tags.end() && open.corr_set.insert(it->second).second) {
+            episode.correlation_ids.push_back(it->second);
+        }
     }
     
-    auto trace_it = event.tags.find("trace_id");
-    if (trace_it != event.tags.end()) {
-        ids.push_back(trace_it->second);
+    // Track max severity
+    episode.max_severity = std::max(episode.max_severity, event.sev);
+    
+    // Track highlight candidates: first error and max severity event
+    if (open.first_error_id == 0 &&
+        (event.sev == core::Severity::ERROR || event.sev == core::Severity::FATAL)) {
+        open.first_error_id = event.id;
+    }
+    if (event.sev > open.max_severity_seen) {
+        open.max_severity_seen = event.sev;
+        open.max_severity_id = event.id;
     }
     
-    return ids;
+    // Track time boundaries
+    if (event.ts.has_value() && event.ts->is_valid()) {
+        if (!episode.start_time.has_value()) {
+            episode.start_time = event.ts->tp;
+            episode.end_time = event.ts->tp;
+        } else {
+            episode.start_time = std::min(*episode.start_time, event.ts->tp);
+            episode.end_time = std::max(*episode.end_time, event.ts->tp);
+        }
+    }
 }
 
-bool EpisodeBuilder::share_correlation_ids(const Episode& ep1, const Episode& ep2) const {
-    // Check if any correlation IDs are shared
-    for (const auto& id1 : ep1.correlation_ids) {
-        for (const auto& id2 : ep2.correlation_ids) {
-            if (id1 == id2) {
-                return true;
-            }
+void StreamingEpisodeBuilder::close_current() {
+    OpenEpisode closed = std::move(*current_);
+    current_.reset();
+    finalize_highlights(closed);
+    
+    if (!config_.merge_by_correlation) {
+        emit(std::move(closed));
+        return;
+    }
+    
+    // Hold the closed episode back so its successor can still merge into it
+    if (pending_.has_value() &&
+        pending_->episode.size() + closed.episode.size() <= config_.max_merged_episode_events &&
+        share_correlation_ids(*pending_, closed)) {
+        merge_into(*pending_, std::move(closed));
+        return;
+    }
+    
+    if (pending_.has_value()) {
+        emit(std::move(*pending_));
+    }
+    pending_ = std::move(closed);
+}
+
+void StreamingEpisodeBuilder::finalize_highlights(OpenEpisode& open) {
+    if (open.first_error_id != 0) {
+        open.episode.highlights.push_back(open.first_error_id);
+    }
+    if (open.max_severity_id != 0 && open.max_severity_id != open.first_error_id) {
+        open.episode.highlights.push_back(open.max_severity_id);
+    }
+}
+
+bool StreamingEpisodeBuilder::share_correlation_ids(const OpenEpisode& a, const OpenEpisode& b) {
+    // Probe the smaller set against the larger one
+    const auto& small = a.corr_set.size() <= b.corr_set.size() ? a.corr_set : b.corr_set;
+    const auto& large = a.corr_set.size() <= b.corr_set.size() ? b.corr_set : a.corr_set;
+    for (const auto& id : small) {
+        if (large.count(id) > 0) {
+            return true;
         }
     }
     return false;
 }
 
-Episode EpisodeBuilder::merge_episodes(const Episode& ep1, const Episode& ep2) {
-    Episode merged(ep1.id); // Keep first episode's ID
+void StreamingEpisodeBuilder::merge_into(OpenEpisode& target, OpenEpisode&& source) {
+    Episode& dst = target.episode;
+    Episode& src = source.episode;
     
-    // Merge event IDs
-    merged.event_ids = ep1.event_ids;
-    merged.event_ids.insert(merged.event_ids.end(), 
-                           ep2.event_ids.begin(), ep2.event_ids.end());
+    // Keep the earlier episode's ID; append the later one's events in order
+    dst.event_ids.insert(dst.event_ids.end(), src.event_ids.begin(), src.event_ids.end());
     
     // Merge times
-    merged.start_time = ep1.start_time;
-    merged.end_time = ep2.end_time;
+    if (!dst.start_time.has_value()) {
+        dst.start_time = src.start_time;
+    }
+    if (src.end_time.has_value()) {
+        dst.end_time = src.end_time;
+    }
     
     // Merge correlation IDs (unique)
-    std::unordered_set<std::string> unique_ids;
-    for (const auto& id : ep1.correlation_ids) {
-        unique_ids.insert(id);
-    }
-    for (const auto& id : ep2.correlation_ids) {
-        unique_ids.insert(id);
+    for (auto& id : src.correlation_ids) {
+        if (target.corr_set.insert(id).second) {
+            dst.correlation_ids.push_back(std::move(id));
+        }
     }
-    merged.correlation_ids.assign(unique_ids.begin(), unique_ids.end());
     
     // Merge highlights
-    merged.highlights = ep1.highlights;
-    merged.highlights.insert(merged.highlights.end(),
-                            ep2.highlights.begin(), ep2.highlights.end());
+    dst.highlights.insert(dst.highlights.end(), src.highlights.begin(), src.highlights.end());
     
     // Take max severity
-    merged.max_severity = std::max(ep1.max_severity, ep2.max_severity);
-    
-    return merged;
+    dst.max_severity = std::max(dst.max_severity, src.max_severity);
 }
 
-void EpisodeBuilder::identify_highlights(Episode& episode, 
-                                        const std::vector<core::Event>& events) {
-    if (episode.event_ids.empty()) {
-        return;
+void StreamingEpisodeBuilder::emit(OpenEpisode&& open) {
+    if (emit_) {
+        emit_(std::move(open.episode));
     }
+}
+
+// ============================================================================
+// CorrelationGrouper
+// ============================================================================
+
+namespace {
+
+/// Disjoint-set forest over episode indices, weighted by event count
+struct UnionFind {
+    std::vector<size_t> parent;
+    std::vector<size_t> weight;
     
-    // Build a map of event ID to event for quick lookup
-    std::unordered_map<core::EventId, const core::Event*> event_map;
-    for (const auto& event : events) {
-        event_map[event.id] = &event;
+    explicit UnionFind(const std::vector<Episode>& episodes)
+        : parent(episodes.size()), weight(episodes.size()) {
+        std::iota(parent.begin(), parent.end(), 0);
+        for (size_t i = 0; i < episodes.size(); ++i) {
+            weight[i] = episodes[i].size();
+        }
     }
     
-    core::EventId first_error_id = 0;
-    core::EventId max_severity_id = 0;
-    core::Severity max_sev = core::Severity::UNKNOWN;
-    
-    for (const auto& event_id : episode.event_ids) {
-        auto it = event_map.find(event_id);
-        if (it == event_map.end()) {
-            continue;
-        }
-        
-        const auto& event = *it->second;
-        
-        // Track first error
-        if (first_error_id == 0 && 
-            (event.sev == core::Severity::ERROR || event.sev == core::Severity::FATAL)) {
-            first_error_id = event.id;
-        }
-        
-        // Track max severity event
-        if (event.sev > max_sev) {
-            max_sev = event.sev;
-            max_severity_id = event.id;
+    size_t find(size_t x) {
+        while (parent[x] != x) {
+            parent[x] = parent[parent[x]]; // Path halving
+            x = parent[x];
         }
+        return x;
     }
     
-    // Add highlights
-    if (first_error_id != 0) {
-        episode.highlights.push_back(first_error_id);
-    }
-    if (max_severity_id != 0 && max_severity_id != first_error_id) {
-        episode.highlights.push_back(max_severity_id);
+    /// Join the sets of a and b unless the result would exceed max_weight
+    void unite(size_t a, size_t b, size_t max_weight) {
+        a = find(a);
+        b = find(b);
+        if (a == b || weight[a] + weight[b] > max_weight) {
+            return;
+        }
+        if (weight[a] < weight[b]) {
+            std::swap(a, b);
+        }
+        parent[b] = a;
+        weight[a] += weight[b];
     }
-}
+};
 
-void EpisodeBuilder::update_metadata(Episode& episode, 
-                                     const std::vector<core::Event>& events) {
-    if (episode.event_ids.empty()) {
-        return;
+} // namespace
+
+std::vector<Episode> CorrelationGrouper::group(std::vector<Episode>&& episodes) const {
+    if (episodes.size() < 2) {
+        return std::move(episodes);
     }
     
-    // Build event map
-    std::unordered_map<core::EventId, const core::Event*> event_map;
-    for (const auto& event : events) {
-        event_map[event.id] = &event;
+    // Union every episode with the first episode seen for each correlation ID
+    UnionFind sets(episodes);
+    std::unordered_map<std::string, size_t> first_owner;
+    for (size_t i = 0; i < episodes.size(); ++i) {
+        for (const auto& corr_id : episodes[i].correlation_ids) {
+            auto [it, inserted] = first_owner.emplace(corr_id, i);
+            if (!inserted) {
+                sets.unite(it->second, i, config_.max_merged_episode_events);
+            }
+        }
     }
     
-    // Collect correlation IDs and find time boundaries
-    std::unordered_set<std::string> unique_corr_ids;
-    core::Severity max_sev = core::Severity::UNKNOWN;
+    // Materialize groups in order of their earliest episode
+    std::vector<Episode> grouped;
+    std::vector<size_t> slot_of_root(episodes.size(), static_cast<size_t>(-1));
+    std::vector<std::unordered_set<std::string>> corr_sets;
     
-    for (const auto& event_id : episode.event_ids) {
-        auto it = event_map.find(event_id);
-        if (it == event_map.end()) {
+    for (size_t i = 0; i < episodes.size(); ++i) {
+        size_t root = sets.find(i);
+        Episode& ep = episodes[i];
+        
+        if (slot_of_root[root] == static_cast<size_t>(-1)) {
+            slot_of_root[root] = grouped.size();
+            corr_sets.emplace_back(ep.correlation_ids.begin(), ep.correlation_ids.end());
+            grouped.push_back(std::move(ep));
             continue;
         }
         
-        const auto& event = *it->second;
+        size_t slot = slot_of_root[root];
+        Episode& dst = grouped[slot];
         
-        // Collect correlation IDs
-        auto corr_ids = get_correlation_ids(event);
-        for (const auto& id : corr_ids) {
-            unique_corr_ids.insert(id);
-        }
+        dst.event_ids.insert(dst.event_ids.end(), ep.event_ids.begin(), ep.event_ids.end());
+        dst.highlights.insert(dst.highlights.end(), ep.highlights.begin(), ep.highlights.end());
+        dst.max_severity = std::max(dst.max_severity, ep.max_severity);
         
-        // Track max severity
-        max_sev = std::max(max_sev, event.sev);
+        if (ep.start_time.has_value()) {
+            dst.start_time = dst.start_time.has_value()
+                ? std::min(*dst.start_time, *ep.start_time) : *ep.start_time;
+        }
+        if (ep.end_time.has_value()) {
+            dst.end_time = dst.end_time.has_value()
+                ? std::max(*dst.end_time, *ep.end_time) : *ep.end_time;
+        }
         
-        // Track time boundaries
-        if (event.ts.has_value() && event.ts->is_valid()) {
-            if (!episode.start_time.has_value()) {
-                episode.start_time = event.ts->tp;
-                episode.end_time = event.ts->tp;
-            } else {
-                episode.start_time = std::min(*episode.start_time, event.ts->tp);
-                episode.end_time = std::max(*episode.end_time, event.ts->tp);
+        for (auto& corr_id : ep.correlation_ids) {
+            if (corr_sets[slot].insert(corr_id).second) {
+                dst.correlation_ids.push_back(std::move(corr_id));
             }
         }
     }
     
-    episode.correlation_ids.assign(unique_corr_ids.begin(), unique_corr_ids.end());
-    episode.max_severity = max_sev;
+    return grouped;
+}
+
+// ============================================================================
+// EpisodeBuilder
+// ============================================================================
+
+std::vector<Episode> EpisodeBuilder::build(const EventView& events) {
+    if (events.empty()) {
+        return {};
+    }
+    
+    std::vector<Episode> episodes;
+    
+    StreamingEpisodeBuilder stream(
+        config_,
+        [&episodes](Episode&& episode) { episodes.push_back(std::move(episode)); },
+        next_episode_id_);
+    
+    for (const auto& event : events) {
+        stream.add(event);
+    }
+    stream.flush();
+    
+    next_episode_id_ = stream.next_episode_id();
+    
+    // Join non-adjacent episodes that share request/trace IDs
+    if (config_.merge_by_correlation && config_.merge_across_gaps) {
+        episodes = CorrelationGrouper(config_).group(std::move(episodes));
+    }
+    
+    return episodes;
 }
 
 } // namespace logstory::analysis
@@ -0,0 +1,195 @@
+#include "logstory/analysis/event_features.hpp"
+#include <algorithm>
+#include <cctype>
+#include <deque>
+
+namespace logstory::analysis {
+
+namespace {
+
+// Events per task when building on a pool
+constexpr size_t kChunkEvents = 16384;
+
+} // namespace
+
+// ============================================================================
+// KeywordAutomaton
+// ============================================================================
+
+KeywordAutomaton::KeywordAutomaton() {
+    std::fill(std::begin(classes_), std::end(classes_), uint8_t(0));
+    goto_.emplace_back();
+    output_.push_back(0);
+}
+
+uint8_t KeywordAutomaton::class_of(unsigned char c) {
+    unsigned char lower = static_cast<unsigned char>(std::tolower(c));
+    if (classes_[lower] == 0) {
+        auto cls = static_cast<uint8_t>(class_count_++);
+        classes_[lower] = cls;
+        classes_[static_cast<unsigned char>(std::toupper(lower))] = cls;
+    }
+    return classes_[lower];
+}
+
+void KeywordAutomaton::add(std::string_view keyword, FeatureMask features) {
+    if (keyword.empty()) {
+        return;
+    }
+    built_ = false;
+    
+    size_t state = 0;
+    for (char ch : keyword) {
+        uint8_t cls = class_of(static_cast<unsigned char>(ch));
+        if (goto_[state].size() <= cls) {
+            goto_[state].resize(cls + 1, -1);
+        }
+        if (goto_[state][cls] < 0) {
+            goto_[state][cls] = static_cast<int32_t>(goto_.size());
+            goto_.emplace_back();
+            output_.push_back(0);
+        }
+        state = static_cast<size_t>(goto_[state][cls]);
+    }
+    output_[state] |= features;
+    all_features_ |= features;
+}
+
+void KeywordAutomaton::build() {
+    const size_t states = goto_.size();
+    const size_t classes = class_count_;
+    auto edge = [this](size_t state, size_t cls) {
+        return cls < goto_[state].size() ? goto_[state][cls] : -1;
+    };
+    
+    next_.assign(states * classes, 0);
+    std::vector<uint32_t> fail(states, 0);
+    std::deque<size_t> queue;
+    
+    for (size_t cls = 0; cls < classes; ++cls) {
+        int32_t child = edge(0, cls);
+        if (child > 0) {
+            next_[cls] = static_cast<uint32_t>(child);
+            queue.push_back(static_cast<size_t>(child));
+        }
+    }
+    
+    // Breadth-first, so each fail target's transitions and outputs are final
+    // before they are copied
+    while (!queue.empty()) {
+        size_t state = queue.front();
+        queue.pop_front();
+        for (size_t cls = 0; cls < classes; ++cls) {
+            int32_t child = edge(state, cls);
+            uint32_t fallback = next_[fail[state] * classes + cls];
+            if (child > 0) {
+                fail[child] = fallback;
+                output_[child] |= output_[fallback];
+                next_[state * classes + cls] = static_cast<uint32_t>(child);
+                queue.push_back(static_cast<size_t>(child));
+            } else {
+                next_[state * classes + cls] = fallback;
+            }
+        }
+    }
+    built_ = true;
+}
+
+FeatureMask KeywordAutomaton::scan(std::string_view text) const {
+    if (!built_ || all_features_ == 0) {
+        return 0;
+    }
+    
+    const size_t classes = class_count_;
+    uint32_t state = 0;
+    FeatureMask found = 0;
+    for (char ch : text) {
+        state = next_[state * classes + classes_[static_cast<unsigned char>(ch)]];
+        found |= output_[state];
+        if (found == all_features_) {
+            break;
+        }
+    }
+    return found;
+}
+
+// ============================================================================
+// EventFeatures
+// ============================================================================
+
+const std::vector<std::string>& default_keywords(Feature f) {
+    static const std::vector<std::string> kRestart = {
+        "starting", "started", "shutdown", "stopping", "stopped",
+        "restarting", "restart", "initializing", "initialized"
+    };
+    static const std::vector<std::string> kChange = {
+        "deploy", "deployment", "config", "configuration",
+        "release", "rollout", "upgrade", "migration"
+    };
+    static const std::vector<std::string> kRetry = {"retry", "retrying", "attempt"};
+    static const std::vector<std::string> kTimeout = {"timeout", "timed out"};
+    
+    switch (f) {
+        case Feature::RESTART: return kRestart;
+        case Feature::CHANGE: return kChange;
+        case Feature::RETRY: return kRetry;
+        case Feature::TIMEOUT: return kTimeout;
+    }
+    return kRestart;
+}
+
+const std::vector<std::string>& EventFeatureConfig::keywords(Feature f) const {
+    switch (f) {
+        case Feature::RESTART: return restart_keywords;
+        case Feature::CHANGE: return change_keywords;
+        case Feature::RETRY: return retry_keywords;
+        case Feature::TIMEOUT: return timeout_keywords;
+    }
+    return restart_keywords;
+}
+
+EventFeatures::EventFeatures(const EventFeatureConfig& config) : config_(config) {
+    auto add_all = [this](const std::vector<std::string>& keywords, Feature feature) {
+        for (const auto& keyword : keywords) {
+            automaton_.add(keyword, feature_bit(feature));
+        }
+    };
+    add_all(config.restart_keywords, Feature::RESTART);
+    add_all(config.change_keywords, Feature::CHANGE);
+    add_all(config.retry_keywords, Feature::RETRY);
+    add_all(config.timeout_keywords, Feature::TIMEOUT);
+    automaton_.build();
+}
+
+void EventFeatures::build(const EventView& events, core::ThreadPool* pool) {
+    masks_.assign(events.size(), 0);
+    
+    auto classify_range = [this, &events](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            masks_[i] = automaton_.scan(events[i].message);
+        }
+    };
+    
+    if (pool == nullptr || pool->size() <= 1 || events.size() <= kChunkEvents) {
+        classify_range(0, events.size());
+        return;
+    }
+    
+    for (size_t begin = 0; begin < events.size(); begin += kChunkEvents) {
+        size_t end = std::min(events.size(), begin + kChunkEvents);
+        pool->submit([&classify_range, begin, end]() { classify_range(begin, end); });
+    }
+    pool->wait();
+}
+
+std::vector<size_t> EventFeatures::positions(Feature f) const {
+    std::vector<size_t> result;
+    for (size_t i = 0; i < masks_.size(); ++i) {
+        if ((masks_[i] & feature_bit(f)) != 0) {
+            result.push_back(i);
+        }
+    }
+    return result;
+}
+
+} // namespace logstory::analysis
@@ -1,92 +1,158 @@
 #include "logstory/analysis/event_index.hpp"
 #include <algorithm>
+#include <numeric>
 
 namespace logstory::analysis {
 
-void EventIndex::build(const std::vector<core::Event>& events) {
+void EventIndex::build(const EventView& events) {
     events_ = events;
     
     // Clear existing indices
-    severity_index_.clear();
+    severity_index_.fill(PostingList());
     correlation_index_.clear();
     time_index_.clear();
     
+    // Posting lists are appended in ascending ID order; parser output already
+    // is, so only visit through a sorted permutation when it isn't
+    std::vector<size_t> order;
+    bool ascending = std::is_sorted(events.begin(), events.end(),
+        [](const core::Event& a, const core::Event& b) { return a.id < b.id; });
+    if (!ascending) {
+        order.resize(events.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(),
+            [&events](size_t a, size_t b) { return events[a].id < events[b].id; });
+    }
+    
     // Build indices
-    for (const auto& event : events_) {
+    for (size_t i = 0; i < events.size(); ++i) {
+        const core::Event& event = ascending ? events[i] : events[order[i]];
+        
         // Index by severity
-        severity_index_[event.sev].push_back(event.id);
+        severity_index_[static_cast<size_t>(event.sev)].append(event.id);
         
         // Index by correlation IDs
-        auto req_it = event.tags.find("request_id");
-        if (req_it != event.tags.end()) {
-            correlation_index_[req_it->second].push_back(event.id);
-        }
-        
-        auto trace_it = event.tags.find("trace_id");
-        if (trace_it != event.tags.end()) {
-            correlation_index_[trace_it->second].push_back(event.id);
+        for (const char* key : {"request_id", "trace_id", "uuid"}) {
+            auto it = event.tags.find(key);
+            if (it != event.tags.end()) {
+                correlation_index_[it->second].append(event.id);
+            }
         }
         
-        auto uuid_it = event.tags.find("uuid");
-        if (uuid_it != event.tags.end()) {
-            correlation_index_[uuid_it->second].push_back(event.id);
-        }
-        
-        // Index by time (if timestamp available)
+    }
+    
+    // Index by time (if timestamp available)
+    for (size_t i = 0; i < events.size(); ++i) {
+        const core::Event& event = events[i];
         if (event.ts.has_value() && event.ts->is_valid()) {
-            int64_t bucket = time_to_bucket(event.ts->tp);
-            time_index_[bucket].push_back(event.id);
+            time_index_.push_back(TimeEntry{event.ts->tp, i});
+        }
+    }
+    
+    // Logs are mostly time-ordered already, which keeps this sort cheap
+    auto by_time = [](const TimeEntry& a, const TimeEntry& b) {
+        return a.tp < b.tp || (a.tp == b.tp && a.index < b.index);
+    };
+    if (!std::is_sorted(time_index_.begin(), time_index_.end(), by_time)) {
+        std::sort(time_index_.begin(), time_index_.end(), by_time);
+    }
+    
+    // Per-severity prefix counts over the time-sorted entries
+    for (auto& prefix : severity_prefix_) {
+        prefix.assign(time_index_.size() + 1, 0);
+    }
+    for (size_t i = 0; i < time_index_.size(); ++i) {
+        auto sev = static_cast<size_t>(events[time_index_[i].index].sev);
+        for (size_t s = 0; s < kSeverityCount; ++s) {
+            severity_prefix_[s][i + 1] = severity_prefix_[s][i] + (s == sev ? 1 : 0);
         }
     }
 }
 
 std::vector<core::EventId> EventIndex::get_by_severity(core::Severity sev) const {
-    auto it = severity_index_.find(sev);
-    if (it != severity_index_.end()) {
-        return it->second;
-    }
-    return {};
+    return severity_postings(sev).decode();
 }
 
 std::vector<core::EventId> EventIndex::get_by_correlation_id(const std::string& corr_id) const {
+    return correlation_postings(corr_id).decode();
+}
+
+const PostingList& EventIndex::severity_postings(core::Severity sev) const {
+    static const PostingList empty;
+    auto idx = static_cast<size_t>(sev);
+    return idx < severity_index_.size() ? severity_index_[idx] : empty;
+}
+
+const PostingList& EventIndex::correlation_postings(const std::string& corr_id) const {
+    static const PostingList empty;
     auto it = correlation_index_.find(corr_id);
-    if (it != correlation_index_.end()) {
-        return it->second;
+    return it != correlation_index_.end() ? it->second : empty;
+}
+
+PostingList EventIndex::severity_at_least(core::Severity min_sev) const {
+    std::vector<const PostingList*> lists;
+    for (size_t idx = static_cast<size_t>(min_sev); idx < severity_index_.size(); ++idx) {
+        lists.push_back(&severity_index_[idx]);
     }
-    return {};
+    return PostingList::unite_all(lists);
 }
 
 std::vector<core::EventId> EventIndex::get_by_time_range(TimePoint start, TimePoint end) const {
-    std::vector<core::EventId> result;
+    auto [first, last] = time_range_bounds(start, end);
     
-    int64_t start_bucket = time_to_bucket(start);
-    int64_t end_bucket = time_to_bucket(end);
+    std::vector<core::EventId> result;
+    result.reserve(last - first);
+    for (size_t i = first; i < last; ++i) {
+        result.push_back(events_[time_index_[i].index].id);
+    }
     
-    // Iterate through buckets in range
-    auto it = time_index_.lower_bound(start_bucket);
-    auto end_it = time_index_.upper_bound(end_bucket);
+    return result;
+}
+
+std::vector<size_t> EventIndex::get_indices_by_time_range(TimePoint start, TimePoint end) const {
+    auto [first, last] = time_range_bounds(start, end);
     
-    for (; it != end_it; ++it) {
-        // Add all events from this bucket
-        result.insert(result.end(), it->second.begin(), it->second.end());
+    std::vector<size_t> result;
+    result.reserve(last - first);
+    for (size_t i = first; i < last; ++i) {
+        result.push_back(time_index_[i].index);
     }
     
     return result;
 }
 
-size_t EventIndex::count_by_severity(core::Severity sev) const {
-    auto it = severity_index_.find(sev);
-    if (it != severity_index_.end()) {
-        return it->second.size();
+size_t EventIndex::count_in_time_range(TimePoint start, TimePoint end) const {
+    auto [first, last] = time_range_bounds(start, end);
+    return last - first;
+}
+
+size_t EventIndex::count_by_severity_in_time_range(core::Severity sev,
+                                                   TimePoint start, TimePoint end) const {
+    auto idx = static_cast<size_t>(sev);
+    if (idx >= severity_prefix_.size() || severity_prefix_[idx].empty()) {
+        return 0;
     }
-    return 0;
+    
+    auto [first, last] = time_range_bounds(start, end);
+    return severity_prefix_[idx][last] - severity_prefix_[idx][first];
 }
 
-int64_t EventIndex::time_to_bucket(TimePoint tp) const {
-    // Convert to minutes since epoch
-    auto duration = tp.time_since_epoch();
-    auto minutes = std::chrono::duration_cast<std::chrono::minutes>(duration);
-    return minutes.count();
+std::pair<size_t, size_t> EventIndex::time_range_bounds(TimePoint start, TimePoint end) const {
+    if (end < start) {
+        return {0, 0};
+    }
+    
+    auto first = std::lower_bound(time_index_.begin(), time_index_.end(), start,
+        [](const TimeEntry& e, TimePoint t) { return e.tp < t; });
+    auto last = std::upper_bound(first, time_index_.end(), end,
+        [](TimePoint t, const TimeEntry& e) { return t < e.tp; });
+    
+    return {static_cast<size_t>(first - time_index_.begin()),
+            static_cast<size_t>(last - time_index_.begin())};
+}
+
+size_t EventIndex::count_by_severity(core::Severity sev) const {
+    return severity_postings(sev).size();
 }
 
 } // namespace logstory::analysis
@@ -0,0 +1,90 @@
+#include "logstory/analysis/event_lookup.hpp"
+#include <algorithm>
+
+namespace logstory::analysis {
+
+EventLookup::EventLookup(const EventView& events) {
+    build(events);
+}
+
+void EventLookup::build(const EventView& events) {
+    events_ = events;
+    offsets_.clear();
+    hashed_.clear();
+    base_id_ = 0;
+    
+    if (events.empty()) {
+        mode_ = Mode::EMPTY;
+        return;
+    }
+    
+    // Fast path: IDs are contiguous in store order (fresh parser output)
+    base_id_ = events[0].id;
+    bool contiguous = true;
+    core::EventId min_id = base_id_;
+    core::EventId max_id = base_id_;
+    for (size_t i = 0; i < events.size(); ++i) {
+        core::EventId id = events[i].id;
+        if (contiguous && id != base_id_ + i) {
+            contiguous = false;
+        }
+        min_id = std::min(min_id, id);
+        max_id = std::max(max_id, id);
+    }
+    
+    if (contiguous) {
+        mode_ = Mode::CONTIGUOUS;
+        return;
+    }
+    
+    // Gappy but compact ID range: dense offset table
+    uint64_t span = max_id - min_id + 1;
+    if (span / kMaxSpanFactor <= events.size()) {
+        mode_ = Mode::OFFSET_TABLE;
+        base_id_ = min_id;
+        offsets_.assign(static_cast<size_t>(span), npos);
+        for (size_t i = 0; i < events.size(); ++i) {
+            size_t& slot = offsets_[events[i].id - base_id_];
+            if (slot == npos) {
+                slot = i; // First occurrence wins for duplicate IDs
+            }
+        }
+        return;
+    }
+    
+    // Arbitrary ID set: hash map
+    mode_ = Mode::HASHED;
+    hashed_.reserve(events.size());
+    for (size_t i = 0; i < events.size(); ++i) {
+        hashed_.emplace(events[i].id, i);
+    }
+}
+
+size_t EventLookup::index_of(core::EventId id) const {
+    switch (mode_) {
+        case Mode::CONTIGUOUS:
+            if (id >= base_id_ && id - base_id_ < events_.size()) {
+                return static_cast<size_t>(id - base_id_);
+            }
+            return npos;
+        case Mode::OFFSET_TABLE:
+            if (id >= base_id_ && id - base_id_ < offsets_.size()) {
+                return offsets_[id - base_id_];
+            }
+            return npos;
+        case Mode::HASHED: {
+            auto it = hashed_.find(id);
+            return it != hashed_.end() ? it->second : npos;
+        }
+        case Mode::EMPTY:
+        default:
+            return npos;
+    }
+}
+
+const core::Event* EventLookup::find(core::EventId id) const {
+    size_t idx = index_of(id);
+    return idx != npos ? &events_[idx] : nullptr;
+}
+
+} // namespace logstory::analysis
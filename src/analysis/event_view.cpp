@@ -0,0 +1,47 @@
+#include "logstory/analysis/event_view.hpp"
+#include <utility>
+
+namespace logstory::analysis {
+
+EventView::EventView(const std::vector<core::Event>& events, std::vector<size_t> positions)
+    : store_(&events), full_(false), positions_(std::move(positions)) {}
+
+EventView EventView::subset(std::vector<size_t> indices) const {
+    if (!store_) {
+        return EventView();
+    }
+    if (!full_) {
+        for (size_t& i : indices) {
+            i = positions_[i];
+        }
+    }
+    return EventView(*store_, std::move(indices));
+}
+
+std::vector<core::Event> EventView::materialize() const {
+    return std::vector<core::Event>(begin(), end());
+}
+
+core::Status EventView::compact(std::vector<core::Event>& store) {
+    if (&store != store_) {
+        return core::Status(core::ErrorCode::INVALID_INPUT,
+                           "EventView::compact called with a store the view doesn't refer to");
+    }
+    if (!full_) {
+        // Positions ascend, so each target slot is at or before its source
+        size_t kept = 0;
+        for (size_t pos : positions_) {
+            if (pos != kept) {
+                store[kept] = std::move(store[pos]);
+            }
+            ++kept;
+        }
+        store.erase(store.begin() + static_cast<std::ptrdiff_t>(kept), store.end());
+    }
+    store_ = nullptr;
+    full_ = true;
+    positions_.clear();
+    return core::Status::OK();
+}
+
+} // namespace logstory::analysis
@@ -0,0 +1,181 @@
+#include "logstory/analysis/heavy_hitters.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace logstory::analysis {
+
+namespace {
+
+// Count descending, then key ascending, so reports are deterministic
+bool by_count_then_key(const HeavyHitters::Counter& a, const HeavyHitters::Counter& b) {
+    if (a.count != b.count) {
+        return a.count > b.count;
+    }
+    return a.key < b.key;
+}
+
+} // namespace
+
+HeavyHitters::HeavyHitters(size_t capacity) : capacity_(std::max<size_t>(1, capacity)) {}
+
+size_t HeavyHitters::capacity_for_error(double epsilon) {
+    if (epsilon <= 0.0) {
+        return 1;
+    }
+    return static_cast<size_t>(std::ceil(1.0 / epsilon));
+}
+
+size_t HeavyHitters::capacity_for_budget(size_t bytes, size_t avg_key_bytes) {
+    // Counter + index entry + heap slots, each holding a copy of the key
+    size_t per_counter = sizeof(Counter) + sizeof(std::pair<std::string, size_t>) +
+                         2 * sizeof(size_t) + 2 * avg_key_bytes + 32;
+    return std::max<size_t>(1, bytes / per_counter);
+}
+
+void HeavyHitters::add(const std::string& key, core::Severity sev, size_t count) {
+    total_ += count;
+    
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        Counter& counter = counters_[it->second];
+        counter.count += count;
+        counter.max_severity = std::max(counter.max_severity, sev);
+        sift_down(heap_slot_[it->second]);
+        return;
+    }
+    
+    if (!full()) {
+        size_t pos = counters_.size();
+        counters_.push_back(Counter{key, count, 0, sev});
+        index_.emplace(key, pos);
+        heap_.push_back(pos);
+        heap_slot_.push_back(heap_.size() - 1);
+        sift_up(heap_.size() - 1);
+        return;
+    }
+    
+    // Take over the smallest counter; its count bounds what the new key
+    // could have had before
+    size_t pos = heap_[0];
+    Counter& counter = counters_[pos];
+    index_.erase(counter.key);
+    counter.key = key;
+    counter.error = counter.count;
+    counter.count += count;
+    counter.max_severity = sev;
+    index_.emplace(key, pos);
+    sift_down(0);
+}
+
+void HeavyHitters::merge(const HeavyHitters& other) {
+    size_t own_floor = error_bound();
+    size_t other_floor = other.error_bound();
+    
+    std::unordered_map<std::string, Counter> combined;
+    combined.reserve(counters_.size() + other.counters_.size());
+    for (const auto& counter : counters_) {
+        Counter merged = counter;
+        if (other.index_.find(counter.key) == other.index_.end()) {
+            merged.count += other_floor;
+            merged.error += other_floor;
+        }
+        combined.emplace(counter.key, std::move(merged));
+    }
+    for (const auto& counter : other.counters_) {
+        auto it = combined.find(counter.key);
+        if (it != combined.end()) {
+            it->second.count += counter.count;
+            it->second.error += counter.error;
+            it->second.max_severity = std::max(it->second.max_severity, counter.max_severity);
+        } else {
+            Counter merged = counter;
+            merged.count += own_floor;
+            merged.error += own_floor;
+            combined.emplace(counter.key, std::move(merged));
+        }
+    }
+    
+    std::vector<Counter> counters;
+    counters.reserve(combined.size());
+    for (auto& [key, counter] : combined) {
+        counters.push_back(std::move(counter));
+    }
+    if (counters.size() > capacity_) {
+        std::nth_element(counters.begin(), counters.begin() + static_cast<std::ptrdiff_t>(capacity_),
+                         counters.end(), by_count_then_key);
+        counters.resize(capacity_);
+    }
+    
+    total_ += other.total_;
+    rebuild(std::move(counters));
+}
+
+std::vector<HeavyHitters::Counter> HeavyHitters::top(size_t n) const {
+    std::vector<Counter> result(counters_);
+    n = std::min(n, result.size());
+    std::partial_sort(result.begin(), result.begin() + static_cast<std::ptrdiff_t>(n),
+                      result.end(), by_count_then_key);
+    result.resize(n);
+    return result;
+}
+
+size_t HeavyHitters::error_bound() const {
+    return full() ? counters_[heap_[0]].count : 0;
+}
+
+bool HeavyHitters::heap_less(size_t a, size_t b) const {
+    return counters_[heap_[a]].count < counters_[heap_[b]].count;
+}
+
+void HeavyHitters::heap_swap(size_t a, size_t b) {
+    std::swap(heap_[a], heap_[b]);
+    heap_slot_[heap_[a]] = a;
+    heap_slot_[heap_[b]] = b;
+}
+
+void HeavyHitters::sift_up(size_t slot) {
+    while (slot > 0) {
+        size_t parent = (slot - 1) / 2;
+        if (!heap_less(slot, parent)) {
+            break;
+        }
+        heap_swap(slot, parent);
+        slot = parent;
+    }
+}
+
+void HeavyHitters::sift_down(size_t slot) {
+    while (true) {
+        size_t smallest = slot;
+        size_t left = 2 * slot + 1;
+        size_t right = left + 1;
+        if (left < heap_.size() && heap_less(left, smallest)) {
+            smallest = left;
+        }
+        if (right < heap_.size() && heap_less(right, smallest)) {
+            smallest = right;
+        }
+        if (smallest == slot) {
+            return;
+        }
+        heap_swap(slot, smallest);
+        slot = smallest;
+    }
+}
+
+void HeavyHitters::rebuild(std::vector<Counter> counters) {
+    counters_ = std::move(counters);
+    index_.clear();
+    heap_.resize(counters_.size());
+    heap_slot_.resize(counters_.size());
+    for (size_t i = 0; i < counters_.size(); ++i) {
+        index_.emplace(counters_[i].key, i);
+        heap_[i] = i;
+        heap_slot_[i] = i;
+    }
+    for (size_t slot = heap_.size() / 2; slot-- > 0;) {
+        sift_down(slot);
+    }
+}
+
+} // namespace logstory::analysis
@@ -0,0 +1,102 @@
+#include "logstory/analysis/hyperloglog.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace logstory::analysis {
+
+uint64_t HyperLogLog::hash(std::string_view value) {
+    // FNV-1a, then a splitmix64 finalizer so every output bit is mixed
+    // (the register index comes from the top bits)
+    uint64_t h = 1469598103934665603ULL;
+    for (char c : value) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 1099511628211ULL;
+    }
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebULL;
+    h ^= h >> 31;
+    return h;
+}
+
+void HyperLogLog::add(std::string_view value) {
+    add_hash(hash(value));
+}
+
+void HyperLogLog::add_hash(uint64_t h) {
+    if (is_exact()) {
+        exact_.insert(h);
+        if (exact_.size() > kExactThreshold) {
+            to_registers();
+        }
+        return;
+    }
+    update_register(h);
+}
+
+void HyperLogLog::merge(const HyperLogLog& other) {
+    if (other.is_exact()) {
+        for (uint64_t h : other.exact_) {
+            add_hash(h);
+        }
+        return;
+    }
+    
+    if (is_exact()) {
+        to_registers();
+    }
+    for (size_t i = 0; i < kRegisters; ++i) {
+        registers_[i] = std::max(registers_[i], other.registers_[i]);
+    }
+}
+
+size_t HyperLogLog::estimate() const {
+    if (is_exact()) {
+        return exact_.size();
+    }
+    
+    const double m = static_cast<double>(kRegisters);
+    double sum = 0.0;
+    size_t zeros = 0;
+    for (uint8_t reg : registers_) {
+        sum += std::ldexp(1.0, -static_cast<int>(reg));
+        if (reg == 0) {
+            ++zeros;
+        }
+    }
+    
+    const double alpha = 0.7213 / (1.0 + 1.079 / m);
+    double estimate = alpha * m * m / sum;
+    
+    // Linear counting is more accurate while many registers are still empty
+    if (estimate <= 2.5 * m && zeros > 0) {
+        estimate = m * std::log(m / static_cast<double>(zeros));
+    }
+    return static_cast<size_t>(std::llround(estimate));
+}
+
+void HyperLogLog::to_registers() {
+    registers_.assign(kRegisters, 0);
+    for (uint64_t h : exact_) {
+        update_register(h);
+    }
+    exact_.clear();
+    exact_.rehash(0);
+}
+
+void HyperLogLog::update_register(uint64_t h) {
+    size_t index = static_cast<size_t>(h >> (64 - kPrecision));
+    uint64_t rest = h << kPrecision;
+    
+    // Rank = position of the first set bit in the remaining bits
+    uint8_t rank = 1;
+    const uint8_t max_rank = 64 - kPrecision + 1;
+    while (rank < max_rank && (rest & (uint64_t(1) << 63)) == 0) {
+        rest <<= 1;
+        ++rank;
+    }
+    registers_[index] = std::max(registers_[index], rank);
+}
+
+} // namespace logstory::analysis
@@ -0,0 +1,191 @@
+#include "logstory/analysis/posting_list.hpp"
+#include <algorithm>
+
+namespace logstory::analysis {
+
+namespace {
+
+void write_varint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+uint64_t read_varint(const std::vector<uint8_t>& in, size_t& offset) {
+    uint64_t value = 0;
+    int shift = 0;
+    while (true) {
+        uint8_t byte = in[offset++];
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+        shift += 7;
+    }
+}
+
+} // namespace
+
+// ============================================================================
+// PostingList::Cursor
+// ============================================================================
+
+PostingList::Cursor::Cursor(const PostingList& list) : list_(&list) {
+    if (!list.empty()) {
+        value_ = read_varint(list.bytes_, offset_);
+        valid_ = true;
+    }
+}
+
+void PostingList::Cursor::next() {
+    if (!valid_) {
+        return;
+    }
+    if (ordinal_ + 1 >= list_->size_) {
+        valid_ = false;
+        return;
+    }
+    decode_next();
+}
+
+void PostingList::Cursor::decode_next() {
+    value_ += read_varint(list_->bytes_, offset_);
+    ordinal_++;
+}
+
+void PostingList::Cursor::seek(core::EventId target) {
+    if (!valid_ || value_ >= target) {
+        return;
+    }
+    
+    // Jump to the last skip point at or before the target
+    const auto& skips = list_->skips_;
+    auto it = std::upper_bound(skips.begin(), skips.end(), target,
+        [](core::EventId t, const SkipPoint& s) { return t < s.id; });
+    if (it != skips.begin()) {
+        const SkipPoint& skip = *(it - 1);
+        if (skip.ordinal > ordinal_) {
+            value_ = skip.id;
+            offset_ = skip.offset;
+            ordinal_ = skip.ordinal;
+        }
+    }
+    
+    while (valid_ && value_ < target) {
+        next();
+    }
+}
+
+// ============================================================================
+// PostingList
+// ============================================================================
+
+PostingList PostingList::from_ids(std::vector<core::EventId> ids) {
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    
+    PostingList list;
+    list.bytes_.reserve(ids.size());
+    for (core::EventId id : ids) {
+        list.append(id);
+    }
+    return list;
+}
+
+bool PostingList::append(core::EventId id) {
+    if (size_ > 0 && id <= last_) {
+        return false;
+    }
+    
+    write_varint(bytes_, size_ == 0 ? id : id - last_);
+    if (size_ % kSkipInterval == 0) {
+        skips_.push_back(SkipPoint{id, bytes_.size(), size_});
+    }
+    last_ = id;
+    size_++;
+    return true;
+}
+
+bool PostingList::contains(core::EventId id) const {
+    if (empty() || id > last_) {
+        return false;
+    }
+    Cursor c(*this);
+    c.seek(id);
+    return c.valid() && c.value() == id;
+}
+
+std::vector<core::EventId> PostingList::decode() const {
+    std::vector<core::EventId> ids;
+    ids.reserve(size_);
+    for (Cursor c(*this); c.valid(); c.next()) {
+        ids.push_back(c.value());
+    }
+    return ids;
+}
+
+PostingList PostingList::intersect(const PostingList& a, const PostingList& b) {
+    // Drive from the shorter list and seek in the longer one
+    const PostingList& small = a.size() <= b.size() ? a : b;
+    const PostingList& large = a.size() <= b.size() ? b : a;
+    
+    PostingList result;
+    Cursor probe(large);
+    for (Cursor c(small); c.valid() && probe.valid(); c.next()) {
+        probe.seek(c.value());
+        if (probe.valid() && probe.value() == c.value()) {
+            result.append(c.value());
+        }
+    }
+    return result;
+}
+
+PostingList PostingList::unite(const PostingList& a, const PostingList& b) {
+    PostingList result;
+    result.bytes_.reserve(a.byte_size() + b.byte_size());
+    
+    Cursor ca(a);
+    Cursor cb(b);
+    while (ca.valid() || cb.valid()) {
+        if (!cb.valid() || (ca.valid() && ca.value() < cb.value())) {
+            result.append(ca.value());
+            ca.next();
+        } else if (!ca.valid() || cb.value() < ca.value()) {
+            result.append(cb.value());
+            cb.next();
+        } else {
+            result.append(ca.value());
+            ca.next();
+            cb.next();
+        }
+    }
+    return result;
+}
+
+PostingList PostingList::intersect_all(const std::vector<const PostingList*>& lists) {
+    if (lists.empty()) {
+        return {};
+    }
+    
+    std::vector<const PostingList*> ordered(lists);
+    std::sort(ordered.begin(), ordered.end(),
+              [](const PostingList* x, const PostingList* y) { return x->size() < y->size(); });
+    
+    PostingList result = *ordered[0];
+    for (size_t i = 1; i < ordered.size() && !result.empty(); ++i) {
+        result = intersect(result, *ordered[i]);
+    }
+    return result;
+}
+
+PostingList PostingList::unite_all(const std::vector<const PostingList*>& lists) {
+    PostingList result;
+    for (const PostingList* list : lists) {
+        result = unite(result, *list);
+    }
+    return result;
+}
+
+} // namespace logstory::analysis
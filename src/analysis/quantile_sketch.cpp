@@ -0,0 +1,179 @@
+#include "logstory/analysis/quantile_sketch.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace logstory::analysis {
+
+namespace {
+
+// Magnitudes below this count as zero (keeps bin keys in int range)
+constexpr double kMinIndexable = 1e-9;
+
+} // namespace
+
+QuantileSketch::QuantileSketch(double relative_accuracy, size_t max_bins)
+    : relative_accuracy_(std::clamp(relative_accuracy, 1e-4, 0.5)),
+      max_bins_(std::max<size_t>(16, max_bins)) {
+    gamma_ = (1.0 + relative_accuracy_) / (1.0 - relative_accuracy_);
+    log_gamma_ = std::log(gamma_);
+}
+
+void QuantileSketch::add(double value, uint64_t count) {
+    if (count == 0 || !std::isfinite(value)) {
+        return;
+    }
+    
+    if (value > kMinIndexable) {
+        positive_.add(key(value), count, max_bins_);
+    } else if (value < -kMinIndexable) {
+        negative_.add(key(-value), count, max_bins_);
+    } else {
+        zero_count_ += count;
+    }
+    
+    if (count_ == 0) {
+        min_ = value;
+        max_ = value;
+    } else {
+        min_ = std::min(min_, value);
+        max_ = std::max(max_, value);
+    }
+    count_ += count;
+    sum_ += value * static_cast<double>(count);
+}
+
+void QuantileSketch::merge(const QuantileSketch& other) {
+    if (other.empty()) {
+        return;
+    }
+    
+    if (other.gamma_ == gamma_) {
+        // Same bin boundaries: add counts bin by bin
+        auto merge_store = [this](Store& own, const Store& theirs) {
+            if (theirs.bins.empty()) {
+                return;
+            }
+            own.extend(theirs.offset, theirs.offset + static_cast<int>(theirs.bins.size()) - 1,
+                       max_bins_);
+            for (size_t i = 0; i < theirs.bins.size(); ++i) {
+                if (theirs.bins[i] != 0) {
+                    own.add(theirs.offset + static_cast<int>(i), theirs.bins[i], max_bins_);
+                }
+            }
+        };
+        merge_store(positive_, other.positive_);
+        merge_store(negative_, other.negative_);
+        zero_count_ += other.zero_count_;
+        
+        if (count_ == 0) {
+            min_ = other.min_;
+            max_ = other.max_;
+        } else {
+            min_ = std::min(min_, other.min_);
+            max_ = std::max(max_, other.max_);
+        }
+        count_ += other.count_;
+        sum_ += other.sum_;
+        return;
+    }
+    
+    // Different accuracy: re-add each bin's representative value
+    double sum_before = sum_;
+    for (size_t i = 0; i < other.positive_.bins.size(); ++i) {
+        add(other.value(other.positive_.offset + static_cast<int>(i)), other.positive_.bins[i]);
+    }
+    for (size_t i = 0; i < other.negative_.bins.size(); ++i) {
+        add(-other.value(other.negative_.offset + static_cast<int>(i)), other.negative_.bins[i]);
+    }
+    add(0.0, other.zero_count_);
+    sum_ = sum_before + other.sum_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+}
+
+double QuantileSketch::quantile(double q) const {
+    if (count_ == 0) {
+        return 0.0;
+    }
+    
+    // The extremes are tracked exactly
+    if (q <= 0.0) {
+        return min_;
+    }
+    if (q >= 1.0) {
+        return max_;
+    }
+    auto rank = static_cast<uint64_t>(q * static_cast<double>(count_ - 1));
+    
+    // Walk from the most negative value upwards
+    double result = max_;
+    uint64_t seen = 0;
+    bool found = false;
+    for (size_t i = negative_.bins.size(); i-- > 0 && !found;) {
+        seen += negative_.bins[i];
+        if (seen > rank) {
+            result = -value(negative_.offset + static_cast<int>(i));
+            found = true;
+        }
+    }
+    if (!found) {
+        seen += zero_count_;
+        if (seen > rank) {
+            result = 0.0;
+            found = true;
+        }
+    }
+    for (size_t i = 0; i < positive_.bins.size() && !found; ++i) {
+        seen += positive_.bins[i];
+        if (seen > rank) {
+            result = value(positive_.offset + static_cast<int>(i));
+            found = true;
+        }
+    }
+    
+    return std::clamp(result, min_, max_);
+}
+
+int QuantileSketch::key(double magnitude) const {
+    return static_cast<int>(std::ceil(std::log(magnitude) / log_gamma_));
+}
+
+double QuantileSketch::value(int key) const {
+    // Midpoint (in relative terms) of (gamma^(key-1), gamma^key]
+    return 2.0 * std::exp(key * log_gamma_) / (1.0 + gamma_);
+}
+
+void QuantileSketch::Store::add(int key, uint64_t count, size_t max_bins) {
+    extend(key, key, max_bins);
+    bins[static_cast<size_t>(std::max(key, offset) - offset)] += count;
+}
+
+void QuantileSketch::Store::extend(int lo, int hi, size_t max_bins) {
+    const int limit = static_cast<int>(max_bins);
+    if (bins.empty()) {
+        offset = std::max(lo, hi - limit + 1);
+        bins.assign(static_cast<size_t>(hi - offset + 1), 0);
+        return;
+    }
+    
+    int cur_lo = offset;
+    int cur_hi = offset + static_cast<int>(bins.size()) - 1;
+    int new_lo = std::min(lo, cur_lo);
+    int new_hi = std::max(hi, cur_hi);
+    if (new_hi - new_lo + 1 > limit) {
+        new_lo = new_hi - limit + 1;  // Fold the lowest keys together
+    }
+    if (new_lo == cur_lo && new_hi == cur_hi) {
+        return;
+    }
+    
+    std::vector<uint64_t> resized(static_cast<size_t>(new_hi - new_lo + 1), 0);
+    for (size_t i = 0; i < bins.size(); ++i) {
+        int k = std::max(cur_lo + static_cast<int>(i), new_lo);
+        resized[static_cast<size_t>(k - new_lo)] += bins[i];
+    }
+    bins = std::move(resized);
+    offset = new_lo;
+}
+
+} // namespace logstory::analysis
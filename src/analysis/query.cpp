@@ -0,0 +1,722 @@
+#include "logstory/analysis/query.hpp"
+#include "logstory/analysis/window.hpp"
+#include "logstory/core/text_search.hpp"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+
+namespace logstory::analysis {
+
+namespace {
+
+using core::ErrorCode;
+using core::Status;
+using Field = QueryPredicate::Field;
+using Op = QueryPredicate::Op;
+using Node = Query::Node;
+
+std::string to_lower_copy(const std::string& s) {
+    std::string out = s;
+    std::transform(out.begin(), out.end(), out.begin(),
+        [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return out;
+}
+
+bool is_token_char(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) != 0;
+}
+
+/// Whether `message` contains `lower_token` as a whole alphanumeric token
+bool has_token(const std::string& message, const std::string& lower_token) {
+    std::string tok;
+    for (size_t i = 0; i <= message.size(); ++i) {
+        if (i < message.size() && is_token_char(message[i])) {
+            tok.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(message[i]))));
+        } else if (!tok.empty()) {
+            if (tok == lower_token) {
+                return true;
+            }
+            tok.clear();
+        }
+    }
+    return false;
+}
+
+template <typename T>
+bool compare(const T& lhs, Op op, const T& rhs) {
+    switch (op) {
+        case Op::EQ: return lhs == rhs;
+        case Op::NE: return !(lhs == rhs);
+        case Op::LT: return lhs < rhs;
+        case Op::LE: return !(rhs < lhs);
+        case Op::GT: return rhs < lhs;
+        case Op::GE: return !(lhs < rhs);
+        default: return false;
+    }
+}
+
+bool is_correlation_key(const std::string& key) {
+    return key == "request_id" || key == "trace_id" || key == "uuid";
+}
+
+const char* op_name(Op op) {
+    switch (op) {
+        case Op::EQ: return "=";
+        case Op::NE: return "!=";
+        case Op::LT: return "<";
+        case Op::LE: return "<=";
+        case Op::GT: return ">";
+        case Op::GE: return ">=";
+        case Op::CONTAINS: return "~";
+        default: return "?";
+    }
+}
+
+/// Recursive-descent parser for filter expressions
+class QueryParser {
+public:
+    explicit QueryParser(const std::string& text) : text_(text) {}
+    
+    Status parse(Node& out) {
+        auto status = parse_or(out);
+        if (!status.ok()) {
+            return status;
+        }
+        skip_space();
+        if (pos_ < text_.size()) {
+            return error("Unexpected '" + text_.substr(pos_) + "'");
+        }
+        return Status::OK();
+    }
+
+private:
+    const std::string& text_;
+    size_t pos_ = 0;
+    
+    Status error(const std::string& msg) const {
+        return Status(ErrorCode::INVALID_INPUT,
+                      "Invalid query at position " + std::to_string(pos_) + ": " + msg);
+    }
+    
+    void skip_space() {
+        while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_]))) {
+            pos_++;
+        }
+    }
+    
+    /// Consume a keyword (case-insensitive) followed by a non-word character
+    bool accept_keyword(const std::string& kw) {
+        skip_space();
+        if (text_.size() - pos_ < kw.size()) {
+            return false;
+        }
+        if (to_lower_copy(text_.substr(pos_, kw.size())) != kw) {
+            return false;
+        }
+        size_t end = pos_ + kw.size();
+        if (end < text_.size() && (is_token_char(text_[end]) || text_[end] == '_' || text_[end] == '.')) {
+            return false;
+        }
+        pos_ = end;
+        return true;
+    }
+    
+    bool accept(char c) {
+        skip_space();
+        if (pos_ < text_.size() && text_[pos_] == c) {
+            pos_++;
+            return true;
+        }
+        return false;
+    }
+    
+    Status parse_or(Node& out) {
+        Node first;
+        auto status = parse_and(first);
+        if (!status.ok()) {
+            return status;
+        }
+        if (!accept_keyword("or")) {
+            out = std::move(first);
+            return Status::OK();
+        }
+        
+        out = Node();
+        out.kind = Node::Kind::OR;
+        out.children.push_back(std::move(first));
+        do {
+            Node next;
+            status = parse_and(next);
+            if (!status.ok()) {
+                return status;
+            }
+            out.children.push_back(std::move(next));
+        } while (accept_keyword("or"));
+        return Status::OK();
+    }
+    
+    Status parse_and(Node& out) {
+        Node first;
+        auto status = parse_unary(first);
+        if (!status.ok()) {
+            return status;
+        }
+        if (!accept_keyword("and")) {
+            out = std::move(first);
+            return Status::OK();
+        }
+        
+        out = Node();
+        out.kind = Node::Kind::AND;
+        out.children.push_back(std::move(first));
+        do {
+            Node next;
+            status = parse_unary(next);
+            if (!status.ok()) {
+                return status;
+            }
+            out.children.push_back(std::move(next));
+        } while (accept_keyword("and"));
+        return Status::OK();
+    }
+    
+    Status parse_unary(Node& out) {
+        if (accept_keyword("not")) {
+            Node child;
+            auto status = parse_unary(child);
+            if (!status.ok()) {
+                return status;
+            }
+            out = Node();
+            out.kind = Node::Kind::NOT;
+            out.children.push_back(std::move(child));
+            return Status::OK();
+        }
+        
+        if (accept('(')) {
+            auto status = parse_or(out);
+            if (!status.ok()) {
+                return status;
+            }
+            if (!accept(')')) {
+                return error("Expected ')'");
+            }
+            return Status::OK();
+        }
+        
+        out = Node();
+        out.kind = Node::Kind::PREDICATE;
+        return parse_predicate(out.predicate);
+    }
+    
+    Status parse_predicate(QueryPredicate& pred) {
+        skip_space();
+        
+        // Field name
+        size_t start = pos_;
+        while (pos_ < text_.size() &&
+               (is_token_char(text_[pos_]) || text_[pos_] == '_' || text_[pos_] == '.' || text_[pos_] == '-')) {
+            pos_++;
+        }
+        std::string field = text_.substr(start, pos_ - start);
+        if (field.empty()) {
+            return error("Expected a field name");
+        }
+        
+        std::string lower_field = to_lower_copy(field);
+        if (lower_field == "sev" || lower_field == "severity" || lower_field == "level") {
+            pred.field = Field::SEVERITY;
+        } else if (lower_field == "text" || lower_field == "msg" || lower_field == "message") {
+            pred.field = Field::TEXT;
+        } else if (lower_field == "src" || lower_field == "source") {
+            pred.field = Field::SOURCE;
+        } else if (lower_field == "ts" || lower_field == "time") {
+            pred.field = Field::TIME;
+        } else if (lower_field == "id") {
+            pred.field = Field::ID;
+        } else if (lower_field.rfind("tag.", 0) == 0 && field.size() > 4) {
+            pred.field = Field::TAG;
+            pred.tag_key = field.substr(4);
+        } else {
+            return error("Unknown field '" + field + "'");
+        }
+        
+        // Operator
+        skip_space();
+        auto op_at = [this](const char* op) {
+            size_t len = std::char_traits<char>::length(op);
+            if (text_.compare(pos_, len, op) == 0) {
+                pos_ += len;
+                return true;
+            }
+            return false;
+        };
+        if (op_at(">=")) pred.op = Op::GE;
+        else if (op_at("<=")) pred.op = Op::LE;
+        else if (op_at("!=")) pred.op = Op::NE;
+        else if (op_at("==")) pred.op = Op::EQ;
+        else if (op_at("=")) pred.op = Op::EQ;
+        else if (op_at(">")) pred.op = Op::GT;
+        else if (op_at("<")) pred.op = Op::LT;
+        else if (op_at("~")) pred.op = Op::CONTAINS;
+        else return error("Expected an operator after '" + field + "'");
+        
+        // Value
+        auto status = parse_value(pred.value);
+        if (!status.ok()) {
+            return status;
+        }
+        return resolve_value(pred);
+    }
+    
+    Status parse_value(std::string& value) {
+        skip_space();
+        if (pos_ < text_.size() && text_[pos_] == '"') {
+            pos_++;
+            while (pos_ < text_.size() && text_[pos_] != '"') {
+                if (text_[pos_] == '\\' && pos_ + 1 < text_.size()) {
+                    pos_++;
+                }
+                value.push_back(text_[pos_++]);
+            }
+            if (pos_ >= text_.size()) {
+                return error("Unterminated string");
+            }
+            pos_++;
+            return Status::OK();
+        }
+        
+        size_t start = pos_;
+        while (pos_ < text_.size() && !std::isspace(static_cast<unsigned char>(text_[pos_])) &&
+               text_[pos_] != '(' && text_[pos_] != ')') {
+            pos_++;
+        }
+        value = text_.substr(start, pos_ - start);
+        if (value.empty()) {
+            return error("Expected a value");
+        }
+        return Status::OK();
+    }
+    
+    /// Check the operator is valid for the field and pre-parse the value
+    Status resolve_value(QueryPredicate& pred) {
+        bool ordered = pred.op == Op::LT || pred.op == Op::LE || pred.op == Op::GT || pred.op == Op::GE;
+        pred.lower_value = to_lower_copy(pred.value);
+        
+        switch (pred.field) {
+            case Field::SEVERITY:
+                if (pred.op == Op::CONTAINS) {
+                    return error("'~' is not supported for severity");
+                }
+                pred.sev_value = core::severity_from_string(pred.value);
+                if (pred.sev_value == core::Severity::UNKNOWN && pred.lower_value != "unknown") {
+                    return error("Unknown severity '" + pred.value + "'");
+                }
+                break;
+            case Field::TIME: {
+                if (pred.op == Op::CONTAINS) {
+                    return error("'~' is not supported for time");
+                }
+                auto tp = parse_time(pred.value);
+                if (!tp.has_value()) {
+                    return error("Invalid time '" + pred.value + "'");
+                }
+                pred.time_value = *tp;
+                break;
+            }
+            case Field::ID: {
+                if (pred.op == Op::CONTAINS) {
+                    return error("'~' is not supported for id");
+                }
+                const char* first = pred.value.data();
+                const char* last = first + pred.value.size();
+                auto [end, ec] = std::from_chars(first, last, pred.id_value);
+                if (pred.value.empty() || ec == std::errc::invalid_argument || end != last) {
+                    return error("Invalid id '" + pred.value + "' (expected a non-negative integer)");
+                }
+                if (ec == std::errc::result_out_of_range) {
+                    return error("Id '" + pred.value + "' is out of range");
+                }
+                break;
+            }
+            case Field::TEXT:
+            case Field::SOURCE:
+            case Field::TAG:
+                if (ordered) {
+                    return error(std::string("'") + op_name(pred.op) + "' is only supported for sev, ts and id");
+                }
+                break;
+        }
+        return Status::OK();
+    }
+};
+
+} // namespace
+
+// ============================================================================
+// QueryPredicate / Query
+// ============================================================================
+
+bool QueryPredicate::matches(const core::Event& event) const {
+    switch (field) {
+        case Field::SEVERITY:
+            return compare(static_cast<int>(event.sev), op, static_cast<int>(sev_value));
+        case Field::TIME:
+            if (!event.ts.has_value() || !event.ts->is_valid()) {
+                return false;
+            }
+            return compare(event.ts->tp, op, time_value);
+        case Field::ID:
+            return compare(event.id, op, id_value);
+        case Field::TEXT:
+            if (op == Op::CONTAINS) {
+                return core::contains_ignore_case(event.message, lower_value);
+            }
+            return has_token(event.message, lower_value) == (op == Op::EQ);
+        case Field::SOURCE:
+            if (op == Op::CONTAINS) {
+                return core::contains_ignore_case(event.src.source_path, lower_value);
+            }
+            return compare(event.src.source_path, op, value);
+        case Field::TAG: {
+            auto it = event.tags.find(tag_key);
+            if (it == event.tags.end()) {
+                return op == Op::NE;
+            }
+            if (op == Op::CONTAINS) {
+                return core::contains_ignore_case(it->second, lower_value);
+            }
+            return compare(it->second, op, value);
+        }
+    }
+    return false;
+}
+
+namespace {
+
+bool node_matches(const Node& node, const core::Event& event) {
+    switch (node.kind) {
+        case Node::Kind::AND:
+            return std::all_of(node.children.begin(), node.children.end(),
+                               [&event](const Node& c) { return node_matches(c, event); });
+        case Node::Kind::OR:
+            return std::any_of(node.children.begin(), node.children.end(),
+                               [&event](const Node& c) { return node_matches(c, event); });
+        case Node::Kind::NOT:
+            return !node_matches(node.children.front(), event);
+        case Node::Kind::PREDICATE:
+            return node.predicate.matches(event);
+    }
+    return false;
+}
+
+} // namespace
+
+bool Query::matches(const core::Event& event) const {
+    return node_matches(root, event);
+}
+
+core::Status parse_query(const std::string& expr, Query& out) {
+    Query query;
+    query.text = expr;
+    QueryParser parser(query.text);
+    auto status = parser.parse(query.root);
+    if (!status.ok()) {
+        return status;
+    }
+    out = std::move(query);
+    return core::Status::OK();
+}
+
+// ============================================================================
+// QueryEngine
+// ============================================================================
+
+/// Fixed-size bitset over store positions
+class QueryEngine::Bitmap {
+public:
+    explicit Bitmap(size_t size, bool fill = false)
+        : size_(size), words_((size + 63) / 64, fill ? ~uint64_t(0) : 0) {
+        if (fill) {
+            trim();
+        }
+    }
+    
+    void set(size_t pos) { words_[pos / 64] |= uint64_t(1) << (pos % 64); }
+    bool test(size_t pos) const { return (words_[pos / 64] >> (pos % 64)) & 1; }
+    
+    Bitmap& operator&=(const Bitmap& other) {
+        for (size_t i = 0; i < words_.size(); ++i) words_[i] &= other.words_[i];
+        return *this;
+    }
+    
+    Bitmap& operator|=(const Bitmap& other) {
+        for (size_t i = 0; i < words_.size(); ++i) words_[i] |= other.words_[i];
+        return *this;
+    }
+    
+    /// Clear every bit that is set in `other`
+    Bitmap& subtract(const Bitmap& other) {
+        for (size_t i = 0; i < words_.size(); ++i) words_[i] &= ~other.words_[i];
+        return *this;
+    }
+    
+    bool none() const {
+        return std::all_of(words_.begin(), words_.end(), [](uint64_t w) { return w == 0; });
+    }
+    
+    /// Call fn(pos) for each set bit in ascending order
+    template <typename Fn>
+    void for_each(Fn&& fn) const {
+        for (size_t i = 0; i < words_.size(); ++i) {
+            uint64_t w = words_[i];
+            while (w != 0) {
+                unsigned bit = 0;
+                while (((w >> bit) & 1) == 0) bit++;
+                fn(i * 64 + bit);
+                w &= w - 1;
+            }
+        }
+    }
+
+private:
+    size_t size_;
+    std::vector<uint64_t> words_;
+    
+    void trim() {
+        if (size_ % 64 != 0 && !words_.empty()) {
+            words_.back() &= (uint64_t(1) << (size_ % 64)) - 1;
+        }
+    }
+};
+
+QueryEngine::QueryEngine(const EventView& events,
+                         const EventIndex* index,
+                         const TextIndex* text_index,
+                         const EventLookup* lookup)
+    : events_(events), index_(index), text_index_(text_index), shared_lookup_(lookup) {
+    if (!shared_lookup_) {
+        own_lookup_.build(events);
+    }
+}
+
+std::vector<size_t> QueryEngine::select(const Query& query) const {
+    std::vector<size_t> positions;
+    Bitmap all(events_.size(), true);
+    evaluate(query.root, all).for_each([&positions](size_t pos) { positions.push_back(pos); });
+    return positions;
+}
+
+EventView QueryEngine::view(const Query& query) const {
+    return events_.subset(select(query));
+}
+
+std::vector<core::Event> QueryEngine::filter(const Query& query) const {
+    return view(query).materialize();
+}
+
+bool QueryEngine::is_indexed(const QueryPredicate& pred) const {
+    switch (pred.field) {
+        case Field::SEVERITY:
+            return index_ != nullptr;
+        case Field::TIME:
+            return index_ != nullptr && pred.op != Op::NE;
+        case Field::TAG:
+            return index_ != nullptr && pred.op == Op::EQ && is_correlation_key(pred.tag_key);
+        case Field::TEXT:
+            return text_index_ != nullptr && pred.op != Op::NE;
+        case Field::ID:
+            return pred.op == Op::EQ;
+        case Field::SOURCE:
+            return false;
+    }
+    return false;
+}
+
+bool QueryEngine::is_indexed(const Query::Node& node) const {
+    if (node.kind == Node::Kind::PREDICATE) {
+        return is_indexed(node.predicate);
+    }
+    return std::all_of(node.children.begin(), node.children.end(),
+                       [this](const Node& c) { return is_indexed(c); });
+}
+
+QueryEngine::Bitmap QueryEngine::evaluate(const Query::Node& node, const Bitmap& within) const {
+    switch (node.kind) {
+        case Node::Kind::PREDICATE:
+            return evaluate_predicate(node.predicate, within);
+        
+        case Node::Kind::NOT: {
+            Bitmap result = within;
+            result.subtract(evaluate(node.children.front(), within));
+            return result;
+        }
+        
+        case Node::Kind::AND: {
+            // Index-backed children first so scans only visit surviving events
+            std::vector<const Node*> ordered;
+            for (const auto& c : node.children) ordered.push_back(&c);
+            std::stable_partition(ordered.begin(), ordered.end(),
+                                  [this](const Node* c) { return is_indexed(*c); });
+            
+            Bitmap acc = within;
+            for (const Node* child : ordered) {
+                if (acc.none()) {
+                    break;
+                }
+                acc &= evaluate(*child, acc);
+            }
+            return acc;
+        }
+        
+        case Node::Kind::OR: {
+            std::vector<const Node*> ordered;
+            for (const auto& c : node.children) ordered.push_back(&c);
+            std::stable_partition(ordered.begin(), ordered.end(),
+                                  [this](const Node* c) { return is_indexed(*c); });
+            
+            // Later children only need to decide events not matched yet
+            Bitmap acc(events_.size());
+            for (const Node* child : ordered) {
+                Bitmap remaining = within;
+                remaining.subtract(acc);
+                if (remaining.none()) {
+                    break;
+                }
+                acc |= evaluate(*child, remaining);
+            }
+            return acc;
+        }
+    }
+    return Bitmap(events_.size());
+}
+
+QueryEngine::Bitmap QueryEngine::evaluate_predicate(const QueryPredicate& pred,
+                                                    const Bitmap& within) const {
+    Bitmap result(events_.size());
+    
+    auto set_ids = [this](const PostingList& ids, Bitmap& target) {
+        for (auto c = ids.cursor(); c.valid(); c.next()) {
+            size_t pos = lookup().index_of(c.value());
+            if (pos != EventLookup::npos) {
+                target.set(pos);
+            }
+        }
+    };
+    
+    if (!is_indexed(pred)) {
+        within.for_each([&](size_t pos) {
+            if (pred.matches(events_[pos])) {
+                result.set(pos);
+            }
+        });
+        return result;
+    }
+    
+    switch (pred.field) {
+        case Field::SEVERITY: {
+            for (int s = 0; s <= static_cast<int>(core::Severity::FATAL); ++s) {
+                if (compare(s, pred.op, static_cast<int>(pred.sev_value))) {
+                    set_ids(index_->severity_postings(static_cast<core::Severity>(s)), result);
+                }
+            }
+            break;
+        }
+        
+        case Field::TIME: {
+            using TimePoint = std::chrono::system_clock::time_point;
+            TimePoint start = TimePoint::min();
+            TimePoint end = TimePoint::max();
+            const auto tick = TimePoint::duration(1);
+            switch (pred.op) {
+                case Op::LT: end = pred.time_value - tick; break;
+                case Op::LE: end = pred.time_value; break;
+                case Op::GT: start = pred.time_value + tick; break;
+                case Op::GE: start = pred.time_value; break;
+                default: start = end = pred.time_value; break;
+            }
+            for (size_t pos : index_->get_indices_by_time_range(start, end)) {
+                result.set(pos);
+            }
+            break;
+        }
+        
+        case Field::TAG: {
+            // The correlation index pools request/trace/uuid values, so
+            // confirm the key on the (few) candidates
+            Bitmap candidates(events_.size());
+            set_ids(index_->correlation_postings(pred.value), candidates);
+            candidates &= within;
+            candidates.for_each([&](size_t pos) {
+                if (pred.matches(events_[pos])) {
+                    result.set(pos);
+                }
+            });
+            return result;
+        }
+        
+        case Field::TEXT:
+            set_ids(pred.op == Op::CONTAINS ? text_index_->containing(pred.value)
+                                            : text_index_->token(pred.value), result);
+            break;
+        
+        case Field::ID: {
+            size_t pos = lookup().index_of(pred.id_value);
+            if (pos != EventLookup::npos) {
+                result.set(pos);
+            }
+            break;
+        }
+        
+        case Field::SOURCE:
+            break;
+    }
+    
+    result &= within;
+    return result;
+}
+
+std::string QueryEngine::explain(const Query& query) const {
+    std::string out;
+    explain_node(query.root, 0, out);
+    return out;
+}
+
+void QueryEngine::explain_node(const Query::Node& node, int depth, std::string& out) const {
+    std::string indent(static_cast<size_t>(depth) * 2, ' ');
+    switch (node.kind) {
+        case Node::Kind::AND:
+        case Node::Kind::OR: {
+            out += indent + (node.kind == Node::Kind::AND ? "AND\n" : "OR\n");
+            std::vector<const Node*> ordered;
+            for (const auto& c : node.children) ordered.push_back(&c);
+            std::stable_partition(ordered.begin(), ordered.end(),
+                                  [this](const Node* c) { return is_indexed(*c); });
+            for (const Node* child : ordered) {
+                explain_node(*child, depth + 1, out);
+            }
+            break;
+        }
+        case Node::Kind::NOT:
+            out += indent + "NOT\n";
+            explain_node(node.children.front(), depth + 1, out);
+            break;
+        case Node::Kind::PREDICATE: {
+            const auto& p = node.predicate;
+            std::string field;
+            switch (p.field) {
+                case Field::SEVERITY: field = "sev"; break;
+                case Field::TEXT: field = "text"; break;
+                case Field::SOURCE: field = "source"; break;
+                case Field::TAG: field = "tag." + p.tag_key; break;
+                case Field::TIME: field = "ts"; break;
+                case Field::ID: field = "id"; break;
+            }
+            out += indent + field + op_name(p.op) + p.value +
+                   (is_indexed(p) ? " [index]\n" : " [scan]\n");
+            break;
+        }
+    }
+}
+
+} // namespace logstory::analysis
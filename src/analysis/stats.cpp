@@ -1,23 +1,108 @@
 #include "logstory/analysis/stats.hpp"
 #include <algorithm>
+#include <cmath>
 
 namespace logstory::analysis {
 
 void TimeSeries::add_event(std::chrono::system_clock::time_point tp) {
+    add_count(tp, 1);
+}
+
+void TimeSeries::add_count(std::chrono::system_clock::time_point tp, size_t count) {
+    int64_t bucket = bucket_index(tp);
+    
+    if (sparse_ || !ensure_slot(bucket)) {
+        add_sparse(bucket, count);
+        return;
+    }
+    
+    uint32_t& slot = slots_[static_cast<size_t>(bucket - origin_)];
+    if (slot != 0) {
+        points[slot - 1].count += count;
+        return;
+    }
+    
+    // New bucket: append for in-order input, otherwise insert in time order
+    auto ts = bucket_start(bucket);
+    if (points.empty() || points.back().timestamp < ts) {
+        points.push_back(TimeSeriesPoint(ts, count));
+        slot = static_cast<uint32_t>(points.size());
+        return;
+    }
+    
+    auto it = std::lower_bound(points.begin(), points.end(), ts,
+        [](const TimeSeriesPoint& p, std::chrono::system_clock::time_point t) {
+            return p.timestamp < t;
+        });
+    insert_point(bucket, static_cast<size_t>(it - points.begin()), count);
+}
+
+int64_t TimeSeries::bucket_index(std::chrono::system_clock::time_point tp) const {
     // Round down to bucket boundary
     auto epoch = tp.time_since_epoch();
-    auto bucket_duration = std::chrono::duration_cast<std::chrono::minutes>(bucket_size);
-    auto bucket_count = epoch / bucket_duration;
-    auto bucket_start = std::chrono::system_clock::time_point(bucket_count * bucket_duration);
+    auto bucket_duration = std::chrono::duration_cast<std::chrono::system_clock::duration>(bucket_size);
+    return static_cast<int64_t>(epoch / bucket_duration);
+}
+
+std::chrono::system_clock::time_point TimeSeries::bucket_start(int64_t bucket) const {
+    auto bucket_duration = std::chrono::duration_cast<std::chrono::system_clock::duration>(bucket_size);
+    return std::chrono::system_clock::time_point(bucket * bucket_duration);
+}
+
+bool TimeSeries::ensure_slot(int64_t bucket) {
+    if (slots_.empty()) {
+        origin_ = bucket;
+        slots_.assign(1, 0);
+        return true;
+    }
+    
+    int64_t last = origin_ + static_cast<int64_t>(slots_.size()) - 1;
+    int64_t lo = std::min(origin_, bucket);
+    int64_t hi = std::max(last, bucket);
+    if (hi - lo + 1 > kMaxDenseBuckets) {
+        // Too wide for a dense array: drop it and use binary search from now on
+        sparse_ = true;
+        slots_.clear();
+        slots_.shrink_to_fit();
+        return false;
+    }
+    
+    if (bucket > last) {
+        slots_.resize(static_cast<size_t>(bucket - origin_ + 1), 0);
+    } else if (bucket < origin_) {
+        // Grow at the front with headroom so repeated prepends stay amortized O(1)
+        int64_t needed = origin_ - bucket;
+        int64_t headroom = std::min<int64_t>(static_cast<int64_t>(slots_.size()),
+                                             kMaxDenseBuckets - (hi - lo + 1));
+        int64_t grow = needed + std::max<int64_t>(0, headroom);
+        slots_.insert(slots_.begin(), static_cast<size_t>(grow), 0);
+        origin_ -= grow;
+    }
+    return true;
+}
+
+void TimeSeries::insert_point(int64_t bucket, size_t pos, size_t count) {
+    points.insert(points.begin() + static_cast<std::ptrdiff_t>(pos),
+                  TimeSeriesPoint(bucket_start(bucket), count));
     
-    // Find or create bucket
-    auto it = std::find_if(points.begin(), points.end(), 
-        [&](const TimeSeriesPoint& p) { return p.timestamp == bucket_start; });
+    // Re-point slots of the inserted bucket and every later bucket
+    for (size_t i = pos; i < points.size(); ++i) {
+        int64_t b = bucket_index(points[i].timestamp);
+        slots_[static_cast<size_t>(b - origin_)] = static_cast<uint32_t>(i + 1);
+    }
+}
+
+void TimeSeries::add_sparse(int64_t bucket, size_t count) {
+    auto ts = bucket_start(bucket);
+    auto it = std::lower_bound(points.begin(), points.end(), ts,
+        [](const TimeSeriesPoint& p, std::chrono::system_clock::time_point t) {
+            return p.timestamp < t;
+        });
     
-    if (it != points.end()) {
-        it->count++;
+    if (it != points.end() && it->timestamp == ts) {
+        it->count += count;
     } else {
-        points.push_back(TimeSeriesPoint(bucket_start, 1));
+        points.insert(it, TimeSeriesPoint(ts, count));
     }
 }
 
@@ -29,6 +114,15 @@ size_t TimeSeries::total_count() const {
     return total;
 }
 
+void TimeSeries::merge(const TimeSeries& other) {
+    if (points.empty()) {
+        bucket_size = other.bucket_size;
+    }
+    for (const auto& point : other.points) {
+        add_count(point.timestamp, point.count);
+    }
+}
+
 std::optional<TimeSeriesPoint> TimeSeries::max_point() const {
     if (points.empty()) {
         return std::nullopt;
@@ -42,6 +136,324 @@ std::optional<TimeSeriesPoint> TimeSeries::max_point() const {
     return *max_it;
 }
 
+TimeSeriesPyramid TimeSeriesPyramid::build(const TimeSeries& finest,
+                                           const std::vector<std::chrono::minutes>& resolutions) {
+    TimeSeriesPyramid pyramid;
+    pyramid.levels.push_back(finest);
+    
+    std::vector<std::chrono::minutes> sizes(resolutions);
+    std::sort(sizes.begin(), sizes.end());
+    for (auto size : sizes) {
+        auto prev = pyramid.levels.back().bucket_size;
+        if (size > prev && size.count() % finest.bucket_size.count() == 0) {
+            pyramid.levels.emplace_back(size);
+        }
+    }
+    
+    // Single pass over the finest points feeds every coarser level
+    for (const auto& point : finest.points) {
+        for (size_t l = 1; l < pyramid.levels.size(); ++l) {
+            pyramid.levels[l].add_count(point.timestamp, point.count);
+        }
+    }
+    
+    pyramid.prefix.resize(pyramid.levels.size());
+    for (size_t l = 0; l < pyramid.levels.size(); ++l) {
+        auto& sums = pyramid.prefix[l];
+        sums.reserve(pyramid.levels[l].points.size() + 1);
+        sums.push_back(0);
+        for (const auto& point : pyramid.levels[l].points) {
+            sums.push_back(sums.back() + point.count);
+        }
+    }
+    
+    return pyramid;
+}
+
+const TimeSeries* TimeSeriesPyramid::level(std::chrono::minutes bucket_size) const {
+    for (const auto& series : levels) {
+        if (series.bucket_size == bucket_size) {
+            return &series;
+        }
+    }
+    return nullptr;
+}
+
+const TimeSeries& TimeSeriesPyramid::level_for_span(std::chrono::minutes span,
+                                                    size_t max_points) const {
+    for (const auto& series : levels) {
+        auto buckets = static_cast<size_t>(span.count() / series.bucket_size.count()) + 1;
+        if (buckets <= max_points) {
+            return series;
+        }
+    }
+    return levels.back();
+}
+
+size_t TimeSeriesPyramid::range_count(std::chrono::system_clock::time_point start,
+                                      std::chrono::system_clock::time_point end,
+                                      size_t level_index) const {
+    if (level_index >= levels.size() || !(start < end)) {
+        return 0;
+    }
+    
+    const auto& pts = levels[level_index].points;
+    auto by_time = [](const TimeSeriesPoint& p, std::chrono::system_clock::time_point t) {
+        return p.timestamp < t;
+    };
+    size_t lo = static_cast<size_t>(
+        std::lower_bound(pts.begin(), pts.end(), start, by_time) - pts.begin());
+    size_t hi = static_cast<size_t>(
+        std::lower_bound(pts.begin(), pts.end(), end, by_time) - pts.begin());
+    
+    return prefix[level_index][hi] - prefix[level_index][lo];
+}
+
+void Stats::merge(const Stats& other) {
+    for (const auto& [sev, count] : other.severity_counts) {
+        severity_counts[sev] += count;
+    }
+    for (const auto& [source, count] : other.source_counts) {
+        source_counts[source] += count;
+    }
+    for (const auto& [sev, series] : other.severity_time_series) {
+        severity_time_series[sev].merge(series);
+    }
+    pattern_sketch.merge(other.pattern_sketch);
+    for (const auto& [key, sketch] : other.tag_cardinality) {
+        tag_cardinality[key].merge(sketch);
+    }
+    for (const auto& [sev, sketches] : other.severity_tag_cardinality) {
+        auto& own = severity_tag_cardinality[sev];
+        for (const auto& [key, sketch] : sketches) {
+            own[key].merge(sketch);
+        }
+    }
+    for (const auto& [key, numeric] : other.numeric_tags) {
+        auto it = numeric_tags.find(key);
+        if (it == numeric_tags.end()) {
+            numeric_tags.emplace(key, numeric);
+        } else {
+            it->second.merge(numeric);
+        }
+    }
+    
+    partitions.merge(other.partitions);
+    
+    total_events += other.total_events;
+    if (other.start_time.has_value() && (!start_time.has_value() || *other.start_time < *start_time)) {
+        start_time = other.start_time;
+    }
+    if (other.end_time.has_value() && (!end_time.has_value() || *other.end_time > *end_time)) {
+        end_time = other.end_time;
+    }
+    
+    severity_pyramids.clear();
+    frequent_patterns.clear();
+}
+
+NumericTagStats::NumericTagStats(double relative_accuracy, size_t max_bins)
+    : overall(relative_accuracy, max_bins), relative_accuracy_(relative_accuracy), max_bins_(max_bins) {}
+
+void NumericTagStats::add(double value, std::optional<std::chrono::system_clock::time_point> bucket) {
+    overall.add(value);
+    if (bucket.has_value()) {
+        buckets.try_emplace(*bucket, relative_accuracy_, max_bins_).first->second.add(value);
+    }
+}
+
+void NumericTagStats::merge(const NumericTagStats& other) {
+    overall.merge(other.overall);
+    for (const auto& [bucket, sketch] : other.buckets) {
+        buckets.try_emplace(bucket, relative_accuracy_, max_bins_).first->second.merge(sketch);
+    }
+}
+
+std::vector<QuantileChange> NumericTagStats::changes(double q, double factor,
+                                                     size_t min_samples) const {
+    std::vector<QuantileChange> result;
+    std::optional<double> previous;
+    for (const auto& [bucket, sketch] : buckets) {
+        if (sketch.count() < min_samples) {
+            continue;
+        }
+        double current = sketch.quantile(q);
+        if (previous.has_value()) {
+            double lo = std::min(std::abs(*previous), std::abs(current));
+            double hi = std::max(std::abs(*previous), std::abs(current));
+            if (hi > 0.0 && (lo == 0.0 || hi / lo >= factor)) {
+                result.push_back(QuantileChange{bucket, *previous, current});
+            }
+        }
+        previous = current;
+    }
+    return result;
+}
+
+void PartitionStats::add(const core::Event& event, std::chrono::minutes bucket_size) {
+    ++total_events;
+    severity_counts[event.sev]++;
+    if (!event.ts.has_value()) {
+        return;
+    }
+    
+    auto tp = event.ts->tp;
+    if (!start_time.has_value() || tp < *start_time) {
+        start_time = tp;
+    }
+    if (!end_time.has_value() || tp > *end_time) {
+        end_time = tp;
+    }
+    severity_time_series.try_emplace(event.sev, bucket_size).first->second.add_event(tp);
+}
+
+void PartitionStats::merge(const PartitionStats& other) {
+    total_events += other.total_events;
+    for (const auto& [sev, count] : other.severity_counts) {
+        severity_counts[sev] += count;
+    }
+    for (const auto& [sev, series] : other.severity_time_series) {
+        severity_time_series[sev].merge(series);
+    }
+    if (other.start_time.has_value() && (!start_time.has_value() || *other.start_time < *start_time)) {
+        start_time = other.start_time;
+    }
+    if (other.end_time.has_value() && (!end_time.has_value() || *other.end_time > *end_time)) {
+        end_time = other.end_time;
+    }
+}
+
+size_t PartitionStats::count(core::Severity sev) const {
+    auto it = severity_counts.find(sev);
+    return it != severity_counts.end() ? it->second : 0;
+}
+
+double PartitionStats::error_rate() const {
+    if (total_events == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(count(core::Severity::ERROR)) / static_cast<double>(total_events);
+}
+
+const std::string* PartitionedStats::key_of(const core::Event& event) const {
+    if (dimension == kSourceDimension) {
+        return event.src.source_path.empty() ? nullptr : &event.src.source_path;
+    }
+    auto it = event.tags.find(dimension);
+    if (it == event.tags.end() || it->second.empty()) {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+std::string PartitionedStats::label(const std::string& key) const {
+    if (dimension == kSourceDimension || key == kOtherPartition) {
+        return key;
+    }
+    return dimension + "=" + key;
+}
+
+void PartitionedStats::add(const core::Event& event, std::chrono::minutes bucket_size) {
+    const std::string* key = key_of(event);
+    if (key == nullptr) {
+        ++unkeyed_events;
+        return;
+    }
+    auto it = partitions.find(*key);
+    if (it == partitions.end()) {
+        it = partitions.try_emplace(admit(*key)).first;
+    }
+    it->second.add(event, bucket_size);
+}
+
+void PartitionedStats::merge(const PartitionedStats& other) {
+    if (dimension.empty()) {
+        dimension = other.dimension;
+    }
+    if (!admitted.has_value()) {
+        admitted = other.admitted;
+    }
+    unkeyed_events += other.unkeyed_events;
+    for (const auto& [key, partition] : other.partitions) {
+        auto it = partitions.find(key);
+        if (it != partitions.end()) {
+            it->second.merge(partition);
+            continue;
+        }
+        auto [slot, inserted] = partitions.try_emplace(admit(key), partition);
+        if (!inserted) {
+            slot->second.merge(partition);
+        }
+    }
+}
+
+const std::string& PartitionedStats::admit(const std::string& key) const {
+    static const std::string kOther = kOtherPartition;
+    bool other = admitted.has_value() && admitted->count(key) == 0;
+    return other ? kOther : key;
+}
+
+void PartitionedStats::fold_smallest(size_t max_partitions) {
+    if (partitions.size() <= max_partitions) {
+        return;
+    }
+    
+    // Largest first; key order breaks ties so the result is deterministic
+    std::vector<std::pair<size_t, std::string>> by_size;
+    by_size.reserve(partitions.size());
+    for (const auto& [key, partition] : partitions) {
+        if (key != kOtherPartition) {
+            by_size.emplace_back(partition.total_events, key);
+        }
+    }
+    size_t keep = max_partitions > 0 ? max_partitions - 1 : 0;  // One slot for "(other)"
+    std::stable_sort(by_size.begin(), by_size.end(), [](const auto& a, const auto& b) {
+        return a.first > b.first;
+    });
+    
+    PartitionStats other;
+    for (size_t i = keep; i < by_size.size(); ++i) {
+        auto node = partitions.extract(by_size[i].second);
+        other.merge(node.mapped());
+    }
+    auto [it, inserted] = partitions.try_emplace(kOtherPartition, std::move(other));
+    if (!inserted) {
+        it->second.merge(other);
+    }
+}
+
+std::vector<std::string> PartitionedStats::top_by_error_rate(size_t k, size_t min_events) const {
+    std::vector<const std::pair<const std::string, PartitionStats>*> ranked;
+    for (const auto& entry : partitions) {
+        if (entry.second.total_events >= min_events && entry.first != kOtherPartition) {
+            ranked.push_back(&entry);
+        }
+    }
+    
+    k = std::min(k, ranked.size());
+    std::partial_sort(ranked.begin(), ranked.begin() + static_cast<std::ptrdiff_t>(k), ranked.end(),
+        [](const auto* a, const auto* b) {
+            double rate_a = a->second.error_rate();
+            double rate_b = b->second.error_rate();
+            if (rate_a != rate_b) {
+                return rate_a > rate_b;
+            }
+            size_t errors_a = a->second.count(core::Severity::ERROR);
+            size_t errors_b = b->second.count(core::Severity::ERROR);
+            if (errors_a != errors_b) {
+                return errors_a > errors_b;
+            }
+            return a->first < b->first;
+        });
+    
+    std::vector<std::string> keys;
+    keys.reserve(k);
+    for (size_t i = 0; i < k; ++i) {
+        keys.push_back(ranked[i]->first);
+    }
+    return keys;
+}
+
 size_t Stats::error_count() const {
     auto it = severity_counts.find(core::Severity::ERROR);
     return (it != severity_counts.end()) ? it->second : 0;
@@ -59,4 +471,48 @@ double Stats::error_rate() const {
     return static_cast<double>(error_count()) / static_cast<double>(total_events);
 }
 
+size_t Stats::distinct_tag_values(const std::string& key) const {
+    auto it = tag_cardinality.find(key);
+    return it != tag_cardinality.end() ? it->second.estimate() : 0;
+}
+
+size_t Stats::distinct_tag_values(const std::string& key, core::Severity sev) const {
+    auto sev_it = severity_tag_cardinality.find(sev);
+    if (sev_it == severity_tag_cardinality.end()) {
+        return 0;
+    }
+    auto it = sev_it->second.find(key);
+    return it != sev_it->second.end() ? it->second.estimate() : 0;
+}
+
+const TimeSeries* Stats::series_at(core::Severity sev, std::chrono::minutes bucket_size) const {
+    auto pyr_it = severity_pyramids.find(sev);
+    if (pyr_it != severity_pyramids.end()) {
+        if (const TimeSeries* series = pyr_it->second.level(bucket_size)) {
+            return series;
+        }
+    }
+    
+    auto it = severity_time_series.find(sev);
+    if (it != severity_time_series.end() && it->second.bucket_size == bucket_size) {
+        return &it->second;
+    }
+    return nullptr;
+}
+
+const TimeSeries* Stats::series_for_span(core::Severity sev, size_t max_points) const {
+    auto it = severity_time_series.find(sev);
+    if (it == severity_time_series.end()) {
+        return nullptr;
+    }
+    
+    auto pyr_it = severity_pyramids.find(sev);
+    if (pyr_it == severity_pyramids.end() || pyr_it->second.empty() ||
+        !start_time.has_value() || !end_time.has_value()) {
+        return &it->second;
+    }
+    auto span = std::chrono::duration_cast<std::chrono::minutes>(*end_time - *start_time);
+    return &pyr_it->second.level_for_span(span, max_points);
+}
+
 } // namespace logstory::analysis
@@ -1,33 +1,183 @@
 #include "logstory/analysis/stats_builder.hpp"
 #include <algorithm>
+#include <cctype>
+#include <functional>
 #include <map>
 #include <regex>
+#include <string_view>
+#include <unordered_map>
 
 namespace logstory::analysis {
 
 StatsBuilder::StatsBuilder(const StatsConfig& config) : config_(config) {}
 
-Stats StatsBuilder::build(const std::vector<core::Event>& events) {
+Stats StatsBuilder::build(const EventView& events) {
     Stats stats;
+    init_partial(stats);
+    admit_largest_partitions(events, stats);
+    accumulate(events, 0, events.size(), stats);
+    finalize(stats);
+    return stats;
+}
+
+Stats StatsBuilder::build_parallel(const EventView& events, core::ThreadPool& pool) {
+    size_t chunk = std::max<size_t>(1, config_.parallel_chunk_events);
+    size_t chunk_count = (events.size() + chunk - 1) / chunk;
+    if (chunk_count <= 1 || pool.size() <= 1) {
+        return build(events);
+    }
+    
+    // One accumulator per worker, each folding in a fixed stride of chunks, so
+    // peak memory follows the worker count rather than the input size and the
+    // result doesn't depend on scheduling
+    size_t worker_count = std::min(chunk_count, pool.size());
     
-    if (events.empty()) {
-        return stats;
+    // Admission is decided once from exact counts over the whole input, so
+    // every worker routes the same keys to "(other)" and build() agrees per key
+    Stats prototype;
+    init_partial(prototype);
+    admit_largest_partitions(events, prototype);
+    std::vector<Stats> partials(worker_count, prototype);
+    
+    // Partition shards per worker: shards[worker][hash(key) % shard_count]
+    using PartitionMap = std::map<std::string, PartitionStats>;
+    size_t shard_count = config_.partition_by.empty() ? 0 : worker_count;
+    std::vector<std::vector<PartitionMap>> shards(worker_count, std::vector<PartitionMap>(shard_count));
+    
+    for (size_t w = 0; w < worker_count; ++w) {
+        pool.submit([this, &events, &partials, &shards, chunk, chunk_count, worker_count, shard_count, w]() {
+            Stats& partial = partials[w];
+            for (size_t i = w; i < chunk_count; i += worker_count) {
+                size_t begin = i * chunk;
+                accumulate(events, begin, std::min(events.size(), begin + chunk), partial);
+            }
+            
+            auto& partitions = partial.partitions.partitions;
+            std::hash<std::string> hasher;
+            while (!partitions.empty()) {
+                auto node = partitions.extract(partitions.begin());
+                shards[w][hasher(node.key()) % shard_count].insert(std::move(node));
+            }
+        });
     }
+    pool.wait();
     
-    stats.total_events = events.size();
+    // Each shard owns a disjoint key set, so shards merge independently
+    std::vector<PartitionMap> merged(shard_count);
+    for (size_t s = 0; s < shard_count; ++s) {
+        pool.submit([&shards, &merged, worker_count, s]() {
+            PartitionMap& out = merged[s];
+            for (size_t w = 0; w < worker_count; ++w) {
+                for (auto& [key, partition] : shards[w][s]) {
+                    auto [it, inserted] = out.try_emplace(key, std::move(partition));
+                    if (!inserted) {
+                        it->second.merge(partition);
+                    }
+                }
+                shards[w][s].clear();
+            }
+        });
+    }
+    pool.wait();
     
-    // Process each event
+    // Merge in worker order, releasing each accumulator once folded in
+    Stats stats = std::move(partials[0]);
+    for (size_t w = 1; w < worker_count; ++w) {
+        stats.merge(partials[w]);
+        partials[w] = Stats();
+    }
+    for (auto& shard : merged) {
+        stats.partitions.partitions.merge(shard);
+    }
+    finalize(stats);
+    return stats;
+}
+
+Stats StatsBuilder::build_partial(const EventView& events,
+                                  size_t begin, size_t end) const {
+    Stats stats;
+    init_partial(stats);
+    accumulate(events, begin, end, stats);
+    return stats;
+}
+
+void StatsBuilder::init_partial(Stats& stats) const {
+    stats.pattern_sketch = HeavyHitters(config_.pattern_sketch_capacity);
+    stats.partitions.dimension = config_.partition_by;
+}
+
+void StatsBuilder::admit_largest_partitions(const EventView& events, Stats& stats) const {
+    PartitionedStats& partitioned = stats.partitions;
+    if (partitioned.dimension.empty()) {
+        return;
+    }
+    
+    // Exact event count per key; views point into the events
+    std::unordered_map<std::string_view, size_t> counts;
     for (const auto& event : events) {
-        process_event(event, stats);
+        if (const std::string* key = partitioned.key_of(event)) {
+            ++counts[*key];
+        }
+    }
+    if (counts.size() <= config_.max_partitions) {
+        return;
     }
     
-    // Compute frequent patterns
-    compute_frequent_patterns(events, stats);
+    // Largest first, key order breaking ties, leaving one slot for "(other)"
+    std::vector<std::pair<size_t, std::string_view>> by_size;
+    by_size.reserve(counts.size());
+    for (const auto& [key, count] : counts) {
+        by_size.emplace_back(count, key);
+    }
+    size_t keep = config_.max_partitions > 0 ? config_.max_partitions - 1 : 0;
+    std::partial_sort(by_size.begin(), by_size.begin() + static_cast<std::ptrdiff_t>(keep), by_size.end(),
+        [](const auto& a, const auto& b) {
+            return a.first != b.first ? a.first > b.first : a.second < b.second;
+        });
     
-    return stats;
+    partitioned.admitted.emplace();
+    for (size_t i = 0; i < keep; ++i) {
+        partitioned.admitted->emplace(by_size[i].second);
+    }
+}
+
+void StatsBuilder::accumulate(const EventView& events, size_t begin, size_t end,
+                              Stats& stats) const {
+    end = std::min(end, events.size());
+    if (begin >= end) {
+        return;
+    }
+    
+    stats.total_events += end - begin;
+    
+    // Process each event
+    for (size_t i = begin; i < end; ++i) {
+        process_event(events[i], stats);
+        count_pattern(events[i], stats);
+        add_numeric_tags(events[i], stats);
+    }
+}
+
+void StatsBuilder::finalize(Stats& stats) const {
+    // Roll up each severity series into the configured coarser resolutions
+    stats.severity_pyramids.clear();
+    if (!config_.rollup_resolutions.empty()) {
+        for (const auto& [sev, series] : stats.severity_time_series) {
+            stats.severity_pyramids[sev] = TimeSeriesPyramid::build(series, config_.rollup_resolutions);
+        }
+    }
+    
+    // Top N patterns from the sketch, with their error bounds
+    stats.frequent_patterns.clear();
+    for (const auto& counter : stats.pattern_sketch.top(config_.top_n_patterns)) {
+        stats.frequent_patterns.emplace_back(counter.key, counter.count,
+                                             counter.max_severity, counter.error);
+    }
+    
+    stats.partitions.fold_smallest(config_.max_partitions);
 }
 
-void StatsBuilder::process_event(const core::Event& event, Stats& stats) {
+void StatsBuilder::process_event(const core::Event& event, Stats& stats) const {
     // Update severity counts
     stats.severity_counts[event.sev]++;
     
@@ -36,6 +186,19 @@ void StatsBuilder::process_event(const core::Event& event, Stats& stats) {
         stats.source_counts[event.src.source_path]++;
     }
     
+    if (!stats.partitions.dimension.empty()) {
+        stats.partitions.add(event, config_.time_bucket_size);
+    }
+    
+    // Distinct tag values
+    if (!event.tags.empty()) {
+        auto& by_sev = stats.severity_tag_cardinality[event.sev];
+        for (const auto& [key, value] : event.tags) {
+            stats.tag_cardinality[key].add(value);
+            by_sev[key].add(value);
+        }
+    }
+    
     // Update time boundaries
     if (event.ts.has_value()) {
         auto tp = event.ts->tp;
@@ -56,58 +219,80 @@ void StatsBuilder::process_event(const core::Event& event, Stats& stats) {
     }
 }
 
-void StatsBuilder::compute_frequent_patterns(const std::vector<core::Event>& events, Stats& stats) {
-    // Count patterns
-    std::map<std::string, std::pair<size_t, core::Severity>> pattern_counts;
-    
-    for (const auto& event : events) {
-        if (event.message.length() >= config_.min_pattern_length) {
-            std::string pattern = extract_pattern(event.message);
-            if (!pattern.empty()) {
-                auto& entry = pattern_counts[pattern];
-                entry.first++;
-                // Track max severity
-                if (static_cast<int>(event.sev) > static_cast<int>(entry.second)) {
-                    entry.second = event.sev;
-                }
-            }
-        }
+void StatsBuilder::count_pattern(const core::Event& event, Stats& stats) const {
+    if (event.message.length() < config_.min_pattern_length) {
+        return;
     }
     
-    // Convert to vector and sort by count
-    std::vector<FrequentPattern> patterns;
-    for (const auto& [pattern, data] : pattern_counts) {
-        patterns.emplace_back(pattern, data.first, data.second);
+    std::string pattern = extract_pattern(event.message);
+    if (pattern.empty()) {
+        return;
     }
     
-    std::sort(patterns.begin(), patterns.end(),
-        [](const FrequentPattern& a, const FrequentPattern& b) {
-            return a.count > b.count;
-        });
+    stats.pattern_sketch.add(pattern, event.sev);
+}
+
+void StatsBuilder::add_numeric_tags(const core::Event& event, Stats& stats) const {
+    std::optional<std::chrono::system_clock::time_point> bucket;
+    if (event.ts.has_value()) {
+        auto since_epoch = event.ts->tp.time_since_epoch();
+        auto width = std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            config_.time_bucket_size);
+        auto offset = since_epoch % width;
+        if (offset.count() < 0) {
+            offset += width;
+        }
+        bucket = event.ts->tp - offset;
+    }
     
-    // Keep top N
-    size_t n = std::min(config_.top_n_patterns, patterns.size());
-    stats.frequent_patterns.assign(patterns.begin(), patterns.begin() + n);
+    for (const auto& [key, value] : event.tags) {
+        if (!is_numeric_tag_key(key)) {
+            continue;
+        }
+        auto number = core::parse_numeric_tag(value);
+        if (!number.has_value()) {
+            continue;
+        }
+        stats.numeric_tags
+            .try_emplace(key, config_.quantile_relative_accuracy, config_.quantile_max_bins)
+            .first->second.add(*number, bucket);
+    }
+}
+
+bool StatsBuilder::is_numeric_tag_key(const std::string& key) const {
+    if (!config_.numeric_tag_keys.empty()) {
+        return std::find(config_.numeric_tag_keys.begin(), config_.numeric_tag_keys.end(), key) !=
+               config_.numeric_tag_keys.end();
+    }
+    if (key.size() < 2) {
+        return true;
+    }
+    char a = static_cast<char>(std::tolower(static_cast<unsigned char>(key[key.size() - 2])));
+    char b = static_cast<char>(std::tolower(static_cast<unsigned char>(key[key.size() - 1])));
+    return !(a == 'i' && b == 'd');
 }
 
 std::string StatsBuilder::extract_pattern(const std::string& message) const {
     // Simple pattern extraction: replace numbers and IDs with placeholders
     std::string pattern = message;
     
+    // Patterns are compiled once and shared read-only across build_parallel
+    // workers
+    
     // Replace UUIDs
-    std::regex uuid_regex("[0-9a-fA-F]{8}-[0-9a-fA-F]{4}-[0-9a-fA-F]{4}-[0-9a-fA-F]{4}-[0-9a-fA-F]{12}");
+    static const std::regex uuid_regex("[0-9a-fA-F]{8}-[0-9a-fA-F]{4}-[0-9a-fA-F]{4}-[0-9a-fA-F]{4}-[0-9a-fA-F]{12}");
     pattern = std::regex_replace(pattern, uuid_regex, "<UUID>");
     
     // Replace hex numbers
-    std::regex hex_regex("0x[0-9a-fA-F]+");
+    static const std::regex hex_regex("0x[0-9a-fA-F]+");
     pattern = std::regex_replace(pattern, hex_regex, "<HEX>");
     
     // Replace numbers (including decimals and negatives)
-    std::regex num_regex("-?\\d+\\.?\\d*");
+    static const std::regex num_regex("-?\\d+\\.?\\d*");
     pattern = std::regex_replace(pattern, num_regex, "<NUM>");
     
     // Replace quoted strings
-    std::regex quoted_regex("\"[^\"]+\"");
+    static const std::regex quoted_regex("\"[^\"]+\"");
     pattern = std::regex_replace(pattern, quoted_regex, "<STR>");
     
     return pattern;
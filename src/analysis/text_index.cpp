@@ -0,0 +1,165 @@
+#include "logstory/analysis/text_index.hpp"
+#include "logstory/core/text_search.hpp"
+#include <algorithm>
+#include <cctype>
+#include <numeric>
+
+namespace logstory::analysis {
+
+namespace {
+
+char lower(char c) {
+    return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+}
+
+bool is_token_char(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) != 0;
+}
+
+uint32_t pack_trigram(char a, char b, char c) {
+    return (static_cast<uint32_t>(static_cast<unsigned char>(a)) << 16) |
+           (static_cast<uint32_t>(static_cast<unsigned char>(b)) << 8) |
+           static_cast<uint32_t>(static_cast<unsigned char>(c));
+}
+
+std::string to_lower(std::string_view s) {
+    std::string out(s);
+    std::transform(out.begin(), out.end(), out.begin(), lower);
+    return out;
+}
+
+} // namespace
+
+void TextIndex::build(const EventView& events, const EventLookup* lookup) {
+    events_ = events;
+    shared_lookup_ = lookup;
+    if (shared_lookup_) {
+        own_lookup_ = EventLookup();
+    } else {
+        own_lookup_.build(events);
+    }
+    tokens_.clear();
+    trigrams_.clear();
+    
+    // Posting lists need ascending IDs; visit a sorted permutation if the
+    // store isn't already in ID order
+    std::vector<size_t> order(events.size());
+    std::iota(order.begin(), order.end(), 0);
+    bool ascending = std::is_sorted(events.begin(), events.end(),
+        [](const core::Event& a, const core::Event& b) { return a.id < b.id; });
+    if (!ascending) {
+        std::stable_sort(order.begin(), order.end(),
+            [&events](size_t a, size_t b) { return events[a].id < events[b].id; });
+    }
+    
+    for (size_t pos : order) {
+        add_message(events[pos].id, events[pos].message);
+    }
+}
+
+void TextIndex::add_message(core::EventId id, const std::string& message) {
+    // Tokens: maximal alphanumeric runs. Repeats within a message are
+    // rejected by PostingList::append since the ID doesn't increase.
+    std::string tok;
+    for (size_t i = 0; i <= message.size(); ++i) {
+        if (i < message.size() && is_token_char(message[i])) {
+            tok.push_back(lower(message[i]));
+        } else if (!tok.empty()) {
+            tokens_[tok].append(id);
+            tok.clear();
+        }
+    }
+    
+    if (!config_.index_ngrams || message.size() < 3) {
+        return;
+    }
+    
+    char a = lower(message[0]);
+    char b = lower(message[1]);
+    for (size_t i = 2; i < message.size(); ++i) {
+        char c = lower(message[i]);
+        trigrams_[pack_trigram(a, b, c)].append(id);
+        a = b;
+        b = c;
+    }
+}
+
+const PostingList& TextIndex::token(const std::string& tok) const {
+    static const PostingList empty;
+    auto it = tokens_.find(to_lower(tok));
+    return it != tokens_.end() ? it->second : empty;
+}
+
+PostingList TextIndex::containing(std::string_view needle) const {
+    PostingList result;
+    if (events_.empty()) {
+        return result;
+    }
+    
+    std::string lower_needle = to_lower(needle);
+    
+    // Short needles (or no n-grams): verify every message
+    if (!config_.index_ngrams || lower_needle.size() < 3) {
+        std::vector<core::EventId> ids;
+        for (const auto& event : events_) {
+            if (core::contains_ignore_case(event.message, lower_needle)) {
+                ids.push_back(event.id);
+            }
+        }
+        return PostingList::from_ids(std::move(ids));
+    }
+    
+    // Candidates contain every trigram of the needle
+    std::vector<const PostingList*> lists;
+    for (size_t i = 2; i < lower_needle.size(); ++i) {
+        auto it = trigrams_.find(pack_trigram(lower_needle[i - 2], lower_needle[i - 1], lower_needle[i]));
+        if (it == trigrams_.end()) {
+            return result;
+        }
+        lists.push_back(&it->second);
+    }
+    
+    PostingList candidates = PostingList::intersect_all(lists);
+    
+    // A single trigram is an exact match; longer needles need verification
+    if (lower_needle.size() == 3) {
+        return candidates;
+    }
+    for (auto c = candidates.cursor(); c.valid(); c.next()) {
+        const core::Event* event = lookup().find(c.value());
+        if (event != nullptr && core::contains_ignore_case(event->message, lower_needle)) {
+            result.append(c.value());
+        }
+    }
+    return result;
+}
+
+PostingList TextIndex::containing_any(const std::vector<std::string>& needles) const {
+    std::vector<PostingList> matches;
+    matches.reserve(needles.size());
+    for (const auto& needle : needles) {
+        matches.push_back(containing(needle));
+    }
+    
+    std::vector<const PostingList*> lists;
+    for (const auto& m : matches) {
+        lists.push_back(&m);
+    }
+    return PostingList::unite_all(lists);
+}
+
+std::vector<size_t> TextIndex::positions_containing_any(const std::vector<std::string>& needles) const {
+    std::vector<size_t> positions;
+    PostingList ids = containing_any(needles);
+    positions.reserve(ids.size());
+    for (auto c = ids.cursor(); c.valid(); c.next()) {
+        size_t pos = lookup().index_of(c.value());
+        if (pos != EventLookup::npos) {
+            positions.push_back(pos);
+        }
+    }
+    std::sort(positions.begin(), positions.end());
+    return positions;
+}
+
+} // namespace logstory::analysis
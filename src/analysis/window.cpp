@@ -94,22 +94,12 @@ std::optional<std::chrono::system_clock::time_point> parse_time(const std::strin
     return parse_relative_time(str);
 }
 
-std::vector<core::Event> filter_by_window(const std::vector<core::Event>& events,
-                                           const TimeWindow& window) {
+EventView filter_by_window(const EventView& events, const TimeWindow& window) {
     if (!window.is_constrained()) {
         return events;  // No filtering needed
     }
     
-    std::vector<core::Event> filtered;
-    filtered.reserve(events.size());
-    
-    for (const auto& event : events) {
-        if (window.contains(event)) {
-            filtered.push_back(event);
-        }
-    }
-    
-    return filtered;
+    return events.where([&window](const core::Event& event) { return window.contains(event); });
 }
 
 } // namespace logstory::analysis
@@ -8,18 +8,25 @@
 #include "logstory/parsing/event_parser.hpp"
 #include "logstory/analysis/window.hpp"
 #include "logstory/analysis/event_index.hpp"
+#include "logstory/analysis/event_lookup.hpp"
+#include "logstory/analysis/event_features.hpp"
+#include "logstory/analysis/query.hpp"
 #include "logstory/analysis/episode_builder.hpp"
 #include "logstory/analysis/stats_builder.hpp"
 #include "logstory/analysis/anomaly_detector.hpp"
 #include "logstory/analysis/correlation_extractor.hpp"
+#include "logstory/analysis/clock_skew.hpp"
 #include "logstory/rules/rule_registry.hpp"
 #include "logstory/rules/builtin/crash_loop_rule.hpp"
 #include "logstory/rules/builtin/retry_to_timeout_rule.hpp"
 #include "logstory/rules/builtin/error_burst_after_change_rule.hpp"
+#include "logstory/rules/builtin/source_silence_rule.hpp"
+#include "logstory/rules/builtin/level_shift_rule.hpp"
 #include "logstory/narrative/narrator.hpp"
 #include "logstory/narrative/markdown_writer.hpp"
 #include "logstory/narrative/json_writer.hpp"
 #include "logstory/narrative/timeline_writer.hpp"
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
 
@@ -27,6 +34,14 @@ namespace fs = std::filesystem;
 
 namespace logstory::cli {
 
+namespace {
+
+// Buckets a burst scan covers before moving to a coarser rollup: a week of
+// minutes, so a 30-day input is scanned in 5-minute buckets
+constexpr size_t kMaxBurstBuckets = 7 * 24 * 60;
+
+} // namespace
+
 App::App(const Args& args) : args_(args) {
     // Set global logger verbosity
     core::g_logger.set_verbosity(args.verbosity);
@@ -38,8 +53,9 @@ core::Status App::run() {
     g_logger.info("Log Narrator - Starting analysis");
     
     // Step 1: Ingest
-    std::vector<core::Event> events;
-    auto status = ingest(events);
+    std::vector<core::Event> store;
+    analysis::EventView events;
+    auto status = ingest(store, events);
     if (!status.ok()) {
         return status;
     }
@@ -73,11 +89,31 @@ core::Status App::run() {
     return core::Status::OK();
 }
 
-core::Status App::ingest(std::vector<core::Event>& out_events) {
+core::Status App::ingest(std::vector<core::Event>& out_store, analysis::EventView& out_events) {
     using core::g_logger;
     
     g_logger.verbose("Starting ingestion phase");
     
+    // Resolve filters up front so they can be pushed into reading and parsing
+    parsing::EventFilter filter;
+    if (auto status = build_event_filter(filter); !status.ok()) {
+        return status;
+    }
+    
+    // Skew correction moves timestamps after parsing, so read a time window
+    // widened by the largest per-pair delta the estimator trusts, and apply
+    // the exact window once timestamps are corrected
+    analysis::ClockSkewConfig skew_config;
+    parsing::EventFilter read_filter = filter;
+    if (args_.correct_clock_skew) {
+        if (read_filter.start.has_value()) {
+            *read_filter.start -= skew_config.max_delta;
+        }
+        if (read_filter.end.has_value()) {
+            *read_filter.end += skew_config.max_delta;
+        }
+    }
+    
     std::vector<io::RawLine> all_lines;
     
     // Read input
@@ -93,20 +129,36 @@ core::Status App::ingest(std::vector<core::Event>& out_events) {
         for (const auto& path : args_.input_paths) {
             if (fs::is_directory(path)) {
                 g_logger.verbose("Scanning directory: ", path);
-                auto status = read_directory(path, out_events);
+                auto status = read_directory(path, out_store);
                 if (!status.ok()) {
                     g_logger.warning("Failed to read directory ", path, ": ", status.message);
                     continue;
                 }
             } else {
+                io::SeekConfig seek_config;
+                seek_config.use_time_index = args_.time_index;
+                seek_config.time_index_dir = args_.time_index_dir;
+                io::FileReader reader(seek_config);
+                if (file_outside_window(reader, path, read_filter)) {
+                    g_logger.verbose("Skipping file outside time window: ", path);
+                    continue;
+                }
+                
                 g_logger.verbose("Reading file: ", path);
-                io::FileReader reader;
                 std::vector<io::RawLine> lines;
-                auto status = reader.read(path, lines);
+                io::SeekResult seek;
+                auto status = reader.read_window(path, read_filter.start, read_filter.end, lines, &seek);
                 if (!status.ok()) {
                     g_logger.warning("Failed to read file ", path, ": ", status.message);
                     continue;
                 }
+                if (seek.bisected || seek.indexed) {
+                    g_logger.debug("  Seeked to bytes [", seek.start_offset, ", ",
+                                   seek.end_offset, ") from line ", seek.start_line,
+                                   seek.indexed ? " (time index)" : "");
+                } else if (read_filter.start.has_value() || read_filter.end.has_value()) {
+                    g_logger.debug("  Read whole file: ", seek.fallback_reason);
+                }
                 all_lines.insert(all_lines.end(), lines.begin(), lines.end());
             }
         }
@@ -121,50 +173,84 @@ core::Status App::ingest(std::vector<core::Event>& out_events) {
     
     g_logger.verbose("Framed into ", records.size(), " records");
     
-    // Parse events
+    // Parse events; records rejected by the filter stop after timestamp and
+    // severity detection and are never stored
     parsing::EventParser parser;
-    out_events = parser.parse_all(records);
+    parser.set_filter(read_filter);
+    out_store = parser.parse_all(records);
     
-    g_logger.verbose("Parsed ", out_events.size(), " events");
+    g_logger.verbose("Parsed ", out_store.size(), " events");
+    if (filter.is_active()) {
+        g_logger.info("After filtering: ", out_store.size(), " events (",
+                      parser.filtered_count(), " records skipped)");
+    }
     
-    // Apply time filtering if specified
-    if (args_.since.has_value() || args_.until.has_value()) {
-        analysis::TimeWindow window;
-        
-        if (args_.since.has_value()) {
-            auto start = analysis::parse_time(*args_.since);
-            if (!start.has_value()) {
-                return core::Status(core::ErrorCode::INVALID_INPUT,
-                                   "Invalid --since time format: " + *args_.since);
+    // Extract correlation IDs
+    analysis::CorrelationExtractor corr_extractor;
+    for (auto& event : out_store) {
+        corr_extractor.extract(event);
+    }
+    
+    // Later filters narrow this view; the store itself isn't touched again
+    // except to correct timestamps in place
+    out_events = analysis::EventView(out_store);
+    
+    // Align source clocks before events from different hosts are compared
+    if (args_.correct_clock_skew) {
+        analysis::ClockSkewEstimator skew_estimator(skew_config);
+        clock_skew_ = skew_estimator.estimate(out_store);
+        size_t shifted = analysis::ClockSkewEstimator::apply(clock_skew_, out_store);
+        g_logger.verbose("Joined ", clock_skew_.joined_ids, " correlation IDs across sources");
+        for (const auto& entry : clock_skew_.offsets) {
+            g_logger.debug("  Clock offset ", entry.source, ": ", entry.offset.count(), " ms",
+                           entry.reference ? " (reference)" : "",
+                           entry.applied ? " (corrected)" : "");
+            if (entry.applied && std::chrono::abs(entry.offset) > skew_config.max_delta &&
+                (filter.start.has_value() || filter.end.has_value())) {
+                g_logger.warning("Clock offset of ", entry.source, " exceeds the ",
+                                 skew_config.max_delta.count() / 1000, "s read margin; events "
+                                 "shifted into the time window from beyond it are missing");
             }
-            window.start = start;
-            g_logger.verbose("Filtering events since ", *args_.since);
         }
-        
-        if (args_.until.has_value()) {
-            auto end = analysis::parse_time(*args_.until);
-            if (!end.has_value()) {
-                return core::Status(core::ErrorCode::INVALID_INPUT,
-                                   "Invalid --until time format: " + *args_.until);
-            }
-            window.end = end;
-            g_logger.verbose("Filtering events until ", *args_.until);
+        if (shifted > 0) {
+            g_logger.info("Corrected clock skew in ", clock_skew_.applied_count(),
+                          " source(s) (", shifted, " events; offsets include request latency)");
         }
         
-        out_events = analysis::filter_by_window(out_events, window);
-        g_logger.info("After time filtering: ", out_events.size(), " events");
+        // Exact --since/--until on the corrected timestamps
+        if (filter.start.has_value() || filter.end.has_value()) {
+            out_events = out_events.where(
+                [&filter](const core::Event& event) { return filter.accepts_time(event.ts); });
+            g_logger.verbose("After time window on corrected clocks: ", out_events.size(), " events");
+        }
     }
     
-    // Extract correlation IDs
-    analysis::CorrelationExtractor corr_extractor;
-    for (auto& event : out_events) {
-        corr_extractor.extract(event);
+    // Apply filter expression (after tag extraction so tag.* predicates see them)
+    if (args_.where.has_value()) {
+        analysis::Query query;
+        auto status = analysis::parse_query(*args_.where, query);
+        if (!status.ok()) {
+            return status;
+        }
+        
+        // Severity, correlation and time predicates use the index; text
+        // predicates scan the surviving candidates, which is cheaper here
+        // than building a full-text index for a single query
+        analysis::EventIndex index;
+        index.build(out_events);
+        lookup_.build(out_events);
+        analysis::QueryEngine engine(out_events, &index, nullptr, &lookup_);
+        g_logger.debug("Query plan:\n", engine.explain(query));
+        
+        // Narrow the view rather than the store: no event is moved or copied
+        out_events = engine.view(query);
+        g_logger.info("After --where filtering: ", out_events.size(), " events");
     }
     
     return core::Status::OK();
 }
 
-core::Status App::analyze(const std::vector<core::Event>& events,
+core::Status App::analyze(const analysis::EventView& events,
                           analysis::Stats& out_stats,
                           std::vector<analysis::Episode>& out_episodes,
                           std::vector<rules::Finding>& out_findings) {
@@ -172,10 +258,15 @@ core::Status App::analyze(const std::vector<core::Event>& events,
     
     g_logger.verbose("Starting analysis phase");
     
-    // Build index
-    g_logger.debug("Building event index");
-    analysis::EventIndex index;
-    index.build(events);
+    // One EventId -> event table over the filtered view, shared by the rules
+    // and the narrator
+    lookup_.build(events);
+    
+    // Keyword features (restart/change/retry/timeout) for detectors and
+    // rules, from one automaton pass over each message
+    core::ThreadPool pool;
+    analysis::EventFeatures features;
+    features.build(events, &pool);
     
     // Build episodes
     g_logger.debug("Building episodes");
@@ -185,8 +276,14 @@ core::Status App::analyze(const std::vector<core::Event>& events,
     
     // Build statistics
     g_logger.debug("Building statistics");
-    analysis::StatsBuilder stats_builder;
-    out_stats = stats_builder.build(events);
+    analysis::StatsConfig stats_config;
+    stats_config.rollup_resolutions = {std::chrono::minutes(5), std::chrono::hours(1),
+                                       std::chrono::hours(24)};
+    if (args_.group_by.has_value()) {
+        stats_config.partition_by = *args_.group_by;
+    }
+    analysis::StatsBuilder stats_builder(stats_config);
+    out_stats = stats_builder.build_parallel(events, pool);
     
     g_logger.verbose("Event statistics:");
     g_logger.verbose("  Total: ", out_stats.total_events);
@@ -198,27 +295,83 @@ core::Status App::analyze(const std::vector<core::Event>& events,
     std::vector<analysis::Anomaly> anomalies;
     
     analysis::RestartLoopDetector restart_detector;
-    auto restart_anomalies = restart_detector.detect(events);
+    auto restart_anomalies = restart_detector.detect(events, features);
     g_logger.verbose("Found ", restart_anomalies.size(), " restart loops");
     anomalies.insert(anomalies.end(), restart_anomalies.begin(), restart_anomalies.end());
     
-    analysis::ErrorBurstDetector burst_detector;
-    auto burst_anomalies = burst_detector.detect(events, out_stats);
+    // Rolling baseline over the error series (events from several files are
+    // not time-ordered, the series is), at the finest rollup that keeps a
+    // long input within kMaxBurstBuckets; partitions use the same resolution
+    analysis::RollingBurstDetector burst_detector;
+    std::vector<analysis::Anomaly> burst_anomalies;
+    std::optional<std::chrono::minutes> burst_resolution;
+    if (const auto* error_series = out_stats.series_for_span(core::Severity::ERROR, kMaxBurstBuckets)) {
+        burst_resolution = error_series->bucket_size;
+        g_logger.debug("Scanning error bursts at ", burst_resolution->count(), "m buckets");
+        burst_anomalies = burst_detector.detect(*error_series);
+    }
+    
+    // Sub-minute spikes and slow climbs the per-minute baseline misses
+    analysis::MultiWindowBurstDetector window_detector;
+    size_t rolling_bursts = burst_anomalies.size();
+    for (auto& anomaly : window_detector.detect(events)) {
+        bool seen = std::any_of(burst_anomalies.begin(), burst_anomalies.begin() + rolling_bursts,
+            [&anomaly](const analysis::Anomaly& other) {
+                return *anomaly.start_time < *other.end_time && *other.start_time < *anomaly.end_time;
+            });
+        if (!seen) {
+            burst_anomalies.push_back(std::move(anomaly));
+        }
+    }
+    
+    // Bursts confined to one partition, which the overall series can hide
+    size_t overall_bursts = burst_anomalies.size();
+    for (auto& anomaly : burst_detector.detect(out_stats.partitions, burst_resolution)) {
+        bool seen = std::any_of(burst_anomalies.begin(), burst_anomalies.begin() + overall_bursts,
+            [&anomaly](const analysis::Anomaly& other) {
+                return *anomaly.start_time < *other.end_time && *other.start_time < *anomaly.end_time;
+            });
+        if (!seen) {
+            burst_anomalies.push_back(std::move(anomaly));
+        }
+    }
     g_logger.verbose("Found ", burst_anomalies.size(), " error bursts");
     anomalies.insert(anomalies.end(), burst_anomalies.begin(), burst_anomalies.end());
     
+    // Sources that stopped logging, judged against their own cadence
+    analysis::MissingHeartbeatDetector heartbeat_detector;
+    auto silences = heartbeat_detector.detect(events);
+    g_logger.verbose("Found ", silences.size(), " silent sources");
+    anomalies.insert(anomalies.end(), silences.begin(), silences.end());
+    
+    // Lasting level shifts in each severity's rate, overall and per source
+    analysis::ChangePointDetector change_detector;
+    auto shifts = change_detector.detect(out_stats);
+    if (out_stats.source_counts.size() > 1) {
+        for (auto sev : {core::Severity::ERROR, core::Severity::WARN}) {
+            auto source_shifts = change_detector.detect_by_source(events, sev);
+            shifts.insert(shifts.end(), source_shifts.begin(), source_shifts.end());
+        }
+    }
+    g_logger.verbose("Found ", shifts.size(), " rate level shifts");
+    anomalies.insert(anomalies.end(), shifts.begin(), shifts.end());
+    
     // Run rules
     g_logger.debug("Running rules engine");
     rules::RuleRegistry registry;
     registry.register_rule(std::make_unique<rules::builtin::CrashLoopRule>());
     registry.register_rule(std::make_unique<rules::builtin::RetryToTimeoutRule>());
     registry.register_rule(std::make_unique<rules::builtin::ErrorBurstAfterChangeRule>());
+    registry.register_rule(std::make_unique<rules::builtin::SourceSilenceRule>());
+    registry.register_rule(std::make_unique<rules::builtin::LevelShiftRule>());
     
     rules::RuleContext ctx;
     ctx.events = &events;
     ctx.stats = &out_stats;
     ctx.episodes = &out_episodes;
     ctx.anomalies = &anomalies;
+    ctx.lookup = &lookup_;
+    ctx.features = &features;
     
     out_findings = registry.evaluate_all(ctx);
     
@@ -230,7 +383,7 @@ core::Status App::analyze(const std::vector<core::Event>& events,
     return core::Status::OK();
 }
 
-core::Status App::generate_reports(const std::vector<core::Event>& events,
+core::Status App::generate_reports(const analysis::EventView& events,
                                    const analysis::Stats& stats,
                                    const std::vector<analysis::Episode>& episodes,
                                    const std::vector<rules::Finding>& findings) {
@@ -247,7 +400,8 @@ core::Status App::generate_reports(const std::vector<core::Event>& events,
     // Generate report
     g_logger.debug("Running narrator");
     narrative::Narrator narrator;
-    auto report = narrator.generate(events, stats, episodes, findings);
+    auto report = narrator.generate(events, stats, episodes, findings, &lookup_);
+    narrator.describe_clock_skew(report, clock_skew_);
     
     // Write outputs based on format selection
     if (should_write_format(OutputFormat::MARKDOWN)) {
@@ -283,6 +437,63 @@ core::Status App::generate_reports(const std::vector<core::Event>& events,
     return core::Status::OK();
 }
 
+core::Status App::build_event_filter(parsing::EventFilter& out_filter) const {
+    using core::g_logger;
+    
+    if (args_.since.has_value()) {
+        auto start = analysis::parse_time(*args_.since);
+        if (!start.has_value()) {
+            return core::Status(core::ErrorCode::INVALID_INPUT,
+                               "Invalid --since time format: " + *args_.since);
+        }
+        out_filter.start = start;
+        g_logger.verbose("Filtering events since ", *args_.since);
+    }
+    
+    if (args_.until.has_value()) {
+        auto end = analysis::parse_time(*args_.until);
+        if (!end.has_value()) {
+            return core::Status(core::ErrorCode::INVALID_INPUT,
+                               "Invalid --until time format: " + *args_.until);
+        }
+        out_filter.end = end;
+        g_logger.verbose("Filtering events until ", *args_.until);
+    }
+    
+    if (args_.min_severity.has_value()) {
+        auto sev = core::severity_from_string(*args_.min_severity);
+        if (sev == core::Severity::UNKNOWN) {
+            return core::Status(core::ErrorCode::INVALID_INPUT,
+                               "Invalid --min-severity level: " + *args_.min_severity);
+        }
+        out_filter.min_severity = sev;
+        g_logger.verbose("Filtering events below ", core::to_string(sev));
+    }
+    
+    return core::Status::OK();
+}
+
+bool App::file_outside_window(io::FileReader& reader, const std::string& path,
+                              const parsing::EventFilter& filter) const {
+    if (!filter.start.has_value() && !filter.end.has_value()) {
+        return false;
+    }
+    
+    // mtime first (no open), then the head/tail timestamps with the same
+    // jitter slack read_window seeks with
+    io::FileTimeBounds bounds;
+    if (!reader.probe_time_bounds(path, bounds, false).ok()) {
+        return false;
+    }
+    if (bounds.outside(filter.start, filter.end)) {
+        return true;
+    }
+    if (!reader.probe_time_bounds(path, bounds).ok()) {
+        return false;
+    }
+    return bounds.outside(filter.start, filter.end, reader.seek_config().jitter);
+}
+
 core::Status App::read_directory(const std::string& path, std::vector<core::Event>& out_events) {
     io::DirScanner scanner;
     std::vector<std::string> files;
@@ -92,6 +92,65 @@ Args ArgParser::parse(int argc, char** argv) {
             continue;
         }
         
+        // Minimum severity filter
+        if (arg == "--min-severity") {
+            if (i + 1 >= argc) {
+                error_message_ = "Option --min-severity requires an argument";
+                return args;
+            }
+            args.min_severity = argv[++i];
+            continue;
+        }
+        
+        // Filter expression
+        if (arg == "--where") {
+            if (i + 1 >= argc) {
+                error_message_ = "Option --where requires an argument";
+                return args;
+            }
+            args.where = argv[++i];
+            continue;
+        }
+        
+        // Partitioned statistics: "source", "tag.<key>" or a bare tag key
+        if (arg == "--group-by") {
+            if (i + 1 >= argc) {
+                error_message_ = "Option --group-by requires an argument";
+                return args;
+            }
+            std::string dimension = argv[++i];
+            if (dimension.rfind("tag.", 0) == 0) {
+                dimension = dimension.substr(4);
+            }
+            if (dimension.empty()) {
+                error_message_ = "Option --group-by requires a tag key or 'source'";
+                return args;
+            }
+            args.group_by = dimension;
+            continue;
+        }
+        
+        if (arg == "--no-skew-correction") {
+            args.correct_clock_skew = false;
+            continue;
+        }
+        
+        // Time index sidecars
+        if (arg == "--time-index") {
+            args.time_index = true;
+            continue;
+        }
+        
+        if (arg == "--time-index-dir") {
+            if (i + 1 >= argc) {
+                error_message_ = "Option --time-index-dir requires an argument";
+                return args;
+            }
+            args.time_index = true;
+            args.time_index_dir = argv[++i];
+            continue;
+        }
+        
         // Verbosity
         if (arg == "-q" || arg == "--quiet") {
             args.verbosity = Verbosity::QUIET;
@@ -144,6 +203,18 @@ void ArgParser::print_help(const std::string& program_name) const {
     std::cout << "  -f, --format <FMT>      Output format: md, json, csv, all [default: all]\n";
     std::cout << "  --since <TIME>          Only analyze events after this time (ISO8601)\n";
     std::cout << "  --until <TIME>          Only analyze events before this time (ISO8601)\n";
+    std::cout << "  --min-severity <LEVEL>  Only analyze events at or above this severity\n";
+    std::cout << "  --where <EXPR>          Only analyze events matching a filter expression\n";
+    std::cout << "                          (fields: sev, text, source, ts, id, tag.<key>;\n";
+    std::cout << "                           ops: = != < <= > >= ~; combine with and/or/not)\n";
+    std::cout << "  --group-by <DIM>        Break down error rates and bursts by source or by a\n";
+    std::cout << "                          tag (e.g. service, host, pod)\n";
+    std::cout << "  --no-skew-correction    Keep each source's timestamps as logged instead of\n";
+    std::cout << "                          aligning clocks via shared request/trace IDs\n";
+    std::cout << "                          (estimated offsets include request latency)\n";
+    std::cout << "  --time-index            Keep a time index next to each file to speed up\n";
+    std::cout << "                          repeated --since/--until runs\n";
+    std::cout << "  --time-index-dir <DIR>  Keep time indexes in DIR instead (implies --time-index)\n";
     std::cout << "  -q, --quiet             Suppress progress output\n";
     std::cout << "  --verbose               Show detailed progress information\n";
     std::cout << "  --debug                 Show debug output\n\n";
@@ -167,6 +238,12 @@ void ArgParser::print_help(const std::string& program_name) const {
     std::cout << "  # Analyze logs from a specific time range\n";
     std::cout << "  " << program_name << " --since 2024-03-01T00:00:00Z --until 2024-03-02T00:00:00Z app.log\n\n";
     
+    std::cout << "  # Analyze only warnings and errors from the api service that mention timeouts\n";
+    std::cout << "  " << program_name << " --where \"sev>=WARN and tag.service=api and text~timeout\" app.log\n\n";
+    
+    std::cout << "  # Rank services by error rate and look for bursts in each\n";
+    std::cout << "  " << program_name << " --group-by service logs/\n\n";
+    
     std::cout << "  # Custom output directory with verbose logging\n";
     std::cout << "  " << program_name << " --verbose --out reports/ logs/\n\n";
 }
@@ -0,0 +1,63 @@
+#include "logstory/core/tags.hpp"
+#include "logstory/core/text_search.hpp"
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+
+namespace logstory::core {
+
+namespace {
+
+// Multiplier that normalizes a unit suffix, or 0 if the suffix is unknown
+double unit_scale(std::string_view unit) {
+    if (unit.empty()) return 1.0;
+    if (unit == "ns") return 1e-6;
+    if (unit == "us" || unit == "\xC2\xB5s") return 1e-3;
+    if (unit == "ms") return 1.0;
+    if (unit == "s") return 1e3;
+    if (equals_ignore_case(unit, "b")) return 1.0;
+    if (equals_ignore_case(unit, "kb")) return 1024.0;
+    if (equals_ignore_case(unit, "mb")) return 1024.0 * 1024.0;
+    if (equals_ignore_case(unit, "gb")) return 1024.0 * 1024.0 * 1024.0;
+    return 0.0;
+}
+
+} // namespace
+
+std::optional<double> parse_numeric_tag(std::string_view value) {
+    // Sign, digits, optional fraction; no exponents or hex so IDs stay strings
+    size_t pos = 0;
+    if (pos < value.size() && (value[pos] == '-' || value[pos] == '+')) {
+        ++pos;
+    }
+    size_t digits = 0;
+    while (pos < value.size() && std::isdigit(static_cast<unsigned char>(value[pos]))) {
+        ++pos;
+        ++digits;
+    }
+    if (pos < value.size() && value[pos] == '.') {
+        ++pos;
+        while (pos < value.size() && std::isdigit(static_cast<unsigned char>(value[pos]))) {
+            ++pos;
+            ++digits;
+        }
+    }
+    if (digits == 0) {
+        return std::nullopt;
+    }
+    
+    double scale = unit_scale(value.substr(pos));
+    if (scale == 0.0) {
+        return std::nullopt;
+    }
+    
+    std::string number(value.substr(0, pos));
+    double parsed = std::strtod(number.c_str(), nullptr);
+    if (!std::isfinite(parsed)) {
+        return std::nullopt;
+    }
+    return parsed * scale;
+}
+
+} // namespace logstory::core
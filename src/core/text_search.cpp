@@ -0,0 +1,122 @@
+#include "logstory/core/text_search.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LOGSTORY_TEXT_SEARCH_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace logstory::core {
+
+namespace {
+
+constexpr size_t npos = std::string_view::npos;
+
+bool is_lower_letter(char c) {
+    return c >= 'a' && c <= 'z';
+}
+
+// Compare `n` haystack bytes against an already-lowercase needle
+bool folded_equal(const char* hay, const char* lower_needle, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        if (ascii_lower(hay[i]) != lower_needle[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t find_scalar(std::string_view haystack, std::string_view needle, size_t from) {
+    const size_t n = needle.size();
+    const char first = needle[0];
+    for (size_t i = from; i + n <= haystack.size(); ++i) {
+        if (ascii_lower(haystack[i]) == first &&
+            folded_equal(haystack.data() + i + 1, needle.data() + 1, n - 1)) {
+            return i;
+        }
+    }
+    return npos;
+}
+
+#ifdef LOGSTORY_TEXT_SEARCH_SSE2
+
+unsigned lowest_bit(unsigned mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#else
+    unsigned bit = 0;
+    while ((mask & 1u) == 0) {
+        mask >>= 1;
+        ++bit;
+    }
+    return bit;
+#endif
+}
+
+// Bytes of `block` equal to `lower` ignoring ASCII case. OR-ing in 0x20 folds
+// only letters correctly ('@' | 0x20 == '`'), so the fold bit is applied only
+// when the needle byte is a letter.
+inline __m128i folded_eq(__m128i block, __m128i fold, __m128i lower) {
+    return _mm_cmpeq_epi8(_mm_or_si128(block, fold), lower);
+}
+
+size_t find_sse2(std::string_view haystack, std::string_view needle) {
+    const size_t n = needle.size();
+    const char* hay = haystack.data();
+    const size_t last_start = haystack.size() - n;  // Last valid match offset
+    
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[n - 1]);
+    const __m128i first_fold = _mm_set1_epi8(is_lower_letter(needle[0]) ? 0x20 : 0);
+    const __m128i last_fold = _mm_set1_epi8(is_lower_letter(needle[n - 1]) ? 0x20 : 0);
+    
+    size_t i = 0;
+    for (; i + 16 <= last_start + 1; i += 16) {
+        __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + i));
+        __m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + i + n - 1));
+        __m128i hits = _mm_and_si128(folded_eq(block_first, first_fold, first),
+                                     folded_eq(block_last, last_fold, last));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hits));
+        while (mask != 0) {
+            unsigned bit = lowest_bit(mask);
+            if (n <= 2 || folded_equal(hay + i + bit + 1, needle.data() + 1, n - 2)) {
+                return i + bit;
+            }
+            mask &= mask - 1;
+        }
+    }
+    
+    // Fewer than 16 candidate offsets left
+    return find_scalar(haystack, needle, i);
+}
+
+#endif
+
+} // namespace
+
+size_t find_ignore_case(std::string_view haystack, std::string_view lower_needle) {
+    if (lower_needle.empty()) {
+        return 0;
+    }
+    if (lower_needle.size() > haystack.size()) {
+        return npos;
+    }
+#ifdef LOGSTORY_TEXT_SEARCH_SSE2
+    return find_sse2(haystack, lower_needle);
+#else
+    return find_scalar(haystack, lower_needle, 0);
+#endif
+}
+
+bool equals_ignore_case(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (ascii_lower(a[i]) != ascii_lower(b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace logstory::core
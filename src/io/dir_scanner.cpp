@@ -1,4 +1,5 @@
 #include "logstory/io/dir_scanner.hpp"
+#include "logstory/core/text_search.hpp"
 #include <filesystem>
 #include <algorithm>
 
@@ -65,14 +66,9 @@ bool DirScanner::has_allowed_extension(const std::string& path,
     
     std::string ext = fs::path(path).extension().string();
     
-    // Convert to lowercase for case-insensitive comparison
-    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
-    
+    // Case-insensitive comparison without lowercased copies
     for (const auto& allowed : extensions) {
-        std::string allowed_lower = allowed;
-        std::transform(allowed_lower.begin(), allowed_lower.end(), 
-                      allowed_lower.begin(), ::tolower);
-        if (ext == allowed_lower) {
+        if (core::equals_ignore_case(ext, allowed)) {
             return true;
         }
     }
@@ -1,9 +1,89 @@
 #include "logstory/io/file_reader.hpp"
+#include "logstory/io/time_index.hpp"
+#include "logstory/parsing/timestamp_detector.hpp"
+#include <algorithm>
 #include <fstream>
 #include <filesystem>
+#include <iterator>
 
 namespace logstory::io {
 
+namespace {
+
+using time_point = FileTimeBounds::time_point;
+
+/// First timestamped line at or after some offset
+struct Probe {
+    uintmax_t offset = 0;          // Line start (or where the probe stopped)
+    std::optional<time_point> tp;
+    bool at_eof = false;
+};
+
+/// Position the stream at the first line starting at or after `from` and
+/// return that offset
+uintmax_t sync_to_line(std::ifstream& file, uintmax_t from) {
+    file.clear();
+    if (from == 0) {
+        file.seekg(0);
+        return 0;
+    }
+    
+    // Start one byte early so a probe landing exactly on a line start
+    // keeps that line
+    file.seekg(static_cast<std::streamoff>(from - 1));
+    std::string partial;
+    std::getline(file, partial);
+    return from + partial.size();
+}
+
+Probe probe_from(std::ifstream& file, uintmax_t from, size_t max_bytes,
+                 parsing::TimestampDetector& detector) {
+    Probe probe;
+    uintmax_t offset = sync_to_line(file, from);
+    uintmax_t scanned = 0;
+    std::string line;
+    
+    while (scanned <= max_bytes && std::getline(file, line)) {
+        uintmax_t consumed = line.size() + 1;
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (auto ts = detector.detect(line); ts.has_value() && ts->is_valid()) {
+            probe.offset = offset;
+            probe.tp = ts->tp;
+            return probe;
+        }
+        offset += consumed;
+        scanned += consumed;
+    }
+    
+    probe.offset = offset;
+    probe.at_eof = file.eof();
+    return probe;
+}
+
+} // namespace
+
+bool FileTimeBounds::outside(const std::optional<time_point>& start,
+                             const std::optional<time_point>& end,
+                             std::chrono::seconds jitter) const {
+    if (start.has_value() && mtime + kMtimeSlack < *start) {
+        return true;
+    }
+    
+    // First/last only bound the file if it looks time-ordered
+    if (!first.has_value() || !last.has_value() || last->tp < first->tp) {
+        return false;
+    }
+    if (start.has_value() && last->tp + jitter < *start) {
+        return true;
+    }
+    if (end.has_value() && first->tp > *end + jitter) {
+        return true;
+    }
+    return false;
+}
+
 core::Status FileReader::read(const std::string& path, std::vector<RawLine>& out_lines) {
     namespace fs = std::filesystem;
 
@@ -44,6 +124,363 @@ core::Status FileReader::read(const std::string& path, std::vector<RawLine>& out
     return core::Status::OK();
 }
 
+core::Status FileReader::probe_time_bounds(const std::string& path, FileTimeBounds& out,
+                                           bool read_timestamps, size_t probe_bytes) {
+    namespace fs = std::filesystem;
+    
+    std::error_code ec;
+    auto ftime = fs::last_write_time(path, ec);
+    auto size = ec ? 0 : fs::file_size(path, ec);
+    if (ec) {
+        return core::Status(core::ErrorCode::FILE_NOT_FOUND,
+                           "Cannot stat file: " + path);
+    }
+    
+    // file_time_type has no portable conversion in C++17; shift by "now"
+    out.mtime = std::chrono::time_point_cast<std::chrono::system_clock::duration>(
+        std::chrono::system_clock::now() + (ftime - fs::file_time_type::clock::now()));
+    out.first.reset();
+    out.last.reset();
+    
+    if (!read_timestamps) {
+        return core::Status::OK();
+    }
+    
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return core::Status(core::ErrorCode::FILE_UNREADABLE,
+                           "Failed to open file: " + path);
+    }
+    
+    parsing::TimestampDetector detector;
+    std::string line;
+    
+    // Head: first timestamped line
+    size_t consumed = 0;
+    while (consumed < probe_bytes && std::getline(file, line)) {
+        consumed += line.size() + 1;
+        normalize_line_ending(line);
+        if (auto ts = detector.detect(line); ts.has_value() && ts->is_valid()) {
+            out.first = ts;
+            break;
+        }
+    }
+    
+    // Tail: last timestamped line, skipping the partial line at the seek point
+    file.clear();
+    uintmax_t tail_start = size > probe_bytes ? size - probe_bytes : 0;
+    file.seekg(static_cast<std::streamoff>(tail_start));
+    if (tail_start > 0) {
+        std::getline(file, line);
+    }
+    while (std::getline(file, line)) {
+        normalize_line_ending(line);
+        if (auto ts = detector.detect(line); ts.has_value() && ts->is_valid()) {
+            out.last = ts;
+        }
+    }
+    
+    return core::Status::OK();
+}
+
+core::Status FileReader::read_window(const std::string& path,
+                                     const std::optional<FileTimeBounds::time_point>& start,
+                                     const std::optional<FileTimeBounds::time_point>& end,
+                                     std::vector<RawLine>& out_lines,
+                                     SeekResult* result) {
+    namespace fs = std::filesystem;
+    
+    SeekResult local;
+    SeekResult& seek = result != nullptr ? *result : local;
+    seek = SeekResult();
+    
+    std::error_code ec;
+    uintmax_t size = fs::is_regular_file(path, ec) ? fs::file_size(path, ec) : 0;
+    
+    auto read_all = [&](std::string reason) {
+        seek = SeekResult();
+        seek.end_offset = size;
+        seek.fallback_reason = std::move(reason);
+        return read(path, out_lines);
+    };
+    
+    if (!start.has_value() && !end.has_value()) {
+        return read_all("no time window");
+    }
+    if (ec || size < seek_config_.min_file_bytes) {
+        // read() reports missing or irregular files
+        return read_all("file below seek threshold");
+    }
+    
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return core::Status(core::ErrorCode::FILE_UNREADABLE,
+                           "Failed to open file: " + path);
+    }
+    
+    if (seek_config_.use_time_index) {
+        TimeIndex index;
+        std::string sidecar = TimeIndex::sidecar_path(path, seek_config_.time_index_dir);
+        if (index.load(sidecar).ok() && index.matches(path)) {
+            if (!index.ordered()) {
+                return read_all("timestamps are not monotonic");
+            }
+            TimeIndex::Entry from = start.has_value() ? index.seek_start(*start) : TimeIndex::Entry{};
+            seek.start_offset = from.offset;
+            seek.start_line = from.line_no;
+            seek.end_offset = std::max(end.has_value() ? index.seek_end(*end) : size,
+                                       seek.start_offset);
+            seek.indexed = true;
+            return read_range(file, path, seek, out_lines);
+        }
+        
+        // No usable sidecar: build one in the pass that reads the window
+        if (index.begin(path, std::chrono::seconds(60), seek_config_.jitter).ok()) {
+            std::vector<RawLine> window;
+            auto status = read_and_index(file, path, start, end, index, window, seek);
+            if (!status.ok()) {
+                return status;
+            }
+            
+            // Read-only archives just don't get a sidecar
+            if (!seek_config_.time_index_dir.empty()) {
+                std::filesystem::create_directories(seek_config_.time_index_dir, ec);
+            }
+            (void)index.save(sidecar);
+            
+            if (!index.ordered()) {
+                return read_all("timestamps are not monotonic");
+            }
+            out_lines.insert(out_lines.end(), std::make_move_iterator(window.begin()),
+                             std::make_move_iterator(window.end()));
+            return core::Status::OK();
+        }
+    }
+    
+    if (!bisect_window(file, size, start, end, seek)) {
+        return read_all(seek.fallback_reason);
+    }
+    seek.bisected = true;
+    
+    // Count newlines in the skipped prefix so SourceRef line numbers stay
+    // exact; this is a raw block scan with no line parsing
+    file.clear();
+    file.seekg(0);
+    std::vector<char> buffer(1 << 20);
+    uintmax_t remaining = seek.start_offset;
+    uint32_t newlines = 0;
+    while (remaining > 0) {
+        auto chunk = static_cast<std::streamsize>(std::min<uintmax_t>(remaining, buffer.size()));
+        file.read(buffer.data(), chunk);
+        auto got = file.gcount();
+        if (got <= 0) {
+            break;
+        }
+        newlines += static_cast<uint32_t>(std::count(buffer.data(), buffer.data() + got, '\n'));
+        remaining -= static_cast<uintmax_t>(got);
+    }
+    seek.start_line = newlines + 1;
+    
+    return read_range(file, path, seek, out_lines);
+}
+
+core::Status FileReader::read_range(std::ifstream& file, const std::string& path,
+                                    const SeekResult& range, std::vector<RawLine>& out_lines) {
+    file.clear();
+    file.seekg(static_cast<std::streamoff>(range.start_offset));
+    std::string line;
+    uintmax_t offset = range.start_offset;
+    uint32_t line_no = range.start_line;
+    while (offset < range.end_offset && std::getline(file, line)) {
+        offset += line.size() + 1;
+        normalize_line_ending(line);
+        out_lines.emplace_back(line, path, line_no);
+        ++line_no;
+    }
+    
+    if (file.bad()) {
+        return core::Status(core::ErrorCode::FILE_UNREADABLE,
+                           "Error reading file: " + path);
+    }
+    
+    return core::Status::OK();
+}
+
+core::Status FileReader::read_and_index(std::ifstream& file, const std::string& path,
+                                        const std::optional<FileTimeBounds::time_point>& start,
+                                        const std::optional<FileTimeBounds::time_point>& end,
+                                        TimeIndex& index, std::vector<RawLine>& out_lines,
+                                        SeekResult& seek) {
+    // Same range TimeIndex::seek_start/seek_end would give once built: from
+    // the last entry before start - jitter up to the first entry after
+    // end + jitter. Entries arrive in time order, so each new entry before
+    // the lower bound restarts the window, and lines from the first entry
+    // past the upper bound on are only indexed, not kept.
+    std::optional<FileTimeBounds::time_point> lower;
+    std::optional<FileTimeBounds::time_point> upper;
+    if (start.has_value()) {
+        lower = *start - seek_config_.jitter;
+    }
+    if (end.has_value()) {
+        upper = *end + seek_config_.jitter;
+    }
+    
+    seek.indexed = true;
+    seek.start_offset = 0;
+    seek.start_line = 1;
+    
+    file.clear();
+    file.seekg(0);
+    parsing::TimestampDetector detector;
+    size_t entries_seen = 0;
+    bool past_end = false;
+    uintmax_t offset = 0;
+    uint32_t line_no = 1;
+    std::string line;
+    
+    while (std::getline(file, line)) {
+        uintmax_t consumed = line.size() + 1;
+        normalize_line_ending(line);
+        
+        std::optional<FileTimeBounds::time_point> tp;
+        if (auto ts = detector.detect(line); ts.has_value() && ts->is_valid()) {
+            tp = ts->tp;
+        }
+        index.add(tp, offset, line_no);
+        
+        if (index.entries().size() > entries_seen) {
+            entries_seen = index.entries().size();
+            const auto& entry = index.entries().back();
+            if (lower.has_value() && entry.tp < *lower) {
+                out_lines.clear();
+                seek.start_offset = offset;
+                seek.start_line = line_no;
+            }
+            if (!past_end && upper.has_value() && entry.tp > *upper) {
+                past_end = true;
+                seek.end_offset = offset;
+            }
+        }
+        if (!past_end) {
+            out_lines.emplace_back(line, path, line_no);
+        }
+        
+        offset += consumed;
+        ++line_no;
+    }
+    
+    if (file.bad()) {
+        return core::Status(core::ErrorCode::FILE_UNREADABLE,
+                           "Error reading file: " + path);
+    }
+    if (!past_end) {
+        seek.end_offset = offset;
+    }
+    return core::Status::OK();
+}
+
+bool FileReader::bisect_window(std::ifstream& file, uintmax_t size,
+                               const std::optional<FileTimeBounds::time_point>& start,
+                               const std::optional<FileTimeBounds::time_point>& end,
+                               SeekResult& result) const {
+    const SeekConfig& cfg = seek_config_;
+    parsing::TimestampDetector detector;
+    
+    // Every timestamp seen so far; a new one must not be out of order with
+    // any of them by more than the jitter allowance
+    std::vector<Probe> seen;
+    auto record = [&](const Probe& p) {
+        for (const auto& q : seen) {
+            bool inverted = q.offset < p.offset ? *p.tp + cfg.jitter < *q.tp
+                                                : *q.tp + cfg.jitter < *p.tp;
+            if (inverted) {
+                result.fallback_reason = "timestamps are not monotonic";
+                return false;
+            }
+        }
+        seen.push_back(p);
+        return true;
+    };
+    
+    Probe head = probe_from(file, 0, cfg.probe_bytes, detector);
+    Probe tail = probe_from(file, size > cfg.probe_bytes ? size - cfg.probe_bytes : 0,
+                            cfg.probe_bytes, detector);
+    if (!head.tp.has_value() || !tail.tp.has_value()) {
+        result.fallback_reason = "no timestamps near head or tail";
+        return false;
+    }
+    if (!record(head) || !record(tail)) {
+        return false;
+    }
+    
+    // Offset of the first line whose timestamp satisfies `after`, which must
+    // be monotonic over the file (false, then true)
+    auto first_line_where = [&](auto after, uintmax_t& out) {
+        uintmax_t lo = 0;
+        uintmax_t hi = size;
+        while (hi - lo > cfg.block_bytes) {
+            uintmax_t mid = lo + (hi - lo) / 2;
+            Probe p = probe_from(file, mid, cfg.probe_bytes, detector);
+            if (!p.tp.has_value()) {
+                if (!p.at_eof) {
+                    result.fallback_reason = "no timestamp within probe range";
+                    return false;
+                }
+                hi = mid;
+                continue;
+            }
+            if (!record(p)) {
+                return false;
+            }
+            if (after(*p.tp)) {
+                hi = mid;
+            } else {
+                lo = mid;
+            }
+        }
+        
+        // Finish with a short sequential scan from lo
+        uintmax_t offset = sync_to_line(file, lo);
+        std::optional<time_point> latest;
+        std::string line;
+        while (std::getline(file, line)) {
+            uintmax_t consumed = line.size() + 1;
+            normalize_line_ending(line);
+            if (auto ts = detector.detect(line); ts.has_value() && ts->is_valid()) {
+                if (latest.has_value() && ts->tp + cfg.jitter < *latest) {
+                    result.fallback_reason = "timestamps are not monotonic";
+                    return false;
+                }
+                latest = std::max(latest.value_or(ts->tp), ts->tp);
+                if (after(ts->tp)) {
+                    out = offset;
+                    return true;
+                }
+            }
+            offset += consumed;
+        }
+        out = size;
+        return true;
+    };
+    
+    result.start_offset = 0;
+    result.end_offset = size;
+    if (start.has_value()) {
+        auto from = *start - cfg.jitter;
+        if (!first_line_where([from](time_point tp) { return tp >= from; }, result.start_offset)) {
+            return false;
+        }
+    }
+    if (end.has_value()) {
+        auto until = *end + cfg.jitter;
+        if (!first_line_where([until](time_point tp) { return tp > until; }, result.end_offset)) {
+            return false;
+        }
+    }
+    result.end_offset = std::max(result.end_offset, result.start_offset);
+    return true;
+}
+
 void FileReader::normalize_line_ending(std::string& line) {
     // Strip trailing \r to normalize Windows line endings
     if (!line.empty() && line.back() == '\r') {
@@ -0,0 +1,309 @@
+#include "logstory/io/time_index.hpp"
+#include "logstory/parsing/timestamp_detector.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <optional>
+#include <sstream>
+
+namespace logstory::io {
+
+namespace {
+
+constexpr char kMagic[8] = {'L', 'N', 'T', 'I', 'D', 'X', '0', '1'};
+
+constexpr uint64_t kFnvOffset = 1469598103934665603ULL;
+constexpr uint64_t kFnvPrime = 1099511628211ULL;
+
+uint64_t fnv1a(const char* data, size_t len, uint64_t hash = kFnvOffset) {
+    for (size_t i = 0; i < len; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= kFnvPrime;
+    }
+    return hash;
+}
+
+template <typename T>
+void write_pod(std::ofstream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool read_pod(std::ifstream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+int64_t to_ns(TimeIndex::time_point tp) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(tp.time_since_epoch()).count();
+}
+
+TimeIndex::time_point from_ns(int64_t ns) {
+    return TimeIndex::time_point(
+        std::chrono::duration_cast<TimeIndex::time_point::duration>(std::chrono::nanoseconds(ns)));
+}
+
+} // namespace
+
+core::Status TimeIndex::compute_fingerprint(const std::string& path, Fingerprint& out) {
+    namespace fs = std::filesystem;
+    
+    std::error_code ec;
+    auto size = fs::file_size(path, ec);
+    auto mtime = ec ? fs::file_time_type() : fs::last_write_time(path, ec);
+    if (ec) {
+        return core::Status(core::ErrorCode::FILE_NOT_FOUND,
+                           "Cannot stat file: " + path);
+    }
+    
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return core::Status(core::ErrorCode::FILE_UNREADABLE,
+                           "Failed to open file: " + path);
+    }
+    
+    out.size = size;
+    out.mtime_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        mtime.time_since_epoch()).count();
+    
+    // Head and tail blocks catch rewrites and truncation without reading the
+    // whole file; appends already change the size
+    std::vector<char> block(kHashBlockBytes);
+    file.read(block.data(), static_cast<std::streamsize>(block.size()));
+    uint64_t hash = fnv1a(block.data(), static_cast<size_t>(file.gcount()));
+    if (size > kHashBlockBytes) {
+        file.clear();
+        file.seekg(static_cast<std::streamoff>(size - std::min<uint64_t>(size - kHashBlockBytes, kHashBlockBytes)));
+        file.read(block.data(), static_cast<std::streamsize>(block.size()));
+        hash = fnv1a(block.data(), static_cast<size_t>(file.gcount()), hash);
+    }
+    out.content_hash = hash;
+    
+    return core::Status::OK();
+}
+
+std::string TimeIndex::sidecar_path(const std::string& source, const std::string& dir) {
+    namespace fs = std::filesystem;
+    
+    if (dir.empty()) {
+        return source + kExtension;
+    }
+    
+    // Qualify by the absolute source path so same-named files in different
+    // directories don't collide
+    std::error_code ec;
+    std::string absolute = fs::absolute(source, ec).lexically_normal().string();
+    std::ostringstream name;
+    name << fs::path(source).filename().string() << '-'
+         << std::hex << std::setw(16) << std::setfill('0')
+         << fnv1a(absolute.data(), absolute.size()) << kExtension;
+    return (fs::path(dir) / name.str()).string();
+}
+
+core::Status TimeIndex::build(const std::string& path, std::chrono::seconds granularity,
+                              std::chrono::seconds jitter) {
+    auto status = begin(path, granularity, jitter);
+    if (!status.ok()) {
+        return status;
+    }
+    
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return core::Status(core::ErrorCode::FILE_UNREADABLE,
+                           "Failed to open file: " + path);
+    }
+    
+    parsing::TimestampDetector detector;
+    uint64_t offset = 0;
+    uint32_t line_no = 1;
+    std::string line;
+    
+    while (std::getline(file, line)) {
+        uint64_t consumed = line.size() + 1;
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        
+        std::optional<time_point> tp;
+        if (auto ts = detector.detect(line); ts.has_value() && ts->is_valid()) {
+            tp = ts->tp;
+        }
+        add(tp, offset, line_no);
+        
+        offset += consumed;
+        ++line_no;
+    }
+    
+    if (file.bad()) {
+        return core::Status(core::ErrorCode::FILE_UNREADABLE,
+                           "Error reading file: " + path);
+    }
+    
+    return core::Status::OK();
+}
+
+core::Status TimeIndex::begin(const std::string& path, std::chrono::seconds granularity,
+                              std::chrono::seconds jitter) {
+    auto status = compute_fingerprint(path, fingerprint_);
+    if (!status.ok()) {
+        return status;
+    }
+    
+    granularity_ = std::max(granularity, std::chrono::seconds(1));
+    jitter_ = jitter;
+    ordered_ = true;
+    entries_.clear();
+    latest_.reset();
+    last_bucket_ = 0;
+    return core::Status::OK();
+}
+
+void TimeIndex::add(const std::optional<time_point>& tp, uint64_t offset, uint32_t line_no) {
+    if (!tp.has_value()) {
+        return;
+    }
+    if (latest_.has_value() && *tp + jitter_ < *latest_) {
+        ordered_ = false;
+    }
+    latest_ = std::max(latest_.value_or(*tp), *tp);
+    
+    int64_t bucket = std::chrono::duration_cast<std::chrono::seconds>(
+        tp->time_since_epoch()).count() / granularity_.count();
+    if (entries_.empty() || bucket > last_bucket_) {
+        entries_.push_back(Entry{*tp, offset, line_no});
+        last_bucket_ = bucket;
+    }
+}
+
+core::Status TimeIndex::save(const std::string& sidecar) const {
+    std::ofstream out(sidecar, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        return core::Status(core::ErrorCode::UNKNOWN_ERROR,
+                           "Cannot write time index: " + sidecar);
+    }
+    
+    out.write(kMagic, sizeof(kMagic));
+    write_pod(out, fingerprint_.size);
+    write_pod(out, fingerprint_.mtime_ns);
+    write_pod(out, fingerprint_.content_hash);
+    write_pod(out, static_cast<int64_t>(jitter_.count()));
+    write_pod(out, static_cast<uint8_t>(ordered_ ? 1 : 0));
+    write_pod(out, static_cast<uint64_t>(entries_.size()));
+    for (const auto& entry : entries_) {
+        write_pod(out, to_ns(entry.tp));
+        write_pod(out, entry.offset);
+        write_pod(out, entry.line_no);
+    }
+    
+    if (!out) {
+        return core::Status(core::ErrorCode::UNKNOWN_ERROR,
+                           "Error writing time index: " + sidecar);
+    }
+    return core::Status::OK();
+}
+
+core::Status TimeIndex::load(const std::string& sidecar) {
+    std::ifstream in(sidecar, std::ios::binary);
+    if (!in.is_open()) {
+        return core::Status(core::ErrorCode::FILE_NOT_FOUND,
+                           "No time index: " + sidecar);
+    }
+    
+    auto corrupt = [&sidecar]() {
+        return core::Status(core::ErrorCode::INVALID_INPUT,
+                           "Corrupt time index: " + sidecar);
+    };
+    
+    char magic[sizeof(kMagic)];
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) {
+        return corrupt();
+    }
+    
+    Fingerprint fingerprint;
+    int64_t jitter = 0;
+    uint8_t ordered = 0;
+    uint64_t count = 0;
+    if (!read_pod(in, fingerprint.size) || !read_pod(in, fingerprint.mtime_ns) ||
+        !read_pod(in, fingerprint.content_hash) || !read_pod(in, jitter) ||
+        !read_pod(in, ordered) || !read_pod(in, count)) {
+        return corrupt();
+    }
+    
+    // An entry per line is the most a valid index can hold
+    if (count > fingerprint.size + 1) {
+        return corrupt();
+    }
+    
+    std::vector<Entry> entries;
+    entries.reserve(static_cast<size_t>(count));
+    for (uint64_t i = 0; i < count; ++i) {
+        int64_t ns = 0;
+        Entry entry;
+        if (!read_pod(in, ns) || !read_pod(in, entry.offset) || !read_pod(in, entry.line_no)) {
+            return corrupt();
+        }
+        entry.tp = from_ns(ns);
+        entries.push_back(entry);
+    }
+    
+    fingerprint_ = fingerprint;
+    jitter_ = std::chrono::seconds(jitter);
+    ordered_ = ordered != 0;
+    entries_ = std::move(entries);
+    return core::Status::OK();
+}
+
+core::Status TimeIndex::load_or_build(const std::string& source, const std::string& dir,
+                                      bool* rebuilt) {
+    std::string sidecar = sidecar_path(source, dir);
+    if (load(sidecar).ok() && matches(source)) {
+        if (rebuilt != nullptr) {
+            *rebuilt = false;
+        }
+        return core::Status::OK();
+    }
+    
+    auto status = build(source);
+    if (!status.ok()) {
+        return status;
+    }
+    if (rebuilt != nullptr) {
+        *rebuilt = true;
+    }
+    
+    // Read-only archives just don't get a sidecar
+    if (!dir.empty()) {
+        std::error_code ec;
+        std::filesystem::create_directories(dir, ec);
+    }
+    (void)save(sidecar);
+    return core::Status::OK();
+}
+
+bool TimeIndex::matches(const std::string& path) const {
+    Fingerprint current;
+    return compute_fingerprint(path, current).ok() && current == fingerprint_;
+}
+
+TimeIndex::Entry TimeIndex::seek_start(time_point start) const {
+    // Last entry strictly before start - jitter: every line ahead of it is
+    // no later than its timestamp plus jitter, so none of them is in range
+    auto bound = start - jitter_;
+    auto it = std::lower_bound(entries_.begin(), entries_.end(), bound,
+        [](const Entry& entry, time_point tp) { return entry.tp < tp; });
+    if (it == entries_.begin()) {
+        return Entry{};
+    }
+    return *std::prev(it);
+}
+
+uint64_t TimeIndex::seek_end(time_point end) const {
+    // First entry past end + jitter: no line from it on can be in range
+    auto bound = end + jitter_;
+    auto it = std::upper_bound(entries_.begin(), entries_.end(), bound,
+        [](time_point tp, const Entry& entry) { return tp < entry.tp; });
+    return it == entries_.end() ? fingerprint_.size : it->offset;
+}
+
+} // namespace logstory::io
@@ -24,6 +24,90 @@ void JSONWriter::write(const Report& report, std::ostream& out) {
     out << "  \"error_count\": " << report.error_count << ",\n";
     out << "  \"warning_count\": " << report.warning_count << ",\n";
     
+    // Distinct tag values
+    if (!report.tag_cardinality.empty()) {
+        out << "  \"tag_cardinality\": [\n";
+        for (size_t i = 0; i < report.tag_cardinality.size(); i++) {
+            const auto& card = report.tag_cardinality[i];
+            out << "    {\n";
+            out << "      \"key\": "; write_string(out, card.key); out << ",\n";
+            out << "      \"distinct\": " << card.distinct << ",\n";
+            out << "      \"exact\": " << (card.exact ? "true" : "false") << ",\n";
+            out << "      \"by_severity\": {";
+            size_t j = 0;
+            for (const auto& [sev, count] : card.by_severity) {
+                if (j++ > 0) out << ", ";
+                write_string(out, core::to_string(sev)); out << ": " << count;
+            }
+            out << "}\n";
+            out << "    }";
+            if (i < report.tag_cardinality.size() - 1) out << ",";
+            out << "\n";
+        }
+        out << "  ],\n";
+    }
+    
+    // Numeric tag quantiles
+    if (!report.numeric_tags.empty()) {
+        out << "  \"numeric_tags\": [\n";
+        for (size_t i = 0; i < report.numeric_tags.size(); i++) {
+            const auto& num = report.numeric_tags[i];
+            out << "    {\n";
+            out << "      \"key\": "; write_string(out, num.key); out << ",\n";
+            out << "      \"count\": " << num.count << ",\n";
+            out << "      \"min\": " << num.min << ",\n";
+            out << "      \"max\": " << num.max << ",\n";
+            out << "      \"p50\": " << num.p50 << ",\n";
+            out << "      \"p95\": " << num.p95 << ",\n";
+            out << "      \"p99\": " << num.p99 << ",\n";
+            out << "      \"p95_changes\": [";
+            for (size_t j = 0; j < num.p95_changes.size(); j++) {
+                const auto& change = num.p95_changes[j];
+                if (j > 0) out << ", ";
+                out << "{\"bucket\": "; write_timestamp(out, change.bucket);
+                out << ", \"before\": " << change.before << ", \"after\": " << change.after << "}";
+            }
+            out << "]\n";
+            out << "    }";
+            if (i < report.numeric_tags.size() - 1) out << ",";
+            out << "\n";
+        }
+        out << "  ],\n";
+    }
+    
+    // Partitions by error rate
+    if (!report.partition_dimension.empty()) {
+        out << "  \"partitions\": {\n";
+        out << "    \"dimension\": "; write_string(out, report.partition_dimension); out << ",\n";
+        out << "    \"top_by_error_rate\": [\n";
+        for (size_t i = 0; i < report.top_partitions.size(); i++) {
+            const auto& part = report.top_partitions[i];
+            out << "      {\"key\": "; write_string(out, part.key);
+            out << ", \"events\": " << part.events << ", \"errors\": " << part.errors
+                << ", \"warnings\": " << part.warnings << ", \"error_rate\": " << part.error_rate << "}";
+            if (i < report.top_partitions.size() - 1) out << ",";
+            out << "\n";
+        }
+        out << "    ]\n";
+        out << "  },\n";
+    }
+    
+    // Estimated clock offsets
+    if (!report.clock_offsets.empty()) {
+        out << "  \"clock_offsets\": [\n";
+        for (size_t i = 0; i < report.clock_offsets.size(); i++) {
+            const auto& entry = report.clock_offsets[i];
+            out << "    {\"source\": "; write_string(out, entry.source);
+            out << ", \"offset_ms\": " << entry.offset.count()
+                << ", \"shared_ids\": " << entry.shared_ids
+                << ", \"reference\": " << (entry.reference ? "true" : "false")
+                << ", \"applied\": " << (entry.applied ? "true" : "false") << "}";
+            if (i < report.clock_offsets.size() - 1) out << ",";
+            out << "\n";
+        }
+        out << "  ],\n";
+    }
+    
     // Summary
     out << "  \"summary\": [\n";
     for (size_t i = 0; i < report.summary.size(); i++) {
@@ -50,6 +50,58 @@ void MarkdownWriter::write_summary(const Report& report, std::ostream& out) {
     out << "- **Warnings:** " << report.warning_count << "\n";
     out << "- **Findings:** " << report.findings.size() << "\n";
     
+    if (!report.top_partitions.empty()) {
+        out << "\n### Top Partitions by Error Rate\n\n";
+        out << "| " << escape_markdown(report.partition_dimension)
+            << " | Events | Errors | Warnings | Error Rate |\n";
+        out << "|------|--------|--------|----------|------------|\n";
+        for (const auto& part : report.top_partitions) {
+            std::ostringstream rate;
+            rate << std::fixed << std::setprecision(1) << part.error_rate * 100.0 << "%";
+            out << "| " << escape_markdown(part.key) << " | " << part.events
+                << " | " << part.errors << " | " << part.warnings << " | "
+                << rate.str() << " |\n";
+        }
+    }
+    
+    if (!report.clock_offsets.empty()) {
+        out << "\n### Clock Offsets\n\n";
+        out << "_Offsets are measured from requests seen by several sources, so they include "
+            << "request latency as well as clock skew._\n\n";
+        out << "| Source | Offset | Shared IDs | Status |\n";
+        out << "|--------|--------|------------|--------|\n";
+        for (const auto& entry : report.clock_offsets) {
+            std::ostringstream offset;
+            offset << (entry.offset.count() > 0 ? "+" : "") << std::fixed << std::setprecision(3)
+                   << static_cast<double>(entry.offset.count()) / 1000.0 << "s";
+            out << "| " << escape_markdown(entry.source) << " | " << offset.str()
+                << " | " << entry.shared_ids << " | "
+                << (entry.reference ? "reference" : entry.applied ? "corrected" : "within tolerance")
+                << " |\n";
+        }
+    }
+    
+    if (!report.numeric_tags.empty()) {
+        out << "\n### Numeric Fields\n\n";
+        out << "| Field | Count | p50 | p95 | p99 | Max | p95 Changes |\n";
+        out << "|-------|-------|-----|-----|-----|-----|-------------|\n";
+        for (const auto& num : report.numeric_tags) {
+            out << "| " << escape_markdown(num.key) << " | " << num.count
+                << " | " << num.p50 << " | " << num.p95 << " | " << num.p99
+                << " | " << num.max << " | ";
+            if (num.p95_changes.empty()) {
+                out << "-";
+            }
+            for (size_t i = 0; i < num.p95_changes.size(); i++) {
+                const auto& change = num.p95_changes[i];
+                if (i > 0) out << "; ";
+                out << format_timestamp(change.bucket) << ": "
+                    << change.before << " -> " << change.after;
+            }
+            out << " |\n";
+        }
+    }
+    
     out << "\n---\n\n";
 }
 
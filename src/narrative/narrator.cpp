@@ -1,5 +1,8 @@
 #include "logstory/narrative/narrator.hpp"
 #include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
 #include <sstream>
 #include <iomanip>
 #include <ctime>
@@ -10,10 +13,11 @@ namespace logstory::narrative {
 Narrator::Narrator(const NarratorConfig& config) : config_(config) {}
 
 Report Narrator::generate(
-    const std::vector<core::Event>& events,
+    const analysis::EventView& events,
     const analysis::Stats& stats,
     const std::vector<analysis::Episode>& episodes,
-    const std::vector<rules::Finding>& findings) {
+    const std::vector<rules::Finding>& findings,
+    const analysis::EventLookup* lookup) {
     
     Report report;
     
@@ -23,6 +27,20 @@ Report Narrator::generate(
     report.total_events = stats.total_events;
     report.error_count = stats.error_count();
     report.warning_count = stats.warn_count();
+    for (const auto& [key, sketch] : stats.tag_cardinality) {
+        TagCardinality card;
+        card.key = key;
+        card.distinct = sketch.estimate();
+        card.exact = sketch.is_exact();
+        for (const auto& [sev, sketches] : stats.severity_tag_cardinality) {
+            if (auto it = sketches.find(key); it != sketches.end()) {
+                card.by_severity[sev] = it->second.estimate();
+            }
+        }
+        report.tag_cardinality.push_back(std::move(card));
+    }
+    generate_numeric_tags(report, stats);
+    generate_partitions(report, stats);
     
     // Copy findings (sorted by severity)
     report.findings = findings;
@@ -33,12 +51,91 @@ Report Narrator::generate(
     
     // Generate sections
     generate_summary(report, stats, findings);
-    generate_timeline(report, events, episodes, findings);
-    generate_evidence(report, events, findings);
+    generate_timeline(report, events, stats, episodes, findings);
+    if (lookup) {
+        generate_evidence(report, *lookup, findings);
+    } else {
+        generate_evidence(report, analysis::EventLookup(events), findings);
+    }
     
     return report;
 }
 
+void Narrator::describe_clock_skew(Report& report,
+                                   const analysis::ClockSkewEstimate& estimate) const {
+    report.clock_offsets = estimate.offsets;
+    
+    const analysis::SourceOffset* largest = nullptr;
+    for (const auto& entry : estimate.offsets) {
+        if (entry.applied && (!largest || std::chrono::abs(entry.offset) > std::chrono::abs(largest->offset))) {
+            largest = &entry;
+        }
+    }
+    if (!largest) {
+        return;
+    }
+    
+    std::ostringstream oss;
+    oss << "Corrected clock skew in " << estimate.applied_count() << " source(s) using "
+        << estimate.joined_ids << " shared request/trace IDs (largest: " << largest->source << " "
+        << (largest->offset.count() > 0 ? "+" : "") << std::fixed << std::setprecision(1)
+        << static_cast<double>(largest->offset.count()) / 1000.0 << "s)";
+    report.summary.emplace_back(oss.str());
+}
+
+void Narrator::generate_numeric_tags(Report& report, const analysis::Stats& stats) {
+    for (const auto& [key, numeric] : stats.numeric_tags) {
+        NumericTagSummary summary;
+        summary.key = key;
+        summary.count = numeric.overall.count();
+        summary.min = numeric.overall.min();
+        summary.max = numeric.overall.max();
+        summary.p50 = numeric.overall.quantile(0.50);
+        summary.p95 = numeric.overall.quantile(0.95);
+        summary.p99 = numeric.overall.quantile(0.99);
+        
+        // Keep the largest shifts, then restore time order
+        auto changes = numeric.changes(0.95, config_.quantile_change_factor,
+                                       config_.quantile_change_min_samples);
+        auto ratio = [](const analysis::QuantileChange& c) {
+            double lo = std::min(std::abs(c.before), std::abs(c.after));
+            double hi = std::max(std::abs(c.before), std::abs(c.after));
+            return lo > 0.0 ? hi / lo : std::numeric_limits<double>::infinity();
+        };
+        if (changes.size() > config_.max_quantile_changes) {
+            std::stable_sort(changes.begin(), changes.end(),
+                [&ratio](const auto& a, const auto& b) { return ratio(a) > ratio(b); });
+            changes.resize(config_.max_quantile_changes);
+            std::sort(changes.begin(), changes.end(),
+                [](const auto& a, const auto& b) { return a.bucket < b.bucket; });
+        }
+        summary.p95_changes = std::move(changes);
+        
+        report.numeric_tags.push_back(std::move(summary));
+    }
+}
+
+void Narrator::generate_partitions(Report& report, const analysis::Stats& stats) {
+    const auto& partitioned = stats.partitions;
+    if (partitioned.empty()) {
+        return;
+    }
+    
+    report.partition_dimension = partitioned.dimension;
+    auto keys = partitioned.top_by_error_rate(config_.max_partitions_reported,
+                                              config_.partition_min_events);
+    for (const auto& key : keys) {
+        const auto& partition = partitioned.partitions.at(key);
+        PartitionSummary summary;
+        summary.key = partitioned.label(key);
+        summary.events = partition.total_events;
+        summary.errors = partition.count(core::Severity::ERROR);
+        summary.warnings = partition.count(core::Severity::WARN);
+        summary.error_rate = partition.error_rate();
+        report.top_partitions.push_back(std::move(summary));
+    }
+}
+
 void Narrator::generate_summary(Report& report, const analysis::Stats& stats,
                                 const std::vector<rules::Finding>& findings) {
     
@@ -98,9 +195,20 @@ void Narrator::generate_summary(Report& report, const analysis::Stats& stats,
         oss << "Processed " << stats.source_counts.size() << " source file(s)";
         report.summary.emplace_back(oss.str());
     }
+    
+    // Worst partition, when more than one is compared
+    if (report.top_partitions.size() > 1 && report.top_partitions[0].errors > 0) {
+        const auto& worst = report.top_partitions[0];
+        oss.str("");
+        oss << "Highest error rate by " << report.partition_dimension << ": " << worst.key
+            << " (" << std::fixed << std::setprecision(1) << worst.error_rate * 100.0
+            << "% of " << worst.events << " events)";
+        report.summary.emplace_back(oss.str());
+    }
 }
 
-void Narrator::generate_timeline(Report& report, const std::vector<core::Event>& events,
+void Narrator::generate_timeline(Report& report, const analysis::EventView& events,
+                                 const analysis::Stats& stats,
                                  const std::vector<analysis::Episode>& episodes,
                                  const std::vector<rules::Finding>& findings) {
     
@@ -119,15 +227,30 @@ void Narrator::generate_timeline(Report& report, const std::vector<core::Event>&
         }
     }
     
-    // Add error events
-    for (const auto& event : events) {
-        if (event.sev == core::Severity::ERROR && event.ts.has_value()) {
-            TimelineHighlight hl;
-            hl.timestamp = event.ts->tp;
-            hl.description = truncate_text(event.message, 100);
-            hl.severity = event.sev;
-            hl.event_id = event.id;
-            highlights.push_back(hl);
+    // Add error events while they fit the highlights left; otherwise one
+    // highlight per bucket of the error series, at the finest rollup that
+    // covers the whole input in that many buckets, so a long input isn't
+    // summarized by its first few errors
+    size_t budget = config_.max_timeline_highlights > highlights.size()
+                        ? config_.max_timeline_highlights - highlights.size() : 0;
+    size_t error_events = static_cast<size_t>(std::count_if(events.begin(), events.end(),
+        [](const core::Event& event) {
+            return event.sev == core::Severity::ERROR && event.ts.has_value();
+        }));
+    const analysis::TimeSeries* error_series =
+        stats.series_for_span(core::Severity::ERROR, std::max<size_t>(1, budget));
+    if (error_events > budget && error_series != nullptr && !error_series->points.empty()) {
+        add_error_buckets(highlights, events, *error_series, budget);
+    } else {
+        for (const auto& event : events) {
+            if (event.sev == core::Severity::ERROR && event.ts.has_value()) {
+                TimelineHighlight hl;
+                hl.timestamp = event.ts->tp;
+                hl.description = truncate_text(event.message, 100);
+                hl.severity = event.sev;
+                hl.event_id = event.id;
+                highlights.push_back(hl);
+            }
         }
     }
     
@@ -145,7 +268,60 @@ void Narrator::generate_timeline(Report& report, const std::vector<core::Event>&
     report.timeline = highlights;
 }
 
-void Narrator::generate_evidence(Report& report, const std::vector<core::Event>& events,
+void Narrator::add_error_buckets(std::vector<TimelineHighlight>& highlights,
+                                 const analysis::EventView& events,
+                                 const analysis::TimeSeries& error_series, size_t budget) const {
+    // The busiest buckets if even the coarsest level has too many
+    std::vector<const analysis::TimeSeriesPoint*> buckets;
+    buckets.reserve(error_series.points.size());
+    for (const auto& point : error_series.points) {
+        buckets.push_back(&point);
+    }
+    if (buckets.size() > budget) {
+        std::stable_sort(buckets.begin(), buckets.end(), [](const auto* a, const auto* b) {
+            return a->count > b->count;
+        });
+        buckets.resize(budget);
+    }
+    
+    // First error event of each kept bucket, as its message and evidence ID
+    auto width = std::chrono::duration_cast<std::chrono::system_clock::duration>(error_series.bucket_size);
+    std::map<std::chrono::system_clock::time_point, const core::Event*> first_error;
+    for (const auto* bucket : buckets) {
+        first_error.emplace(bucket->timestamp, nullptr);
+    }
+    for (const auto& event : events) {
+        if (event.sev != core::Severity::ERROR || !event.ts.has_value()) {
+            continue;
+        }
+        auto offset = event.ts->tp.time_since_epoch() % width;
+        if (offset.count() < 0) {
+            offset += width;
+        }
+        auto it = first_error.find(event.ts->tp - offset);
+        if (it != first_error.end() && (it->second == nullptr || event.ts->tp < it->second->ts->tp)) {
+            it->second = &event;
+        }
+    }
+    
+    auto minutes = error_series.bucket_size.count();
+    std::string span = minutes % 60 == 0 ? std::to_string(minutes / 60) + "h"
+                                         : std::to_string(minutes) + "m";
+    for (const auto* bucket : buckets) {
+        const core::Event* first = first_error[bucket->timestamp];
+        TimelineHighlight hl;
+        hl.timestamp = bucket->timestamp;
+        hl.description = std::to_string(bucket->count) + " errors in " + span;
+        if (first != nullptr) {
+            hl.description += ", first: " + truncate_text(first->message, 80);
+            hl.event_id = first->id;
+        }
+        hl.severity = core::Severity::ERROR;
+        highlights.push_back(hl);
+    }
+}
+
+void Narrator::generate_evidence(Report& report, const analysis::EventLookup& lookup,
                                  const std::vector<rules::Finding>& findings) {
     
     std::set<core::EventId> added_ids;
@@ -157,7 +333,7 @@ void Narrator::generate_evidence(Report& report, const std::vector<core::Event>&
                 continue;
             }
             
-            const core::Event* event = find_event_by_id(events, ev.event_id);
+            const core::Event* event = lookup.find(ev.event_id);
             if (!event) continue;
             
             EvidenceExcerpt excerpt;
@@ -235,16 +411,6 @@ std::string Narrator::truncate_text(const std::string& text, size_t max_len) con
     return text.substr(0, max_len - 3) + "...";
 }
 
-const core::Event* Narrator::find_event_by_id(const std::vector<core::Event>& events,
-                                               core::EventId id) const {
-    for (const auto& event : events) {
-        if (event.id == id) {
-            return &event;
-        }
-    }
-    return nullptr;
-}
-
 bool Report::has_critical_findings() const {
     for (const auto& finding : findings) {
         if (finding.severity == rules::FindingSeverity::CRITICAL) {
@@ -2,18 +2,43 @@
 
 namespace logstory::parsing {
 
+bool EventFilter::accepts_time(const std::optional<core::Timestamp>& ts) const {
+    if (!start.has_value() && !end.has_value()) {
+        return true;
+    }
+    if (!ts.has_value()) {
+        return false;
+    }
+    if (start.has_value() && ts->tp < *start) {
+        return false;
+    }
+    if (end.has_value() && ts->tp > *end) {
+        return false;
+    }
+    return true;
+}
+
 core::Event EventParser::parse(const io::Record& record) {
+    // Try to parse timestamp
+    auto ts = ts_detector_.detect(record.text);
+    
+    // Detect severity
+    auto sev = sev_detector_.detect(record.text);
+    
+    return build_event(record, std::move(ts), sev);
+}
+
+core::Event EventParser::build_event(const io::Record& record,
+                                     std::optional<core::Timestamp> ts,
+                                     core::Severity sev) {
     // Create event with ID and source reference
     core::Event event(next_id_++, record.src);
     
     // Store raw text
     event.raw = record.text;
     
-    // Try to parse timestamp
-    event.ts = ts_detector_.detect(record.text);
-    
-    // Detect severity
-    event.sev = sev_detector_.detect(record.text);
+    event.ts = std::move(ts);
+    event.sev = sev;
     
     // Extract key-value pairs into tags
     kv_extractor_.extract(record.text, event.tags);
@@ -26,10 +51,29 @@ core::Event EventParser::parse(const io::Record& record) {
 
 std::vector<core::Event> EventParser::parse_all(const std::vector<io::Record>& records) {
     std::vector<core::Event> events;
-    events.reserve(records.size());
+    
+    if (!filter_.is_active()) {
+        events.reserve(records.size());
+        for (const auto& record : records) {
+            events.push_back(parse(record));
+        }
+        return events;
+    }
     
     for (const auto& record : records) {
-        events.push_back(parse(record));
+        auto ts = ts_detector_.detect(record.text);
+        if (!filter_.accepts_time(ts)) {
+            filtered_count_++;
+            continue;
+        }
+        
+        auto sev = sev_detector_.detect(record.text);
+        if (sev < filter_.min_severity) {
+            filtered_count_++;
+            continue;
+        }
+        
+        events.push_back(build_event(record, std::move(ts), sev));
     }
     
     return events;
@@ -1,13 +1,15 @@
 #include "logstory/parsing/kv_extractor.hpp"
+#include "logstory/core/text_search.hpp"
 #include <regex>
 #include <algorithm>
+#include <string_view>
 
 namespace logstory::parsing {
 
 void KVExtractor::extract(const std::string& text, core::TagMap& tags) {
     // Match key=value patterns (conservative to avoid false positives)
     // Matches: key=value, key="value", key='value'
-    std::regex kv_regex(R"((\w+)\s*=\s*(?:\"([^\"]*)\"|'([^']*)'|([^\s,;]+)))");
+    static const std::regex kv_regex(R"((\w+)\s*=\s*(?:\"([^\"]*)\"|'([^']*)'|([^\s,;]+)))");
     
     auto begin = std::sregex_iterator(text.begin(), text.end(), kv_regex);
     auto end = std::sregex_iterator();
@@ -35,16 +37,13 @@ void KVExtractor::extract(const std::string& text, core::TagMap& tags) {
         }
         
         // Skip common non-metadata patterns (too generic)
-        static const std::vector<std::string> skip_keys = {
+        static const std::string_view skip_keys[] = {
             "at", "in", "of", "to", "for", "the"
         };
-        std::string lower_key = key;
-        std::transform(lower_key.begin(), lower_key.end(), lower_key.begin(),
-                      [](unsigned char c) { return std::tolower(c); });
         
         bool should_skip = false;
-        for (const auto& skip : skip_keys) {
-            if (lower_key == skip) {
+        for (std::string_view skip : skip_keys) {
+            if (core::equals_ignore_case(key, skip)) {
                 should_skip = true;
                 break;
             }
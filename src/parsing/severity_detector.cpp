@@ -1,6 +1,8 @@
 #include "logstory/parsing/severity_detector.hpp"
+#include "logstory/core/text_search.hpp"
+#include <initializer_list>
 #include <regex>
-#include <algorithm>
+#include <string_view>
 
 namespace logstory::parsing {
 
@@ -23,23 +25,23 @@ core::Severity SeverityDetector::detect(const std::string& text) {
 
 core::Severity SeverityDetector::try_explicit_markers(const std::string& text) {
     // Try common bracket formats: [ERROR], [WARN], etc.
-    std::regex bracket_regex(R"(\[(TRACE|DEBUG|INFO|WARN|WARNING|ERROR|ERR|FATAL|CRITICAL|SEVERE)\])",
-                            std::regex_constants::icase);
+    static const std::regex bracket_regex(R"(\[(TRACE|DEBUG|INFO|WARN|WARNING|ERROR|ERR|FATAL|CRITICAL|SEVERE)\])",
+                                         std::regex_constants::icase);
     std::smatch match;
     if (std::regex_search(text, match, bracket_regex)) {
         return core::severity_from_string(match[1].str());
     }
     
     // Try space-separated at start: "ERROR: message" or "ERROR message"
-    std::regex start_regex(R"(^\s*(TRACE|DEBUG|INFO|WARN|WARNING|ERROR|ERR|FATAL|CRITICAL|SEVERE)[\s:])",
-                          std::regex_constants::icase);
+    static const std::regex start_regex(R"(^\s*(TRACE|DEBUG|INFO|WARN|WARNING|ERROR|ERR|FATAL|CRITICAL|SEVERE)[\s:])",
+                                       std::regex_constants::icase);
     if (std::regex_search(text, match, start_regex)) {
         return core::severity_from_string(match[1].str());
     }
     
     // Try JSON-like field: "level":"error", "severity":"warn"
-    std::regex json_regex(R"(["'](?:level|severity)["']\s*:\s*["'](TRACE|DEBUG|INFO|WARN|WARNING|ERROR|ERR|FATAL|CRITICAL)["'])",
-                         std::regex_constants::icase);
+    static const std::regex json_regex(R"(["'](?:level|severity)["']\s*:\s*["'](TRACE|DEBUG|INFO|WARN|WARNING|ERROR|ERR|FATAL|CRITICAL)["'])",
+                                      std::regex_constants::icase);
     if (std::regex_search(text, match, json_regex)) {
         return core::severity_from_string(match[1].str());
     }
@@ -49,8 +51,8 @@ core::Severity SeverityDetector::try_explicit_markers(const std::string& text) {
 
 core::Severity SeverityDetector::try_kv_patterns(const std::string& text) {
     // Match key=value patterns: level=error, severity=warn, etc.
-    std::regex kv_regex(R"(\b(level|severity|log_level|loglevel)\s*=\s*(\w+)\b)",
-                       std::regex_constants::icase);
+    static const std::regex kv_regex(R"(\b(level|severity|log_level|loglevel)\s*=\s*(\w+)\b)",
+                                    std::regex_constants::icase);
     
     std::smatch match;
     if (std::regex_search(text, match, kv_regex)) {
@@ -65,51 +67,38 @@ core::Severity SeverityDetector::try_kv_patterns(const std::string& text) {
 }
 
 core::Severity SeverityDetector::try_keyword_scoring(const std::string& text) {
-    // Convert to lowercase for case-insensitive matching
-    std::string lower_text = text;
-    std::transform(lower_text.begin(), lower_text.end(), lower_text.begin(),
-                   [](unsigned char c) { return std::tolower(c); });
+    // Keywords are lowercase; the search folds the text in place, no copy
+    auto contains_any = [&text](std::initializer_list<std::string_view> keywords) {
+        for (std::string_view keyword : keywords) {
+            if (core::contains_ignore_case(text, keyword)) {
+                return true;
+            }
+        }
+        return false;
+    };
     
     // Check for strong error indicators
-    static const std::vector<std::string> fatal_keywords = {
-        "fatal", "critical", "panic", "abort"
-    };
-    for (const auto& keyword : fatal_keywords) {
-        if (lower_text.find(keyword) != std::string::npos) {
-            return core::Severity::FATAL;
-        }
+    if (contains_any({"fatal", "critical", "panic", "abort"})) {
+        return core::Severity::FATAL;
     }
     
     // Check for error keywords
-    static const std::vector<std::string> error_keywords = {
-        "error", "exception", "failed", "failure", "err:"
-    };
-    for (const auto& keyword : error_keywords) {
-        if (lower_text.find(keyword) != std::string::npos) {
-            return core::Severity::ERROR;
-        }
+    if (contains_any({"error", "exception", "failed", "failure", "err:"})) {
+        return core::Severity::ERROR;
     }
     
-    // Check for warning keywords
-    static const std::vector<std::string> warn_keywords = {
-        "warn", "warning", "deprecated"
-    };
-    for (const auto& keyword : warn_keywords) {
-        if (lower_text.find(keyword) != std::string::npos) {
-            return core::Severity::WARN;
-        }
+    // Check for warning keywords ("warning" is covered by "warn")
+    if (contains_any({"warn", "deprecated"})) {
+        return core::Severity::WARN;
     }
     
     // Check for debug keywords  
-    if (lower_text.find("debug") != std::string::npos ||
-        lower_text.find("trace") != std::string::npos) {
+    if (contains_any({"debug", "trace"})) {
         return core::Severity::DEBUG;
     }
     
     // Default to INFO if we see common info indicators
-    if (lower_text.find("info") != std::string::npos ||
-        lower_text.find("start") != std::string::npos ||
-        lower_text.find("complete") != std::string::npos) {
+    if (contains_any({"info", "start", "complete"})) {
         return core::Severity::INFO;
     }
     
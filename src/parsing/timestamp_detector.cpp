@@ -35,7 +35,8 @@ std::optional<core::Timestamp> TimestampDetector::detect(const std::string& text
 
 std::optional<core::Timestamp> TimestampDetector::try_iso8601(const std::string& text) {
     // Match ISO 8601 patterns: YYYY-MM-DD, YYYY-MM-DDTHH:MM:SS, etc.
-    std::regex iso_regex(
+    // Patterns are compiled once; detect() runs for every line read
+    static const std::regex iso_regex(
         R"((\d{4})-(\d{2})-(\d{2})(?:[T ](\d{2}):(\d{2}):(\d{2})(?:\.(\d+))?(?:Z|([+-]\d{2}):?(\d{2}))?)?)"
     );
     
@@ -78,7 +79,7 @@ std::optional<core::Timestamp> TimestampDetector::try_iso8601(const std::string&
 
 std::optional<core::Timestamp> TimestampDetector::try_common_patterns(const std::string& text) {
     // Match common patterns: YYYY/MM/DD HH:MM:SS, YYYY-MM-DD HH:MM:SS
-    std::regex pattern_regex(
+    static const std::regex pattern_regex(
         R"((\d{4})[-/](\d{2})[-/](\d{2})\s+(\d{2}):(\d{2}):(\d{2})(?:\.(\d+))?)"
     );
     
@@ -118,7 +119,7 @@ std::optional<core::Timestamp> TimestampDetector::try_common_patterns(const std:
 
 std::optional<core::Timestamp> TimestampDetector::try_syslog(const std::string& text) {
     // Match syslog format: Mon DD HH:MM:SS
-    std::regex syslog_regex(
+    static const std::regex syslog_regex(
         R"((Jan|Feb|Mar|Apr|May|Jun|Jul|Aug|Sep|Oct|Nov|Dec)\s+(\d{1,2})\s+(\d{2}):(\d{2}):(\d{2}))"
     );
     
@@ -160,7 +161,7 @@ std::optional<core::Timestamp> TimestampDetector::try_syslog(const std::string&
 
 std::optional<core::Timestamp> TimestampDetector::try_epoch(const std::string& text) {
     // Look for epoch timestamps (10 or 13 digits)
-    std::regex epoch_regex(R"(\b(1[0-9]{9}|1[0-9]{12})\b)");
+    static const std::regex epoch_regex(R"(\b(1[0-9]{9}|1[0-9]{12})\b)");
     
     std::smatch match;
     if (!std::regex_search(text, match, epoch_regex)) {
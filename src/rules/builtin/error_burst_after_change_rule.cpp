@@ -1,6 +1,6 @@
 #include "logstory/rules/builtin/error_burst_after_change_rule.hpp"
+#include "logstory/core/text_search.hpp"
 #include <algorithm>
-#include <cctype>
 
 namespace logstory::rules::builtin {
 
@@ -14,7 +14,14 @@ std::vector<Finding> ErrorBurstAfterChangeRule::evaluate(const RuleContext& cont
     const auto& events = *context.events;
     
     // Find all change events
-    std::vector<size_t> change_indices = find_change_events(events);
+    const auto& change_keywords = analysis::default_keywords(analysis::Feature::CHANGE);
+    std::vector<size_t> change_indices;
+    if (context.features && context.features->size() == events.size() &&
+        context.features->matches_keywords(analysis::Feature::CHANGE, change_keywords)) {
+        change_indices = context.features->positions(analysis::Feature::CHANGE);
+    } else {
+        change_indices = find_change_events(events);
+    }
     
     if (change_indices.empty()) {
         return findings;
@@ -64,6 +71,9 @@ std::vector<Finding> ErrorBurstAfterChangeRule::evaluate(const RuleContext& cont
             finding.title = "Error Burst Following Deployment/Config Change";
             finding.summary = "Error spike detected " + std::to_string(min_gap.count()) + 
                              " seconds after a deployment or configuration change";
+            if (!anomaly.source.empty()) {
+                finding.summary += " (in " + anomaly.source + ")";
+            }
             finding.severity = FindingSeverity::HIGH;
             
             // Higher confidence for shorter gaps
@@ -76,17 +86,27 @@ std::vector<Finding> ErrorBurstAfterChangeRule::evaluate(const RuleContext& cont
             // Add evidence
             finding.add_evidence(events[*nearest_change_idx].id, "Deployment or config change");
             
-            // Add some error events from the burst (limit to first 5)
+            // Add some error events from the burst (limit to first 5): the
+            // detector's own evidence when it can be resolved, else a scan
             size_t error_count = 0;
-            for (const auto& event : events) {
+            if (context.lookup) {
+                for (auto id : anomaly.evidence_ids) {
+                    const core::Event* event = context.lookup->find(id);
+                    if (event && event->sev == core::Severity::ERROR) {
+                        finding.add_evidence(id, "Error during burst");
+                        if (++error_count >= 5) break;
+                    }
+                }
+            }
+            for (size_t i = 0; error_count == 0 && i < events.size(); i++) {
+                const auto& event = events[i];
                 if (event.sev == core::Severity::ERROR && 
                     event.ts.has_value() &&
                     event.ts->tp >= burst_time &&
                     event.ts->tp <= *anomaly.end_time) {
                     
                     finding.add_evidence(event.id, "Error during burst");
-                    error_count++;
-                    if (error_count >= 5) break;
+                    if (++error_count >= 5) break;
                 }
             }
             
@@ -98,22 +118,16 @@ std::vector<Finding> ErrorBurstAfterChangeRule::evaluate(const RuleContext& cont
 }
 
 bool ErrorBurstAfterChangeRule::is_change_event(const core::Event& event) const {
-    std::string lower_msg = event.message;
-    std::transform(lower_msg.begin(), lower_msg.end(), lower_msg.begin(),
-        [](unsigned char c) { return std::tolower(c); });
-    
-    return lower_msg.find("deploy") != std::string::npos ||
-           lower_msg.find("deployment") != std::string::npos ||
-           lower_msg.find("config") != std::string::npos ||
-           lower_msg.find("configuration") != std::string::npos ||
-           lower_msg.find("release") != std::string::npos ||
-           lower_msg.find("rollout") != std::string::npos ||
-           lower_msg.find("upgrade") != std::string::npos ||
-           lower_msg.find("migration") != std::string::npos;
+    for (const auto& keyword : analysis::default_keywords(analysis::Feature::CHANGE)) {
+        if (core::contains_ignore_case(event.message, keyword)) {
+            return true;
+        }
+    }
+    return false;
 }
 
 std::vector<size_t> ErrorBurstAfterChangeRule::find_change_events(
-    const std::vector<core::Event>& events) const {
+    const analysis::EventView& events) const {
     
     std::vector<size_t> indices;
     
@@ -0,0 +1,53 @@
+#include "logstory/rules/builtin/level_shift_rule.hpp"
+
+namespace logstory::rules::builtin {
+
+std::vector<Finding> LevelShiftRule::evaluate(const RuleContext& context) {
+    std::vector<Finding> findings;
+    
+    if (!context.anomalies) {
+        return findings;
+    }
+    
+    // Upward shifts in WARN and worse; drops are left to the silence rule
+    for (const auto& anomaly : *context.anomalies) {
+        if (anomaly.type != analysis::Anomaly::Type::LEVEL_SHIFT ||
+            anomaly.severity < core::Severity::WARN ||
+            anomaly.rate_after <= anomaly.rate_before ||
+            !anomaly.start_time.has_value()) {
+            continue;
+        }
+        
+        bool is_warning = anomaly.severity == core::Severity::WARN;
+        
+        Finding finding;
+        finding.id = "level-shift-" + std::to_string(findings.size() + 1);
+        finding.title = is_warning ? "Sustained Warning Rate Increase" : "Sustained Error Rate Increase";
+        finding.summary = anomaly.description;
+        finding.severity = is_warning ? FindingSeverity::MEDIUM : FindingSeverity::HIGH;
+        finding.confidence = anomaly.confidence;
+        finding.start_time = anomaly.start_time;
+        finding.end_time = anomaly.end_time;
+        
+        // Evidence: the first events at the new level (limit to 5)
+        if (context.events) {
+            size_t count = 0;
+            for (const auto& event : *context.events) {
+                if (event.sev == anomaly.severity &&
+                    event.ts.has_value() &&
+                    event.ts->tp >= *anomaly.start_time &&
+                    (anomaly.source.empty() || event.src.source_path == anomaly.source)) {
+                    
+                    finding.add_evidence(event.id, "Event after the rate change");
+                    if (++count >= 5) break;
+                }
+            }
+        }
+        
+        findings.push_back(finding);
+    }
+    
+    return findings;
+}
+
+} // namespace logstory::rules::builtin
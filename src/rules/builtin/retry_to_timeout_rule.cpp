@@ -1,9 +1,22 @@
 #include "logstory/rules/builtin/retry_to_timeout_rule.hpp"
+#include "logstory/core/text_search.hpp"
 #include <algorithm>
-#include <cctype>
 
 namespace logstory::rules::builtin {
 
+namespace {
+
+bool contains_any(const std::string& message, const std::vector<std::string>& keywords) {
+    for (const auto& keyword : keywords) {
+        if (core::contains_ignore_case(message, keyword)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
 std::vector<Finding> RetryToTimeoutRule::evaluate(const RuleContext& context) {
     std::vector<Finding> findings;
     
@@ -13,9 +26,28 @@ std::vector<Finding> RetryToTimeoutRule::evaluate(const RuleContext& context) {
     
     const auto& events = *context.events;
     
+    // Classify events once, from precomputed features when available
+    const auto& retry_keywords = analysis::default_keywords(analysis::Feature::RETRY);
+    const auto& timeout_keywords = analysis::default_keywords(analysis::Feature::TIMEOUT);
+    std::vector<bool> is_retry(events.size(), false);
+    std::vector<bool> is_timeout(events.size(), false);
+    if (context.features && context.features->size() == events.size() &&
+        context.features->matches_keywords(analysis::Feature::RETRY, retry_keywords) &&
+        context.features->matches_keywords(analysis::Feature::TIMEOUT, timeout_keywords)) {
+        for (size_t i = 0; i < events.size(); i++) {
+            is_retry[i] = context.features->has(i, analysis::Feature::RETRY);
+            is_timeout[i] = context.features->has(i, analysis::Feature::TIMEOUT);
+        }
+    } else {
+        for (size_t i = 0; i < events.size(); i++) {
+            is_retry[i] = is_retry_event(events[i]);
+            is_timeout[i] = is_timeout_event(events[i]);
+        }
+    }
+    
     // Look for retry -> timeout patterns
     for (size_t i = 0; i < events.size(); i++) {
-        if (!is_retry_event(events[i])) {
+        if (!is_retry[i]) {
             continue;
         }
         
@@ -24,13 +56,13 @@ std::vector<Finding> RetryToTimeoutRule::evaluate(const RuleContext& context) {
         retry_ids.push_back(events[i].id);
         
         size_t j = i + 1;
-        while (j < events.size() && is_retry_event(events[j])) {
+        while (j < events.size() && is_retry[j]) {
             retry_ids.push_back(events[j].id);
             j++;
         }
         
         // Check if followed by timeout
-        if (j < events.size() && is_timeout_event(events[j])) {
+        if (j < events.size() && is_timeout[j]) {
             Finding finding;
             finding.id = "retry-timeout-" + std::to_string(findings.size() + 1);
             finding.title = "Retries Leading to Timeout";
@@ -63,22 +95,11 @@ std::vector<Finding> RetryToTimeoutRule::evaluate(const RuleContext& context) {
 }
 
 bool RetryToTimeoutRule::is_retry_event(const core::Event& event) const {
-    std::string lower_msg = event.message;
-    std::transform(lower_msg.begin(), lower_msg.end(), lower_msg.begin(),
-        [](unsigned char c) { return std::tolower(c); });
-    
-    return lower_msg.find("retry") != std::string::npos ||
-           lower_msg.find("retrying") != std::string::npos ||
-           lower_msg.find("attempt") != std::string::npos;
+    return contains_any(event.message, analysis::default_keywords(analysis::Feature::RETRY));
 }
 
 bool RetryToTimeoutRule::is_timeout_event(const core::Event& event) const {
-    std::string lower_msg = event.message;
-    std::transform(lower_msg.begin(), lower_msg.end(), lower_msg.begin(),
-        [](unsigned char c) { return std::tolower(c); });
-    
-    return lower_msg.find("timeout") != std::string::npos ||
-           lower_msg.find("timed out") != std::string::npos;
+    return contains_any(event.message, analysis::default_keywords(analysis::Feature::TIMEOUT));
 }
 
 } // namespace logstory::rules::builtin
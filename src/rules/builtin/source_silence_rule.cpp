@@ -0,0 +1,38 @@
+#include "logstory/rules/builtin/source_silence_rule.hpp"
+
+namespace logstory::rules::builtin {
+
+std::vector<Finding> SourceSilenceRule::evaluate(const RuleContext& context) {
+    std::vector<Finding> findings;
+    
+    if (!context.anomalies) {
+        return findings;
+    }
+    
+    // Look for missing heartbeat anomalies
+    for (const auto& anomaly : *context.anomalies) {
+        if (anomaly.type == analysis::Anomaly::Type::MISSING_HEARTBEAT) {
+            Finding finding;
+            finding.id = "source-silence-" + std::to_string(findings.size() + 1);
+            finding.title = "Source Went Silent";
+            finding.summary = anomaly.description;
+            finding.severity = FindingSeverity::HIGH;
+            finding.confidence = anomaly.confidence;
+            finding.start_time = anomaly.start_time;
+            finding.end_time = anomaly.end_time;
+            
+            // Evidence: the last event before the gap and, if the source
+            // came back, the first one after it
+            for (size_t i = 0; i < anomaly.evidence_ids.size(); ++i) {
+                finding.add_evidence(anomaly.evidence_ids[i],
+                                     i == 0 ? "Last event before silence" : "First event after silence");
+            }
+            
+            findings.push_back(finding);
+        }
+    }
+    
+    return findings;
+}
+
+} // namespace logstory::rules::builtin
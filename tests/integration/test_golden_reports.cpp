@@ -87,7 +87,8 @@ Report run_full_pipeline(const fs::path& log_path) {
     registry.register_rule(std::make_unique<ErrorBurstAfterChangeRule>());
     
     RuleContext ctx;
-    ctx.events = &events;
+    EventView view(events);
+    ctx.events = &view;
     ctx.episodes = &episodes;
     ctx.stats = &stats;
     ctx.anomalies = &anomalies;
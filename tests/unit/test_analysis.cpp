@@ -1,6 +1,17 @@
 #include <catch2/catch_test_macros.hpp>
 #include "logstory/analysis/correlation_extractor.hpp"
+#include "logstory/analysis/clock_skew.hpp"
 #include "logstory/analysis/event_index.hpp"
+#include "logstory/analysis/posting_list.hpp"
+#include "logstory/analysis/text_index.hpp"
+#include "logstory/analysis/query.hpp"
+#include "logstory/analysis/event_lookup.hpp"
+#include "logstory/analysis/event_features.hpp"
+#include "logstory/analysis/event_view.hpp"
+#include "logstory/analysis/window.hpp"
+#include "logstory/analysis/stats_builder.hpp"
+#include "logstory/core/text_search.hpp"
+#include <algorithm>
 
 using namespace logstory::analysis;
 using namespace logstory::core;
@@ -262,6 +273,42 @@ TEST_CASE("EventIndex queries by time range", "[event_index]") {
     REQUIRE(recent.size() >= 1);  // Should include at least the most recent
 }
 
+TEST_CASE("EventIndex answers sub-minute range queries and severity counts", "[event_index]") {
+    EventIndex index;
+    std::vector<Event> events;
+    
+    auto base = std::chrono::system_clock::time_point(std::chrono::hours(24 * 365 * 50));
+    const Severity sevs[] = {Severity::INFO, Severity::ERROR, Severity::ERROR, Severity::WARN, Severity::ERROR};
+    for (int i = 0; i < 5; i++) {
+        Event e;
+        e.id = static_cast<EventId>(i + 1);
+        e.sev = sevs[i];
+        // Out of time order in the store: 0s, 40s, 10s, 20s, 30s
+        int secs = i == 1 ? 40 : (i == 0 ? 0 : (i - 1) * 10);
+        e.ts = Timestamp(base + std::chrono::seconds(secs), 100, false);
+        events.push_back(e);
+    }
+    Event untimed;
+    untimed.id = 6;
+    untimed.sev = Severity::ERROR;
+    events.push_back(untimed);
+    
+    index.build(events);
+    
+    auto mid = index.get_by_time_range(base + std::chrono::seconds(10), base + std::chrono::seconds(30));
+    REQUIRE(mid == std::vector<EventId>{3, 4, 5});
+    REQUIRE(index.get_indices_by_time_range(base + std::chrono::seconds(35), base + std::chrono::minutes(1))
+            == std::vector<size_t>{1});
+    
+    auto t1 = base + std::chrono::nanoseconds(1);
+    auto t2 = base + std::chrono::seconds(40);
+    REQUIRE(index.count_in_time_range(t1, t2) == 4);
+    REQUIRE(index.count_by_severity_in_time_range(Severity::ERROR, t1, t2) == 3);
+    REQUIRE(index.count_by_severity_in_time_range(Severity::ERROR, t1, t2 - std::chrono::nanoseconds(1)) == 2);
+    REQUIRE(index.count_by_severity_in_time_range(Severity::INFO, t1, t2) == 0);
+    REQUIRE(index.count_in_time_range(t2, t1) == 0);
+}
+
 TEST_CASE("EventIndex handles events without timestamps", "[event_index]") {
     EventIndex index;
     std::vector<Event> events;
@@ -293,3 +340,647 @@ TEST_CASE("EventIndex returns empty for non-existent queries", "[event_index]")
     REQUIRE(index.get_by_severity(Severity::FATAL).empty());
     REQUIRE(index.get_by_correlation_id("nonexistent").empty());
 }
+
+TEST_CASE("EventIndex refers to the event store instead of copying it", "[event_index]") {
+    EventIndex index;
+    std::vector<Event> events(3);
+    for (size_t i = 0; i < events.size(); i++) {
+        events[i].id = i + 1;
+        events[i].sev = i == 1 ? Severity::ERROR : Severity::INFO;
+        events[i].tags["request_id"] = "req-1";
+    }
+    
+    index.build(events);
+    
+    REQUIRE(index.get_all_events().store() == &events);
+    
+    auto errors_in_request = PostingList::intersect(index.severity_postings(Severity::ERROR),
+                                                    index.correlation_postings("req-1"));
+    REQUIRE(errors_in_request.decode() == std::vector<EventId>{2});
+    REQUIRE(index.severity_at_least(Severity::INFO).size() == 3);
+    REQUIRE(index.severity_at_least(Severity::WARN).decode() == std::vector<EventId>{2});
+}
+
+TEST_CASE("EventIndex indexes stores with out-of-order IDs", "[event_index]") {
+    EventIndex index;
+    std::vector<Event> events(3);
+    events[0].id = 30;
+    events[1].id = 10;
+    events[2].id = 20;
+    
+    index.build(events);
+    
+    REQUIRE(index.get_by_severity(Severity::UNKNOWN) == std::vector<EventId>{10, 20, 30});
+}
+
+// Posting List Tests
+
+TEST_CASE("PostingList round-trips IDs with delta encoding", "[posting_list]") {
+    std::vector<EventId> ids;
+    for (EventId id = 1; id <= 1000; id += 3) {
+        ids.push_back(id);
+    }
+    ids.push_back(1ULL << 40);
+    
+    auto list = PostingList::from_ids(ids);
+    
+    REQUIRE(list.size() == ids.size());
+    REQUIRE(list.decode() == ids);
+    REQUIRE(list.byte_size() < ids.size() + 8);
+    REQUIRE(list.contains(1ULL << 40));
+    REQUIRE(list.contains(997));
+    REQUIRE_FALSE(list.contains(998));
+    REQUIRE_FALSE(list.append(5));
+}
+
+TEST_CASE("PostingList intersects and unites lists", "[posting_list]") {
+    std::vector<EventId> evens;
+    std::vector<EventId> threes;
+    for (EventId id = 0; id < 3000; id++) {
+        if (id % 2 == 0) evens.push_back(id);
+        if (id % 3 == 0) threes.push_back(id);
+    }
+    auto a = PostingList::from_ids(evens);
+    auto b = PostingList::from_ids(threes);
+    auto sparse = PostingList::from_ids({6, 7, 2994, 2995});
+    
+    auto both = PostingList::intersect(a, b);
+    REQUIRE(both.size() == 500);
+    REQUIRE(both.contains(2994));
+    REQUIRE_FALSE(both.contains(4));
+    
+    REQUIRE(PostingList::unite(a, b).size() == 2000);
+    REQUIRE(PostingList::intersect_all({&a, &b, &sparse}).decode() == std::vector<EventId>{6, 2994});
+    REQUIRE(PostingList::unite_all({&sparse, &sparse}).size() == 4);
+    REQUIRE(PostingList::intersect_all({}).empty());
+}
+
+// Text Index Tests
+
+TEST_CASE("TextIndex finds tokens and case-insensitive substrings", "[text_index]") {
+    std::vector<Event> events(4);
+    const char* messages[] = {
+        "Connection TIMEOUT after 30s",
+        "request timed out",
+        "Deployment v2 started",
+        "ok"
+    };
+    for (size_t i = 0; i < events.size(); i++) {
+        events[i].id = i + 10;
+        events[i].message = messages[i];
+    }
+    
+    TextIndex index;
+    index.build(events);
+    
+    REQUIRE(index.token("timeout").decode() == std::vector<EventId>{10});
+    REQUIRE(index.token("TIME").empty());
+    REQUIRE(index.containing("time").decode() == std::vector<EventId>{10, 11});
+    REQUIRE(index.containing("Timed Out").decode() == std::vector<EventId>{11});
+    REQUIRE(index.containing("ployment v").decode() == std::vector<EventId>{12});
+    REQUIRE(index.containing("OK").decode() == std::vector<EventId>{13});
+    REQUIRE(index.containing("o").size() == 4);
+    REQUIRE(index.containing("missing").empty());
+    REQUIRE(index.positions_containing_any({"deploy", "timed out"}) == std::vector<size_t>{1, 2});
+}
+
+TEST_CASE("TextIndex without n-grams falls back to scanning", "[text_index]") {
+    std::vector<Event> events(2);
+    events[0].id = 1;
+    events[0].message = "Service restarting";
+    events[1].id = 2;
+    events[1].message = "Service started";
+    
+    TextIndexConfig config;
+    config.index_ngrams = false;
+    TextIndex index(config);
+    index.build(events);
+    
+    REQUIRE(index.containing("START").decode() == std::vector<EventId>{1, 2});
+    REQUIRE(index.containing_any({"restart", "started"}).size() == 2);
+}
+
+// Event Feature Tests
+
+TEST_CASE("KeywordAutomaton matches overlapping keywords case-insensitively", "[event_features]") {
+    KeywordAutomaton automaton;
+    automaton.add("he", 1);
+    automaton.add("she", 2);
+    automaton.add("hers", 4);
+    automaton.add("Timed Out", 8);
+    automaton.build();
+    
+    REQUIRE(automaton.scan("USHERS") == (1 | 2 | 4));
+    REQUIRE(automaton.scan("xshex") == (1 | 2));
+    REQUIRE(automaton.scan("request timed OUT") == 8);
+    REQUIRE(automaton.scan("timed in") == 0);
+    REQUIRE(automaton.scan("") == 0);
+    
+    // Unbuilt or empty automata match nothing
+    KeywordAutomaton empty;
+    empty.build();
+    REQUIRE(empty.scan("anything") == 0);
+}
+
+TEST_CASE("EventFeatures agrees with per-keyword scanning", "[event_features]") {
+    const char* messages[] = {
+        "Service restarting after crash",
+        "Deployment v2 rolled out",
+        "RETRYING upstream call",
+        "Request Timed Out",
+        "Retry after config reload timeout",
+        "all good"
+    };
+    std::vector<Event> events(6);
+    for (size_t i = 0; i < events.size(); i++) {
+        events[i].id = i + 1;
+        events[i].message = messages[i];
+    }
+    
+    EventFeatures features;
+    features.build(events);
+    REQUIRE(features.size() == events.size());
+    REQUIRE(features.positions(Feature::RESTART) == std::vector<size_t>{0});
+    REQUIRE(features.positions(Feature::CHANGE) == std::vector<size_t>{1, 4});
+    REQUIRE(features.positions(Feature::RETRY) == std::vector<size_t>{2, 4});
+    REQUIRE(features.positions(Feature::TIMEOUT) == std::vector<size_t>{3, 4});
+    REQUIRE(features.mask(5) == 0);
+    
+    // Same masks on a pool, and the same as testing each keyword separately
+    std::vector<Event> many;
+    for (size_t i = 0; i < 40000; i++) {
+        Event e;
+        e.id = i + 1;
+        e.message = messages[i % 6];
+        many.push_back(e);
+    }
+    ThreadPool pool(4);
+    EventFeatures parallel;
+    parallel.build(many, &pool);
+    
+    EventFeatureConfig config;
+    auto any_of = [](const std::string& message, const std::vector<std::string>& keywords) {
+        for (const auto& keyword : keywords) {
+            if (contains_ignore_case(message, keyword)) {
+                return true;
+            }
+        }
+        return false;
+    };
+    for (size_t i = 0; i < many.size(); i += 997) {
+        REQUIRE(parallel.mask(i) == features.mask(i % 6));
+        REQUIRE(parallel.has(i, Feature::RESTART) == any_of(many[i].message, config.restart_keywords));
+        REQUIRE(parallel.has(i, Feature::CHANGE) == any_of(many[i].message, config.change_keywords));
+    }
+}
+
+// Query Tests
+
+std::vector<Event> make_query_test_events() {
+    auto base = std::chrono::system_clock::time_point(std::chrono::hours(24 * 365 * 50));
+    std::vector<Event> events(6);
+    const Severity sevs[] = {Severity::INFO, Severity::WARN, Severity::ERROR,
+                             Severity::ERROR, Severity::DEBUG, Severity::FATAL};
+    const char* messages[] = {"started", "slow response", "Upstream TIMEOUT",
+                              "db timeout", "tick", "crash"};
+    const char* services[] = {"api", "api", "api", "db", "api", "worker"};
+    for (size_t i = 0; i < events.size(); i++) {
+        events[i].id = i + 1;
+        events[i].sev = sevs[i];
+        events[i].message = messages[i];
+        events[i].tags["service"] = services[i];
+        events[i].ts = Timestamp(base + std::chrono::seconds(10 * i), 100, false);
+        events[i].src.source_path = i < 3 ? "api.log" : "other.log";
+    }
+    events[2].tags["request_id"] = "req-1";
+    events[3].tags["trace_id"] = "req-1";
+    return events;
+}
+
+TEST_CASE("parse_query reports syntax errors", "[query]") {
+    Query query;
+    REQUIRE(parse_query("sev>=WARN and text~timeout", query).ok());
+    REQUIRE(query.root.kind == Query::Node::Kind::AND);
+    REQUIRE(query.root.children.size() == 2);
+    
+    REQUIRE_FALSE(parse_query("sev>=LOUD", query).ok());
+    REQUIRE_FALSE(parse_query("color=red", query).ok());
+    REQUIRE_FALSE(parse_query("(sev=WARN", query).ok());
+    REQUIRE_FALSE(parse_query("text>abc", query).ok());
+    REQUIRE_FALSE(parse_query("text~\"open", query).ok());
+}
+
+TEST_CASE("parse_query rejects malformed ids instead of throwing", "[query]") {
+    Query query;
+    REQUIRE(parse_query("id=18446744073709551615", query).ok());
+    REQUIRE(query.root.predicate.id_value == 18446744073709551615ULL);
+    
+    for (const char* expr : {"id=\"\"", "id=abc", "id=12abc", "id=-1",
+                             "id=18446744073709551616", "id>99999999999999999999999"}) {
+        auto status = parse_query(expr, query);
+        REQUIRE_FALSE(status.ok());
+        REQUIRE(status.code == ErrorCode::INVALID_INPUT);
+        REQUIRE(status.message.find("id") != std::string::npos);
+    }
+}
+
+TEST_CASE("QueryEngine gives the same results with and without indexes", "[query]") {
+    auto events = make_query_test_events();
+    EventIndex index;
+    index.build(events);
+    EventLookup lookup(events);
+    TextIndex text_index;
+    text_index.build(events, &lookup);
+    
+    // The indexed engine and text index share one lookup; the scan builds its own
+    QueryEngine scan(events);
+    QueryEngine indexed(events, &index, &text_index, &lookup);
+    
+    auto check = [&](const std::string& expr, std::vector<size_t> expected) {
+        Query query;
+        REQUIRE(parse_query(expr, query).ok());
+        REQUIRE(scan.select(query) == expected);
+        REQUIRE(indexed.select(query) == expected);
+        for (size_t i = 0; i < events.size(); i++) {
+            bool in = std::find(expected.begin(), expected.end(), i) != expected.end();
+            REQUIRE(query.matches(events[i]) == in);
+        }
+    };
+    
+    check("sev>=WARN and tag.service=api and text~timeout", {2});
+    check("sev>=warn", {1, 2, 3, 5});
+    check("text~TIMEOUT or sev=FATAL", {2, 3, 5});
+    check("text=timeout and not source~api", {3});
+    check("tag.request_id=req-1", {2});
+    check("tag.trace_id = \"req-1\"", {3});
+    check("tag.service!=api", {3, 5});
+    check("id=4 or id=99", {3});
+    check("ts>=1970-01-01T00:00:00Z and sev<INFO", {4});
+    check("NOT (sev=ERROR OR sev=INFO) AND source=api.log", {1});
+    
+    Query query;
+    REQUIRE(parse_query("tag.service=api and sev>=WARN", query).ok());
+    auto plan = indexed.explain(query);
+    REQUIRE(plan.find("sev>=WARN [index]") < plan.find("tag.service=api [scan]"));
+    REQUIRE(indexed.filter(query).size() == 2);
+}
+
+// Event View Tests
+
+TEST_CASE("EventView selects events without copying them", "[event_view]") {
+    auto events = make_query_test_events();
+    
+    EventView all = events;
+    REQUIRE(all.size() == 6);
+    REQUIRE(all.is_full());
+    REQUIRE(&all[5] == &events[5]);
+    
+    auto errors = all.where([](const Event& e) { return e.sev >= Severity::ERROR; });
+    REQUIRE(errors.size() == 3);
+    REQUIRE_FALSE(errors.is_full());
+    REQUIRE(errors.store() == &events);
+    REQUIRE(&errors[0] == &events[2]);
+    REQUIRE(errors.position(2) == 5);
+    
+    // Views narrow further and iterate in store order
+    auto api_errors = errors.where([](const Event& e) { return e.tags.at("service") == "api"; });
+    REQUIRE(api_errors.size() == 1);
+    REQUIRE(&*api_errors.begin() == &events[2]);
+    std::vector<EventId> ids;
+    for (const auto& e : errors) {
+        ids.push_back(e.id);
+    }
+    REQUIRE(ids == std::vector<EventId>{3, 4, 6});
+    REQUIRE(errors.end() - errors.begin() == 3);
+    
+    // Random-access iterators work with the standard algorithms
+    auto first = errors.begin();
+    REQUIRE(1 + first == first + 1);
+    REQUIRE(first + 2 > first);
+    REQUIRE(first <= first);
+    REQUIRE(errors.end() >= first + 3);
+    auto crash = std::partition_point(errors.begin(), errors.end(),
+                                      [](const Event& e) { return e.sev < Severity::FATAL; });
+    REQUIRE(crash - errors.begin() == 2);
+    REQUIRE(std::is_sorted(errors.begin(), errors.end(),
+                           [](const Event& a, const Event& b) { return a.id < b.id; }));
+    
+    auto copies = errors.materialize();
+    REQUIRE(copies.size() == 3);
+    REQUIRE(copies[1].message == "db timeout");
+    
+    REQUIRE(EventView().empty());
+    REQUIRE(EventView().where([](const Event&) { return true; }).empty());
+}
+
+TEST_CASE("EventView compacts its store by moving the selected events", "[event_view]") {
+    auto events = make_query_test_events();
+    
+    EventView selected(events, {1, 3, 5});
+    REQUIRE(selected.compact(events).ok());
+    REQUIRE(events.size() == 3);
+    REQUIRE(events[0].id == 2);
+    REQUIRE(events[1].id == 4);
+    REQUIRE(events[2].id == 6);
+    REQUIRE(events[2].message == "crash");
+    REQUIRE(selected.empty());
+    
+    // A whole-store view keeps everything; a view of another store is rejected
+    EventView whole = events;
+    REQUIRE(whole.compact(events).ok());
+    REQUIRE(events.size() == 3);
+    auto other = make_query_test_events();
+    EventView foreign(other, {0});
+    auto status = foreign.compact(events);
+    REQUIRE(status.code == ErrorCode::INVALID_INPUT);
+    REQUIRE(events.size() == 3);
+    REQUIRE(foreign.size() == 1);
+}
+
+TEST_CASE("filter_by_window returns a view over the original store", "[event_view][window]") {
+    auto events = make_query_test_events();
+    Event untimed;
+    untimed.id = 7;
+    events.push_back(untimed);
+    auto base = *events[0].ts;
+    
+    TimeWindow window(base.tp + std::chrono::seconds(10), base.tp + std::chrono::seconds(30));
+    EventView in_window = filter_by_window(events, window);
+    REQUIRE(in_window.store() == &events);
+    REQUIRE(in_window.size() == 3);
+    REQUIRE(in_window[0].id == 2);
+    REQUIRE(in_window[2].id == 4);
+    
+    // Unconstrained windows keep every event, including untimed ones
+    REQUIRE(filter_by_window(events, TimeWindow()).size() == 7);
+}
+
+TEST_CASE("Analysis APIs accept selections", "[event_view][query]") {
+    auto events = make_query_test_events();
+    
+    Query query;
+    REQUIRE(parse_query("source=other.log or sev=WARN", query).ok());
+    QueryEngine engine(events);
+    EventView matches = engine.view(query);
+    REQUIRE(matches.size() == 4);
+    REQUIRE(&matches[0] == &events[1]);
+    
+    auto copies = engine.filter(query);
+    StatsConfig config;
+    config.parallel_chunk_events = 1;
+    StatsBuilder builder(config);
+    Stats from_view = builder.build(matches);
+    Stats from_copy = builder.build(copies);
+    REQUIRE(from_view.total_events == 4);
+    REQUIRE(from_view.severity_counts == from_copy.severity_counts);
+    REQUIRE(from_view.source_counts == from_copy.source_counts);
+    REQUIRE(from_view.start_time == from_copy.start_time);
+    
+    ThreadPool pool(2);
+    Stats parallel = builder.build_parallel(matches, pool);
+    REQUIRE(parallel.severity_counts == from_copy.severity_counts);
+    REQUIRE(parallel.end_time == from_copy.end_time);
+}
+
+TEST_CASE("Indexes and queries over a selection use view positions", "[event_view][query]") {
+    auto events = make_query_test_events();
+    EventView other_log = EventView(events).where(
+        [](const Event& e) { return e.src.source_path == "other.log"; });
+    REQUIRE(other_log.size() == 3);
+    
+    EventLookup lookup(other_log);
+    REQUIRE(lookup.size() == 3);
+    REQUIRE(lookup.index_of(5) == 1);
+    REQUIRE(lookup.find(6) == &events[5]);
+    REQUIRE_FALSE(lookup.contains(1));
+    
+    EventIndex index;
+    index.build(other_log);
+    REQUIRE(index.count_by_severity(Severity::ERROR) == 1);
+    REQUIRE(index.get_all_events().size() == 3);
+    
+    TextIndex text;
+    text.build(other_log, &lookup);
+    REQUIRE(text.positions_containing_any({"timeout"}) == std::vector<size_t>{0});
+    
+    EventFeatures features;
+    features.build(other_log);
+    REQUIRE(features.size() == 3);
+    REQUIRE(features.positions(Feature::TIMEOUT) == std::vector<size_t>{0});
+    
+    // Matches are view positions, and the narrowed view maps them back to the store
+    Query query;
+    REQUIRE(parse_query("sev>=ERROR", query).ok());
+    QueryEngine engine(other_log, &index, &text, &lookup);
+    REQUIRE(engine.select(query) == std::vector<size_t>{0, 2});
+    EventView matches = engine.view(query);
+    REQUIRE(matches.store() == &events);
+    REQUIRE(matches.position(1) == 5);
+    REQUIRE(&matches[0] == &events[3]);
+}
+
+// Event Lookup Tests
+
+TEST_CASE("EventLookup resolves contiguous IDs", "[event_lookup]") {
+    std::vector<Event> events;
+    for (EventId id = 1; id <= 5; ++id) {
+        Event e;
+        e.id = id;
+        events.push_back(e);
+    }
+    
+    EventLookup lookup(events);
+    
+    REQUIRE(lookup.size() == 5);
+    REQUIRE(lookup.index_of(1) == 0);
+    REQUIRE(lookup.index_of(5) == 4);
+    REQUIRE(lookup.find(3) == &events[2]);
+    REQUIRE(lookup.find(0) == nullptr);
+    REQUIRE(lookup.find(6) == nullptr);
+}
+
+TEST_CASE("EventLookup resolves IDs with gaps after filtering", "[event_lookup]") {
+    std::vector<Event> events;
+    for (EventId id : {2, 3, 7, 9, 10}) {
+        Event e;
+        e.id = id;
+        events.push_back(e);
+    }
+    
+    EventLookup lookup(events);
+    
+    REQUIRE(lookup.index_of(7) == 2);
+    REQUIRE(lookup.find(10) == &events[4]);
+    REQUIRE_FALSE(lookup.contains(4));
+    REQUIRE_FALSE(lookup.contains(1));
+    REQUIRE_FALSE(lookup.contains(11));
+}
+
+TEST_CASE("EventLookup resolves sparse IDs", "[event_lookup]") {
+    std::vector<Event> events;
+    for (EventId id : {1000000, 5, 42}) {
+        Event e;
+        e.id = id;
+        events.push_back(e);
+    }
+    
+    EventLookup lookup(events);
+    
+    REQUIRE(lookup.index_of(1000000) == 0);
+    REQUIRE(lookup.index_of(5) == 1);
+    REQUIRE(lookup.index_of(42) == 2);
+    REQUIRE(lookup.index_of(43) == EventLookup::npos);
+}
+
+TEST_CASE("EventLookup handles empty store", "[event_lookup]") {
+    std::vector<Event> events;
+    EventLookup lookup(events);
+    
+    REQUIRE(lookup.size() == 0);
+    REQUIRE(lookup.find(1) == nullptr);
+}
+
+// Clock Skew Tests
+
+Event make_skew_event(EventId id, const std::string& source, const std::string& request_id,
+                      std::chrono::system_clock::time_point tp) {
+    Event e;
+    e.id = id;
+    e.src.source_path = source;
+    e.ts = Timestamp(tp);
+    if (!request_id.empty()) {
+        e.tags["request_id"] = request_id;
+    }
+    return e;
+}
+
+TEST_CASE("ClockSkewEstimator recovers per-source offsets from shared request IDs", "[clock_skew]") {
+    using std::chrono::milliseconds;
+    auto base = std::chrono::system_clock::from_time_t(1709719200);
+    
+    // gateway -> api (+20 ms) -> db (+10 ms); api's clock is 3 s fast, db's 2 s slow
+    std::vector<Event> events;
+    for (int i = 0; i < 50; i++) {
+        std::string rid = "req-" + std::to_string(i);
+        auto sent = base + std::chrono::seconds(i * 7);
+        events.push_back(make_skew_event(events.size() + 1, "a-gateway.log", rid, sent));
+        events.push_back(make_skew_event(events.size() + 1, "b-api.log", rid, sent + milliseconds(3020)));
+        events.push_back(make_skew_event(events.size() + 1, "b-api.log", rid, sent + milliseconds(3050)));
+        events.push_back(make_skew_event(events.size() + 1, "c-db.log", rid, sent + milliseconds(-1970)));
+    }
+    events.push_back(make_skew_event(events.size() + 1, "c-db.log", "", base));
+    
+    ClockSkewEstimator estimator;
+    auto estimate = estimator.estimate(events);
+    
+    REQUIRE(estimate.joined_ids == 50);
+    REQUIRE(estimate.offsets.size() == 3);
+    const auto* gateway = estimate.find("a-gateway.log");
+    const auto* api = estimate.find("b-api.log");
+    const auto* db = estimate.find("c-db.log");
+    REQUIRE(gateway != nullptr);
+    REQUIRE(api != nullptr);
+    REQUIRE(db != nullptr);
+    REQUIRE(estimate.find("missing.log") == nullptr);
+    
+    // All three share every ID, so the name breaks the tie for the reference
+    REQUIRE(gateway->reference);
+    REQUIRE(gateway->offset == milliseconds(0));
+    REQUIRE_FALSE(gateway->applied);
+    REQUIRE(api->offset == milliseconds(3020));
+    REQUIRE(db->offset == milliseconds(-1970));
+    REQUIRE(api->shared_ids == 100);
+    REQUIRE(api->applied);
+    REQUIRE(db->applied);
+    REQUIRE(estimate.applied_count() == 2);
+    
+    // Every timestamped event of a corrected source moves onto the gateway clock
+    size_t changed = ClockSkewEstimator::apply(estimate, events);
+    REQUIRE(changed == 50 * 2 + 51);
+    REQUIRE(events[0].ts->tp == base);
+    REQUIRE(events[1].ts->tp == base);
+    REQUIRE(events[3].ts->tp == base);
+    REQUIRE(events.back().ts->tp == base + milliseconds(1970));
+}
+
+TEST_CASE("ClockSkewEstimator solves inconsistent pairs by least squares", "[clock_skew]") {
+    using std::chrono::milliseconds;
+    auto base = std::chrono::system_clock::from_time_t(1709719200);
+    
+    // Pairwise medians a->b 1 s, b->c 1 s, a->c 3 s, each from 5 IDs
+    std::vector<Event> events;
+    auto add_pair = [&](const std::string& from, const std::string& to, int delta_ms, const std::string& tag) {
+        for (int i = 0; i < 5; i++) {
+            std::string rid = tag + std::to_string(i);
+            auto tp = base + std::chrono::minutes(i);
+            events.push_back(make_skew_event(events.size() + 1, from, rid, tp));
+            events.push_back(make_skew_event(events.size() + 1, to, rid, tp + milliseconds(delta_ms)));
+        }
+    };
+    add_pair("a.log", "b.log", 1000, "ab-");
+    add_pair("b.log", "c.log", 1000, "bc-");
+    add_pair("a.log", "c.log", 3000, "ac-");
+    
+    auto estimate = ClockSkewEstimator().estimate(events);
+    REQUIRE(estimate.offsets.size() == 3);
+    REQUIRE(estimate.find("a.log")->reference);
+    REQUIRE(estimate.find("b.log")->offset == milliseconds(1333));
+    REQUIRE(estimate.find("c.log")->offset == milliseconds(2667));
+}
+
+TEST_CASE("ClockSkewEstimator ignores weak, noisy and single-source evidence", "[clock_skew]") {
+    using std::chrono::milliseconds;
+    auto base = std::chrono::system_clock::from_time_t(1709719200);
+    
+    SECTION("median shrugs off slow requests") {
+        std::vector<Event> events;
+        for (int i = 0; i < 9; i++) {
+            std::string rid = "r" + std::to_string(i);
+            int delay = (i < 3) ? 30000 : 5000;  // Three retried requests
+            events.push_back(make_skew_event(events.size() + 1, "a.log", rid, base));
+            events.push_back(make_skew_event(events.size() + 1, "b.log", rid, base + milliseconds(delay)));
+        }
+        auto estimate = ClockSkewEstimator().estimate(events);
+        REQUIRE(estimate.find("b.log")->offset == milliseconds(5000));
+    }
+    
+    SECTION("too few shared IDs") {
+        std::vector<Event> events;
+        for (int i = 0; i < 2; i++) {
+            std::string rid = "r" + std::to_string(i);
+            events.push_back(make_skew_event(events.size() + 1, "a.log", rid, base));
+            events.push_back(make_skew_event(events.size() + 1, "b.log", rid, base + milliseconds(5000)));
+        }
+        auto estimate = ClockSkewEstimator().estimate(events);
+        REQUIRE(estimate.joined_ids == 2);
+        REQUIRE(estimate.empty());
+        REQUIRE(ClockSkewEstimator::apply(estimate, events) == 0);
+    }
+    
+    SECTION("IDs confined to one source or shared by too many events") {
+        ClockSkewConfig config;
+        config.max_events_per_id = 4;
+        std::vector<Event> events;
+        for (int i = 0; i < 10; i++) {
+            events.push_back(make_skew_event(events.size() + 1, "a.log", "r" + std::to_string(i), base));
+            events.push_back(make_skew_event(events.size() + 1, "a.log", "r" + std::to_string(i),
+                                             base + milliseconds(5)));
+            events.push_back(make_skew_event(events.size() + 1, i % 2 ? "a.log" : "b.log", "-",
+                                             base + milliseconds(5000)));
+        }
+        REQUIRE(ClockSkewEstimator(config).estimate(events).joined_ids == 0);
+    }
+    
+    SECTION("offsets within tolerance are reported but not applied") {
+        std::vector<Event> events;
+        for (int i = 0; i < 5; i++) {
+            std::string rid = "r" + std::to_string(i);
+            events.push_back(make_skew_event(events.size() + 1, "a.log", rid, base));
+            events.push_back(make_skew_event(events.size() + 1, "b.log", rid, base + milliseconds(40)));
+        }
+        auto estimate = ClockSkewEstimator().estimate(events);
+        REQUIRE(estimate.find("b.log")->offset == milliseconds(40));
+        REQUIRE_FALSE(estimate.find("b.log")->applied);
+        REQUIRE(ClockSkewEstimator::apply(estimate, events) == 0);
+    }
+}
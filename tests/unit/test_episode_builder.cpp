@@ -273,3 +273,144 @@ TEST_CASE("Episode struct size and empty methods work", "[episode]") {
     REQUIRE_FALSE(ep.empty());
     REQUIRE(ep.size() == 2);
 }
+
+TEST_CASE("StreamingEpisodeBuilder emits episodes as gaps close", "[episode_builder][streaming]") {
+    EpisodeConfig config;
+    config.time_gap_threshold = std::chrono::minutes(5);
+    config.merge_by_correlation = false;
+    
+    std::vector<Episode> emitted;
+    StreamingEpisodeBuilder stream(config, [&](Episode&& ep) { emitted.push_back(std::move(ep)); });
+    
+    auto now = std::chrono::system_clock::now();
+    stream.add(create_event(1, Severity::INFO, now));
+    stream.add(create_event(2, Severity::ERROR, now + std::chrono::minutes(1)));
+    REQUIRE(emitted.empty());
+    
+    // Gap closes the first episode before the stream ends
+    stream.add(create_event(3, Severity::INFO, now + std::chrono::minutes(10)));
+    REQUIRE(emitted.size() == 1);
+    REQUIRE(emitted[0].event_ids.size() == 2);
+    REQUIRE(emitted[0].max_severity == Severity::ERROR);
+    REQUIRE(emitted[0].highlights[0] == 2);
+    REQUIRE(stream.open_episode_count() == 1);
+    
+    stream.flush();
+    REQUIRE(emitted.size() == 2);
+    REQUIRE(stream.open_episode_count() == 0);
+}
+
+TEST_CASE("StreamingEpisodeBuilder bounds open episodes", "[episode_builder][streaming]") {
+    EpisodeConfig config;
+    config.time_gap_threshold = std::chrono::minutes(1);
+    
+    size_t emitted = 0;
+    size_t max_open = 0;
+    StreamingEpisodeBuilder stream(config, [&](Episode&&) { emitted++; });
+    
+    auto now = std::chrono::system_clock::now();
+    for (EventId id = 1; id <= 100; ++id) {
+        stream.add(create_event(id, Severity::INFO, now + std::chrono::minutes(10 * id)));
+        max_open = std::max(max_open, stream.open_episode_count());
+    }
+    stream.flush();
+    
+    REQUIRE(emitted == 100);
+    REQUIRE(max_open <= 2);
+}
+
+TEST_CASE("StreamingEpisodeBuilder merges held-back episode by correlation", "[episode_builder][streaming]") {
+    EpisodeConfig config;
+    config.time_gap_threshold = std::chrono::minutes(1);
+    
+    std::vector<Episode> emitted;
+    StreamingEpisodeBuilder stream(config, [&](Episode&& ep) { emitted.push_back(std::move(ep)); });
+    
+    auto now = std::chrono::system_clock::now();
+    Event e1 = create_event(1, Severity::INFO, now);
+    e1.tags["request_id"] = "req-1";
+    Event e2 = create_event(2, Severity::ERROR, now + std::chrono::minutes(5));
+    e2.tags["request_id"] = "req-1";
+    Event e3 = create_event(3, Severity::INFO, now + std::chrono::minutes(10));
+    
+    stream.add(e1);
+    stream.add(e2);
+    stream.add(e3);
+    stream.flush();
+    
+    REQUIRE(emitted.size() == 2);
+    REQUIRE(emitted[0].event_ids == std::vector<EventId>{1, 2});
+    REQUIRE(*emitted[0].start_time == now);
+    REQUIRE(*emitted[0].end_time == now + std::chrono::minutes(5));
+    REQUIRE(emitted[1].event_ids == std::vector<EventId>{3});
+}
+
+TEST_CASE("EpisodeBuilder merges non-adjacent episodes with shared correlation IDs", "[episode_builder][correlation]") {
+    EpisodeConfig config;
+    config.time_gap_threshold = std::chrono::minutes(5);
+    EpisodeBuilder builder(config);
+    
+    std::vector<Event> events;
+    auto now = std::chrono::system_clock::now();
+    
+    Event e1 = create_event(1, Severity::INFO, now);
+    e1.tags["request_id"] = "req-123";
+    events.push_back(e1);
+    
+    // Unrelated burst in between
+    events.push_back(create_event(2, Severity::ERROR, now + std::chrono::minutes(10)));
+    events.push_back(create_event(3, Severity::ERROR, now + std::chrono::minutes(11)));
+    
+    // Same request resumes after another gap
+    Event e4 = create_event(4, Severity::WARN, now + std::chrono::minutes(17));
+    e4.tags["request_id"] = "req-123";
+    events.push_back(e4);
+    
+    auto episodes = builder.build(events);
+    
+    REQUIRE(episodes.size() == 2);
+    REQUIRE(episodes[0].event_ids == std::vector<EventId>{1, 4});
+    REQUIRE(*episodes[0].end_time == now + std::chrono::minutes(17));
+    REQUIRE(episodes[1].event_ids == std::vector<EventId>{2, 3});
+}
+
+TEST_CASE("EpisodeBuilder can keep non-adjacent episodes separate", "[episode_builder][correlation]") {
+    EpisodeConfig config;
+    config.time_gap_threshold = std::chrono::minutes(5);
+    config.merge_across_gaps = false;
+    EpisodeBuilder builder(config);
+    
+    std::vector<Event> events;
+    auto now = std::chrono::system_clock::now();
+    
+    Event e1 = create_event(1, Severity::INFO, now);
+    e1.tags["request_id"] = "req-123";
+    events.push_back(e1);
+    events.push_back(create_event(2, Severity::ERROR, now + std::chrono::minutes(10)));
+    Event e3 = create_event(3, Severity::WARN, now + std::chrono::minutes(20));
+    e3.tags["request_id"] = "req-123";
+    events.push_back(e3);
+    
+    REQUIRE(builder.build(events).size() == 3);
+}
+
+TEST_CASE("CorrelationGrouper caps merged episode size", "[episode_builder][correlation]") {
+    EpisodeConfig config;
+    config.max_merged_episode_events = 2;
+    CorrelationGrouper grouper(config);
+    
+    std::vector<Episode> episodes;
+    for (uint64_t i = 1; i <= 3; ++i) {
+        Episode ep(i);
+        ep.event_ids.push_back(i);
+        ep.correlation_ids.push_back("hot-session");
+        episodes.push_back(ep);
+    }
+    
+    auto grouped = grouper.group(std::move(episodes));
+    
+    REQUIRE(grouped.size() == 2);
+    REQUIRE(grouped[0].id == 1);
+    REQUIRE(grouped[0].size() == 2);
+    REQUIRE(grouped[1].size() == 1);
+}
@@ -1,6 +1,8 @@
 #include <catch2/catch_test_macros.hpp>
 #include "logstory/io/file_reader.hpp"
+#include "logstory/io/time_index.hpp"
 #include <filesystem>
+#include <cstdio>
 #include <fstream>
 
 using namespace logstory::io;
@@ -167,3 +169,272 @@ TEST_CASE("FileReader handles file with blank lines", "[file_reader]") {
     // Cleanup
     fs::remove(temp_path);
 }
+
+TEST_CASE("FileReader probes first and last timestamps", "[file_reader][probe]") {
+    fs::path path = fs::temp_directory_path() / "logstory_probe_test.log";
+    {
+        std::ofstream out(path);
+        out << "header without time\n";
+        out << "2024-03-06T10:00:00Z INFO first\n";
+        for (int i = 0; i < 2000; i++) {
+            out << "2024-03-06T10:30:00Z INFO filler line " << i << "\n";
+        }
+        out << "2024-03-06T11:00:00Z INFO last\n";
+        out << "trailing stack frame\n";
+    }
+    
+    FileReader reader;
+    FileTimeBounds bounds;
+    REQUIRE(reader.probe_time_bounds(path.string(), bounds, true, 4096).ok());
+    REQUIRE(bounds.first.has_value());
+    REQUIRE(bounds.last.has_value());
+    
+    auto first = bounds.first->tp;
+    auto last = bounds.last->tp;
+    REQUIRE(last - first == std::chrono::hours(1));
+    
+    // Windows that miss [first, last] entirely can skip the file
+    REQUIRE(bounds.outside(last + std::chrono::seconds(1), std::nullopt));
+    REQUIRE(bounds.outside(std::nullopt, first - std::chrono::seconds(1)));
+    REQUIRE_FALSE(bounds.outside(first + std::chrono::minutes(10), last + std::chrono::hours(1)));
+    
+    // Within the jitter slack, out-of-order lines may still fall in the window
+    auto jitter = SeekConfig().jitter;
+    REQUIRE_FALSE(bounds.outside(std::nullopt, first - std::chrono::seconds(1), jitter));
+    REQUIRE_FALSE(bounds.outside(last + std::chrono::seconds(1), std::nullopt, jitter));
+    REQUIRE(bounds.outside(std::nullopt, first - jitter - std::chrono::seconds(1), jitter));
+    REQUIRE(bounds.outside(last + jitter + std::chrono::seconds(1), std::nullopt, jitter));
+    
+    // A file last written long before the window starts is skipped by mtime
+    FileTimeBounds stat_only;
+    REQUIRE(reader.probe_time_bounds(path.string(), stat_only, false).ok());
+    REQUIRE_FALSE(stat_only.first.has_value());
+    REQUIRE(stat_only.outside(stat_only.mtime + std::chrono::hours(48), std::nullopt));
+    REQUIRE_FALSE(stat_only.outside(stat_only.mtime - std::chrono::hours(48), std::nullopt));
+    
+    fs::remove(path);
+}
+
+// Writes one line per second starting at 10:00:00, with a stack-trace
+// continuation after every tenth line
+static fs::path write_ordered_log(const std::string& name, int count) {
+    fs::path path = fs::temp_directory_path() / name;
+    std::ofstream out(path);
+    for (int i = 0; i < count; i++) {
+        char ts[32];
+        std::snprintf(ts, sizeof(ts), "2024-03-06T%02d:%02d:%02dZ",
+                      10 + i / 3600, (i / 60) % 60, i % 60);
+        out << ts << " INFO request " << i << " handled\n";
+        if (i % 10 == 0) {
+            out << "    at handler.cpp:" << i << "\n";
+        }
+    }
+    return path;
+}
+
+TEST_CASE("FileReader read_window bisects time-ordered files", "[file_reader][seek]") {
+    fs::path path = write_ordered_log("logstory_seek_test.log", 5000);
+    
+    SeekConfig config;
+    config.min_file_bytes = 0;
+    config.block_bytes = 512;
+    config.probe_bytes = 1024;
+    config.jitter = std::chrono::seconds(0);
+    FileReader reader(config);
+    
+    std::vector<RawLine> all;
+    REQUIRE(reader.read(path.string(), all).ok());
+    
+    FileTimeBounds bounds;
+    REQUIRE(reader.probe_time_bounds(path.string(), bounds).ok());
+    auto base = bounds.first->tp;
+    
+    std::vector<RawLine> lines;
+    SeekResult seek;
+    REQUIRE(reader.read_window(path.string(), base + std::chrono::seconds(2000),
+                               base + std::chrono::seconds(2100), lines, &seek).ok());
+    
+    REQUIRE(seek.bisected);
+    REQUIRE(seek.start_offset > 0);
+    REQUIRE(seek.end_offset < fs::file_size(path));
+    
+    // Exactly the lines of events 2000..2100 plus their continuations, with
+    // the same line numbers a full read assigns
+    REQUIRE_FALSE(lines.empty());
+    REQUIRE(lines.front().text.find("request 2000 ") != std::string::npos);
+    REQUIRE(lines.size() == 101 + 11);
+    REQUIRE(lines[lines.size() - 2].text.find("request 2100 ") != std::string::npos);
+    REQUIRE(lines.back().text == "    at handler.cpp:2100");
+    for (const auto& line : lines) {
+        REQUIRE(all[line.line_no - 1].text == line.text);
+    }
+    
+    // Open-ended window runs to the end of the file
+    lines.clear();
+    REQUIRE(reader.read_window(path.string(), base + std::chrono::seconds(4990),
+                               std::nullopt, lines, &seek).ok());
+    REQUIRE(seek.bisected);
+    REQUIRE(lines.back().line_no == all.size());
+    REQUIRE(lines.front().text.find("request 4990 ") != std::string::npos);
+    
+    fs::remove(path);
+}
+
+TEST_CASE("FileReader read_window falls back on unordered files", "[file_reader][seek]") {
+    fs::path path = fs::temp_directory_path() / "logstory_seek_unordered.log";
+    {
+        std::ofstream out(path);
+        for (int i = 0; i < 3000; i++) {
+            // Two interleaved clocks an hour apart
+            int hour = (i % 2 == 0) ? 10 : 11;
+            char ts[32];
+            std::snprintf(ts, sizeof(ts), "2024-03-06T%02d:%02d:%02dZ",
+                          hour, (i / 60) % 60, i % 60);
+            out << ts << " INFO line " << i << "\n";
+        }
+    }
+    
+    SeekConfig config;
+    config.min_file_bytes = 0;
+    config.block_bytes = 512;
+    config.probe_bytes = 1024;
+    FileReader reader(config);
+    
+    FileTimeBounds bounds;
+    REQUIRE(reader.probe_time_bounds(path.string(), bounds).ok());
+    
+    std::vector<RawLine> lines;
+    SeekResult seek;
+    REQUIRE(reader.read_window(path.string(), bounds.first->tp + std::chrono::minutes(30),
+                               std::nullopt, lines, &seek).ok());
+    REQUIRE_FALSE(seek.bisected);
+    REQUIRE_FALSE(seek.fallback_reason.empty());
+    REQUIRE(lines.size() == 3000);
+    
+    // Small files are read whole without probing
+    FileReader default_reader;
+    lines.clear();
+    REQUIRE(default_reader.read_window(path.string(), bounds.first->tp, std::nullopt,
+                                       lines, &seek).ok());
+    REQUIRE_FALSE(seek.bisected);
+    REQUIRE(lines.size() == 3000);
+    
+    fs::remove(path);
+}
+
+TEST_CASE("TimeIndex sidecar seeks and revalidates", "[file_reader][time_index]") {
+    fs::path path = write_ordered_log("logstory_tidx_test.log", 5000);
+    fs::path sidecar = TimeIndex::sidecar_path(path.string());
+    fs::remove(sidecar);
+    
+    TimeIndex index;
+    bool rebuilt = false;
+    REQUIRE(index.load_or_build(path.string(), "", &rebuilt).ok());
+    REQUIRE(rebuilt);
+    REQUIRE(fs::exists(sidecar));
+    REQUIRE(index.ordered());
+    REQUIRE(index.entries().size() == 84);  // 5000 seconds of log, one per minute
+    
+    // Second open reuses the sidecar
+    TimeIndex reloaded;
+    REQUIRE(reloaded.load_or_build(path.string(), "", &rebuilt).ok());
+    REQUIRE_FALSE(rebuilt);
+    REQUIRE(reloaded.entries().size() == index.entries().size());
+    REQUIRE(reloaded.entries()[10].offset == index.entries()[10].offset);
+    REQUIRE(reloaded.entries()[10].line_no == index.entries()[10].line_no);
+    
+    // Reading through the index gives the same lines and numbers as a full read
+    SeekConfig config;
+    config.min_file_bytes = 0;
+    config.use_time_index = true;
+    FileReader reader(config);
+    
+    std::vector<RawLine> all;
+    REQUIRE(reader.read(path.string(), all).ok());
+    
+    auto base = index.entries().front().tp;
+    std::vector<RawLine> lines;
+    SeekResult seek;
+    REQUIRE(reader.read_window(path.string(), base + std::chrono::seconds(2000),
+                               base + std::chrono::seconds(2100), lines, &seek).ok());
+    REQUIRE(seek.indexed);
+    REQUIRE(seek.start_offset > 0);
+    bool has_first = false;
+    bool has_last = false;
+    for (const auto& line : lines) {
+        REQUIRE(all[line.line_no - 1].text == line.text);
+        has_first = has_first || line.text.find("request 2000 ") != std::string::npos;
+        has_last = has_last || line.text.find("request 2100 ") != std::string::npos;
+    }
+    REQUIRE(has_first);
+    REQUIRE(has_last);
+    REQUIRE(lines.size() < all.size() / 10);
+    
+    // Changing the file invalidates the sidecar
+    {
+        std::ofstream out(path, std::ios::app);
+        out << "2024-03-06T12:00:00Z INFO appended\n";
+    }
+    REQUIRE_FALSE(reloaded.matches(path.string()));
+    REQUIRE(reloaded.load_or_build(path.string(), "", &rebuilt).ok());
+    REQUIRE(rebuilt);
+    
+    fs::remove(sidecar);
+    fs::remove(path);
+}
+
+TEST_CASE("read_window builds the time index in the pass that reads the window", "[file_reader][time_index]") {
+    fs::path path = write_ordered_log("logstory_tidx_pass_test.log", 5000);
+    fs::path dir = fs::temp_directory_path() / "logstory_tidx_pass_dir";
+    fs::remove_all(dir);
+    
+    SeekConfig config;
+    config.min_file_bytes = 0;
+    config.use_time_index = true;
+    config.time_index_dir = dir.string();
+    FileReader reader(config);
+    
+    TimeIndex full;
+    REQUIRE(full.build(path.string()).ok());
+    auto base = full.entries().front().tp;
+    auto start = base + std::chrono::seconds(2000);
+    auto end = base + std::chrono::seconds(2100);
+    
+    // First run: no sidecar yet, so one pass indexes the file and keeps the window
+    std::vector<RawLine> first;
+    SeekResult first_seek;
+    REQUIRE(reader.read_window(path.string(), start, end, first, &first_seek).ok());
+    REQUIRE(first_seek.indexed);
+    fs::path sidecar = TimeIndex::sidecar_path(path.string(), dir.string());
+    REQUIRE(fs::exists(sidecar));
+    
+    TimeIndex saved;
+    REQUIRE(saved.load(sidecar.string()).ok());
+    REQUIRE(saved.matches(path.string()));
+    REQUIRE(saved.entries().size() == full.entries().size());
+    REQUIRE(saved.entries()[40].offset == full.entries()[40].offset);
+    
+    // Second run seeks with the saved sidecar to exactly the same lines
+    std::vector<RawLine> second;
+    SeekResult second_seek;
+    REQUIRE(reader.read_window(path.string(), start, end, second, &second_seek).ok());
+    REQUIRE(second_seek.indexed);
+    REQUIRE(second_seek.start_offset == first_seek.start_offset);
+    REQUIRE(second_seek.end_offset == first_seek.end_offset);
+    REQUIRE(first.size() == second.size());
+    for (size_t i = 0; i < first.size(); i++) {
+        REQUIRE(first[i].line_no == second[i].line_no);
+        REQUIRE(first[i].text == second[i].text);
+    }
+    REQUIRE(first.size() < 500);
+    
+    // Files below the seek threshold are read whole and get no sidecar
+    fs::remove(sidecar);
+    config.min_file_bytes = 1 << 30;
+    std::vector<RawLine> small;
+    REQUIRE(FileReader(config).read_window(path.string(), start, end, small).ok());
+    REQUIRE_FALSE(fs::exists(sidecar));
+    
+    fs::remove_all(dir);
+    fs::remove(path);
+}
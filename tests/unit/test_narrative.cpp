@@ -7,6 +7,8 @@
 #include "logstory/analysis/episode_builder.hpp"
 #include "logstory/rules/rule_registry.hpp"
 #include "logstory/rules/builtin/crash_loop_rule.hpp"
+#include <algorithm>
+#include <cmath>
 #include <sstream>
 
 using namespace logstory::narrative;
@@ -147,6 +149,43 @@ TEST_CASE("Narrator generates timeline from events", "[narrative][narrator]") {
     REQUIRE_FALSE(report.timeline.empty());
 }
 
+TEST_CASE("Narrator summarizes errors per bucket on long inputs", "[narrative][narrator]") {
+    // One error an hour for ten days, and an outage on day 7
+    auto base = std::chrono::system_clock::time_point(std::chrono::hours(24 * 365 * 50));
+    std::vector<Event> events;
+    for (int hour = 0; hour < 240; hour++) {
+        events.push_back(create_narrative_test_event(events.size() + 1, Severity::ERROR,
+            "Error at hour " + std::to_string(hour), base + std::chrono::hours(hour)));
+    }
+    for (int i = 0; i < 50; i++) {
+        events.push_back(create_narrative_test_event(events.size() + 1, Severity::ERROR, "Outage",
+            base + std::chrono::hours(24 * 7) + std::chrono::minutes(i + 30)));
+    }
+    
+    StatsConfig config;
+    config.rollup_resolutions = {std::chrono::minutes(5), std::chrono::hours(1), std::chrono::hours(24)};
+    Stats stats = StatsBuilder(config).build(events);
+    
+    Narrator narrator;
+    Report report = narrator.generate(events, stats, {}, {});
+    
+    // Ten days fit the 20 highlights at one bucket per day
+    REQUIRE(report.timeline.size() == 10);
+    REQUIRE(report.timeline.front().timestamp == base);
+    REQUIRE(report.timeline.front().description == "24 errors in 24h, first: Error at hour 0");
+    REQUIRE(report.timeline.front().event_id == 1);
+    REQUIRE(report.timeline.back().timestamp == base + std::chrono::hours(24 * 9));
+    REQUIRE(report.timeline[7].description.rfind("74 errors in 24h", 0) == 0);
+    
+    // With fewer highlights than days, the busiest days are kept
+    NarratorConfig narrow;
+    narrow.max_timeline_highlights = 3;
+    Report short_report = Narrator(narrow).generate(events, stats, {}, {});
+    REQUIRE(short_report.timeline.size() == 3);
+    REQUIRE(std::any_of(short_report.timeline.begin(), short_report.timeline.end(),
+        [&](const TimelineHighlight& hl) { return hl.timestamp == base + std::chrono::hours(24 * 7); }));
+}
+
 TEST_CASE("Narrator generates evidence from findings", "[narrative][narrator]") {
     Narrator narrator;
     std::vector<Event> events;
@@ -302,3 +341,168 @@ TEST_CASE("JSONWriter includes schema version", "[narrative][json]") {
     
     REQUIRE(output.find("\"schema_version\": 1") != std::string::npos);
 }
+
+TEST_CASE("JSONWriter includes distinct tag value counts", "[narrative][json]") {
+    Narrator narrator;
+    std::vector<Event> events;
+    auto now = std::chrono::system_clock::now();
+    
+    for (EventId i = 1; i <= 6; i++) {
+        Event e = create_narrative_test_event(i, i % 2 == 0 ? Severity::ERROR : Severity::INFO, "Request", now);
+        e.tags["request_id"] = "req-" + std::to_string(i);
+        e.tags["user"] = (i <= 3) ? "alice" : "bob";
+        events.push_back(e);
+    }
+    
+    StatsBuilder builder;
+    Stats stats = builder.build(events);
+    std::vector<Episode> episodes;
+    std::vector<Finding> findings;
+    Report report = narrator.generate(events, stats, episodes, findings);
+    
+    REQUIRE(report.tag_cardinality.size() == 2);
+    REQUIRE(report.tag_cardinality[0].key == "request_id");
+    REQUIRE(report.tag_cardinality[0].distinct == 6);
+    REQUIRE(report.tag_cardinality[0].by_severity.at(Severity::ERROR) == 3);
+    REQUIRE(report.tag_cardinality[1].distinct == 2);
+    
+    JSONWriter writer;
+    std::ostringstream oss;
+    writer.write(report, oss);
+    std::string output = oss.str();
+    
+    REQUIRE(output.find("\"tag_cardinality\": [") != std::string::npos);
+    REQUIRE(output.find("\"key\": \"request_id\"") != std::string::npos);
+    REQUIRE(output.find("\"distinct\": 6") != std::string::npos);
+    REQUIRE(output.find("\"exact\": true") != std::string::npos);
+    REQUIRE(output.find("\"by_severity\": {\"INFO\": 3, \"ERROR\": 3}") != std::string::npos);
+}
+
+TEST_CASE("Reports include numeric tag quantiles", "[narrative][json][markdown]") {
+    Narrator narrator;
+    std::vector<Event> events;
+    auto now = std::chrono::system_clock::now();
+    
+    for (EventId i = 1; i <= 100; i++) {
+        Event e = create_narrative_test_event(i, Severity::INFO, "Request", now);
+        e.tags["latency"] = std::to_string(i) + "ms";
+        events.push_back(e);
+    }
+    
+    StatsBuilder builder;
+    Stats stats = builder.build(events);
+    std::vector<Episode> episodes;
+    std::vector<Finding> findings;
+    Report report = narrator.generate(events, stats, episodes, findings);
+    
+    REQUIRE(report.numeric_tags.size() == 1);
+    const auto& latency = report.numeric_tags[0];
+    REQUIRE(latency.key == "latency");
+    REQUIRE(latency.count == 100);
+    REQUIRE(latency.max == 100.0);
+    REQUIRE(std::abs(latency.p50 - 50.0) <= 1.0);
+    REQUIRE(std::abs(latency.p99 - 99.0) <= 1.5);
+    REQUIRE(latency.p95_changes.empty());
+    
+    JSONWriter json_writer;
+    std::ostringstream json;
+    json_writer.write(report, json);
+    REQUIRE(json.str().find("\"numeric_tags\": [") != std::string::npos);
+    REQUIRE(json.str().find("\"p95_changes\": []") != std::string::npos);
+    
+    MarkdownWriter md_writer;
+    std::ostringstream md;
+    md_writer.write(report, md);
+    REQUIRE(md.str().find("### Numeric Fields") != std::string::npos);
+    REQUIRE(md.str().find("| latency | 100 |") != std::string::npos);
+}
+
+TEST_CASE("Reports rank partitions by error rate", "[narrative][json][markdown][partition]") {
+    Narrator narrator;
+    std::vector<Event> events;
+    auto now = std::chrono::system_clock::now();
+    
+    for (EventId i = 1; i <= 40; i++) {
+        bool checkout = i % 2 == 0;
+        Severity sev = (checkout && i % 4 == 0) ? Severity::ERROR : Severity::INFO;
+        Event e = create_narrative_test_event(i, sev, "Request", now);
+        e.tags["service"] = checkout ? "checkout" : "api";
+        events.push_back(e);
+    }
+    
+    StatsConfig config;
+    config.partition_by = "service";
+    Stats stats = StatsBuilder(config).build(events);
+    std::vector<Episode> episodes;
+    std::vector<Finding> findings;
+    Report report = narrator.generate(events, stats, episodes, findings);
+    
+    REQUIRE(report.partition_dimension == "service");
+    REQUIRE(report.top_partitions.size() == 2);
+    REQUIRE(report.top_partitions[0].key == "service=checkout");
+    REQUIRE(report.top_partitions[0].events == 20);
+    REQUIRE(report.top_partitions[0].errors == 10);
+    REQUIRE(report.top_partitions[0].error_rate == 0.5);
+    bool has_bullet = std::any_of(report.summary.begin(), report.summary.end(), [](const auto& b) {
+        return b.text == "Highest error rate by service: service=checkout (50.0% of 20 events)";
+    });
+    REQUIRE(has_bullet);
+    
+    JSONWriter json_writer;
+    std::ostringstream json;
+    json_writer.write(report, json);
+    REQUIRE(json.str().find("\"dimension\": \"service\"") != std::string::npos);
+    REQUIRE(json.str().find("{\"key\": \"service=checkout\", \"events\": 20, \"errors\": 10") !=
+            std::string::npos);
+    
+    MarkdownWriter md_writer;
+    std::ostringstream md;
+    md_writer.write(report, md);
+    REQUIRE(md.str().find("### Top Partitions by Error Rate") != std::string::npos);
+    REQUIRE(md.str().find("| service=checkout | 20 | 10 | 0 | 50.0% |") != std::string::npos);
+}
+
+TEST_CASE("Reports list estimated clock offsets", "[narrative][json][markdown][clock_skew]") {
+    Narrator narrator;
+    Report report;
+    
+    ClockSkewEstimate estimate;
+    estimate.joined_ids = 120;
+    SourceOffset gateway;
+    gateway.source = "gateway.log";
+    gateway.shared_ids = 120;
+    gateway.reference = true;
+    SourceOffset api;
+    api.source = "api.log";
+    api.offset = std::chrono::milliseconds(-2500);
+    api.shared_ids = 120;
+    api.applied = true;
+    estimate.offsets = {api, gateway};
+    
+    narrator.describe_clock_skew(report, estimate);
+    REQUIRE(report.clock_offsets.size() == 2);
+    REQUIRE(report.summary.size() == 1);
+    REQUIRE(report.summary[0].text ==
+            "Corrected clock skew in 1 source(s) using 120 shared request/trace IDs (largest: api.log -2.5s)");
+    
+    JSONWriter json_writer;
+    std::ostringstream json;
+    json_writer.write(report, json);
+    REQUIRE(json.str().find("{\"source\": \"api.log\", \"offset_ms\": -2500, \"shared_ids\": 120, "
+                            "\"reference\": false, \"applied\": true}") != std::string::npos);
+    
+    MarkdownWriter md_writer;
+    std::ostringstream md;
+    md_writer.write(report, md);
+    REQUIRE(md.str().find("### Clock Offsets") != std::string::npos);
+    REQUIRE(md.str().find("include request latency") != std::string::npos);
+    REQUIRE(md.str().find("| api.log | -2.500s | 120 | corrected |") != std::string::npos);
+    REQUIRE(md.str().find("| gateway.log | 0.000s | 120 | reference |") != std::string::npos);
+    
+    // Nothing applied: offsets are still listed, without a summary bullet
+    Report quiet;
+    estimate.offsets[0].applied = false;
+    narrator.describe_clock_skew(quiet, estimate);
+    REQUIRE(quiet.clock_offsets.size() == 2);
+    REQUIRE(quiet.summary.empty());
+}
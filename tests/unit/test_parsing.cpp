@@ -1,6 +1,8 @@
 #include <catch2/catch_test_macros.hpp>
 #include "logstory/parsing/severity_detector.hpp"
 #include "logstory/parsing/kv_extractor.hpp"
+#include "logstory/parsing/event_parser.hpp"
+#include "logstory/analysis/window.hpp"
 
 using namespace logstory::parsing;
 using namespace logstory::core;
@@ -157,3 +159,59 @@ TEST_CASE("KVExtractor handles real log example", "[kv_extractor]") {
     REQUIRE(tags["status"] == "success");
     REQUIRE(tags["duration_ms"] == "123");
 }
+
+TEST_CASE("parse_numeric_tag types numbers and normalizes units", "[kv_extractor][numeric]") {
+    REQUIRE(parse_numeric_tag("123") == 123.0);
+    REQUIRE(parse_numeric_tag("-4.5") == -4.5);
+    REQUIRE(parse_numeric_tag("87ms") == 87.0);
+    REQUIRE(parse_numeric_tag("1.5s") == 1500.0);
+    REQUIRE(parse_numeric_tag("250us") == 0.25);
+    REQUIRE(parse_numeric_tag("2KB") == 2048.0);
+    REQUIRE(parse_numeric_tag("3mb") == 3.0 * 1024 * 1024);
+    
+    REQUIRE_FALSE(parse_numeric_tag("").has_value());
+    REQUIRE_FALSE(parse_numeric_tag("abc").has_value());
+    REQUIRE_FALSE(parse_numeric_tag("0x1f").has_value());
+    REQUIRE_FALSE(parse_numeric_tag("12abc").has_value());
+    REQUIRE_FALSE(parse_numeric_tag("1e9").has_value());
+    REQUIRE_FALSE(parse_numeric_tag(".").has_value());
+}
+
+// Event Parser Filter Tests
+
+TEST_CASE("EventParser filter drops records before KV extraction", "[event_parser][filter]") {
+    std::vector<logstory::io::Record> records;
+    const char* lines[] = {
+        "2024-03-06T09:59:59Z ERROR too early user=a",
+        "2024-03-06T10:00:00Z INFO at start user=b",
+        "2024-03-06T10:30:00Z ERROR in window user=c",
+        "no timestamp ERROR user=d",
+        "2024-03-06T11:00:01Z ERROR too late user=e"
+    };
+    uint32_t line_no = 1;
+    for (const char* line : lines) {
+        records.emplace_back(SourceRef("app.log", line_no++), line);
+    }
+    
+    EventFilter filter;
+    filter.start = logstory::analysis::parse_iso8601("2024-03-06T10:00:00Z");
+    filter.end = logstory::analysis::parse_iso8601("2024-03-06T11:00:00Z");
+    
+    EventParser parser;
+    parser.set_filter(filter);
+    auto events = parser.parse_all(records);
+    
+    REQUIRE(events.size() == 2);
+    REQUIRE(events[0].id == 1);
+    REQUIRE(events[0].tags.at("user") == "b");
+    REQUIRE(events[1].id == 2);
+    REQUIRE(events[1].src.start_line == 3);
+    REQUIRE(parser.filtered_count() == 3);
+    
+    filter.min_severity = Severity::WARN;
+    EventParser sev_parser;
+    sev_parser.set_filter(filter);
+    auto errors = sev_parser.parse_all(records);
+    REQUIRE(errors.size() == 1);
+    REQUIRE(errors[0].tags.at("user") == "c");
+}
@@ -5,6 +5,8 @@
 #include "logstory/rules/builtin/crash_loop_rule.hpp"
 #include "logstory/rules/builtin/retry_to_timeout_rule.hpp"
 #include "logstory/rules/builtin/error_burst_after_change_rule.hpp"
+#include "logstory/rules/builtin/source_silence_rule.hpp"
+#include "logstory/rules/builtin/level_shift_rule.hpp"
 #include "logstory/analysis/stats_builder.hpp"
 #include "logstory/analysis/anomaly_detector.hpp"
 
@@ -167,7 +169,8 @@ TEST_CASE("CrashLoopRule detects crash loops from anomalies", "[rules][crash_loo
     std::vector<Anomaly> anomalies = detector.detect(events);
     
     RuleContext ctx;
-    ctx.events = &events;
+    EventView view(events);
+    ctx.events = &view;
     ctx.anomalies = &anomalies;
     
     auto findings = rule.evaluate(ctx);
@@ -188,6 +191,99 @@ TEST_CASE("CrashLoopRule handles no anomalies", "[rules][crash_loop]") {
     REQUIRE(findings.empty());
 }
 
+// ============================================================================
+// SourceSilenceRule Tests
+// ============================================================================
+
+TEST_CASE("SourceSilenceRule reports missing heartbeats", "[rules][source_silence]") {
+    SourceSilenceRule rule;
+    
+    std::vector<Event> events;
+    auto now = std::chrono::system_clock::now();
+    for (EventId i = 1; i <= 10; ++i) {
+        events.push_back(create_rule_test_event(i, Severity::INFO, "tick", now + std::chrono::seconds(10 * i)));
+        events.back().src.source_path = "worker.log";
+    }
+    events.push_back(create_rule_test_event(11, Severity::INFO, "tick", now + std::chrono::minutes(20)));
+    events.back().src.source_path = "worker.log";
+    
+    std::vector<Anomaly> anomalies = MissingHeartbeatDetector().detect(events);
+    REQUIRE(anomalies.size() == 1);
+    
+    RuleContext ctx;
+    EventView view(events);
+    ctx.events = &view;
+    ctx.anomalies = &anomalies;
+    
+    auto findings = rule.evaluate(ctx);
+    REQUIRE(findings.size() == 1);
+    REQUIRE(findings[0].severity == FindingSeverity::HIGH);
+    REQUIRE(findings[0].summary.find("worker.log") != std::string::npos);
+    REQUIRE(findings[0].evidence.size() == 2);
+    REQUIRE(findings[0].evidence[0].event_id == 10);
+    REQUIRE(findings[0].evidence[1].event_id == 11);
+}
+
+TEST_CASE("SourceSilenceRule ignores other anomalies", "[rules][source_silence]") {
+    SourceSilenceRule rule;
+    
+    Anomaly burst;
+    burst.type = Anomaly::Type::ERROR_BURST;
+    std::vector<Anomaly> anomalies = {burst};
+    
+    RuleContext ctx;
+    ctx.anomalies = &anomalies;
+    REQUIRE(rule.evaluate(ctx).empty());
+    
+    RuleContext empty_ctx;
+    REQUIRE(rule.evaluate(empty_ctx).empty());
+}
+
+// ============================================================================
+// LevelShiftRule Tests
+// ============================================================================
+
+TEST_CASE("LevelShiftRule reports rising error rates with evidence", "[rules][level_shift]") {
+    LevelShiftRule rule;
+    
+    auto now = std::chrono::system_clock::now();
+    std::vector<Event> events;
+    events.push_back(create_rule_test_event(1, Severity::ERROR, "early failure", now));
+    for (EventId i = 2; i <= 10; ++i) {
+        events.push_back(create_rule_test_event(i, Severity::ERROR, "db timeout",
+                                                now + std::chrono::minutes(30 + i)));
+    }
+    
+    Anomaly rise;
+    rise.type = Anomaly::Type::LEVEL_SHIFT;
+    rise.severity = Severity::ERROR;
+    rise.rate_before = 0.1;
+    rise.rate_after = 2.0;
+    rise.confidence = 0.9;
+    rise.start_time = now + std::chrono::minutes(30);
+    rise.end_time = now + std::chrono::minutes(35);
+    rise.description = "ERROR rate rose from 0.10 to 2.00 per minute and stayed there";
+    
+    Anomaly info_drop = rise;
+    info_drop.severity = Severity::INFO;
+    Anomaly error_drop = rise;
+    error_drop.rate_before = 2.0;
+    error_drop.rate_after = 0.1;
+    
+    std::vector<Anomaly> anomalies = {rise, info_drop, error_drop};
+    RuleContext ctx;
+    EventView view(events);
+    ctx.events = &view;
+    ctx.anomalies = &anomalies;
+    
+    auto findings = rule.evaluate(ctx);
+    REQUIRE(findings.size() == 1);
+    REQUIRE(findings[0].title == "Sustained Error Rate Increase");
+    REQUIRE(findings[0].severity == FindingSeverity::HIGH);
+    REQUIRE(findings[0].evidence.size() == 5);
+    REQUIRE(findings[0].evidence[0].event_id == 2);
+}
+
 // ============================================================================
 // RetryToTimeoutRule Tests
 // ============================================================================
@@ -204,7 +300,8 @@ TEST_CASE("RetryToTimeoutRule detects retry to timeout pattern", "[rules][retry_
     events.push_back(create_rule_test_event(4, Severity::ERROR, "Operation timed out", now + std::chrono::seconds(15)));
     
     RuleContext ctx;
-    ctx.events = &events;
+    EventView view(events);
+    ctx.events = &view;
     
     auto findings = rule.evaluate(ctx);
     
@@ -214,6 +311,33 @@ TEST_CASE("RetryToTimeoutRule detects retry to timeout pattern", "[rules][retry_
     REQUIRE(findings[0].evidence.size() == 4); // 3 retries + 1 timeout
 }
 
+TEST_CASE("RetryToTimeoutRule takes candidates from feature bits", "[rules][retry_timeout][features]") {
+    RetryToTimeoutRule rule;
+    
+    std::vector<Event> events;
+    auto now = std::chrono::system_clock::now();
+    
+    events.push_back(create_rule_test_event(1, Severity::INFO, "Connecting", now));
+    events.push_back(create_rule_test_event(2, Severity::WARN, "RETRYING upstream", now + std::chrono::seconds(5)));
+    events.push_back(create_rule_test_event(3, Severity::WARN, "Next attempt in 2s", now + std::chrono::seconds(10)));
+    events.push_back(create_rule_test_event(4, Severity::ERROR, "Request Timed Out", now + std::chrono::seconds(15)));
+    
+    RuleContext ctx;
+    EventView view(events);
+    ctx.events = &view;
+    auto scanned = rule.evaluate(ctx);
+    REQUIRE(scanned.size() == 1);
+    REQUIRE(scanned[0].evidence.size() == 3);
+    
+    // Precomputed feature bits give the same result
+    EventFeatures features;
+    features.build(events);
+    ctx.features = &features;
+    auto from_features = rule.evaluate(ctx);
+    REQUIRE(from_features.size() == 1);
+    REQUIRE(from_features[0].evidence.size() == scanned[0].evidence.size());
+}
+
 TEST_CASE("RetryToTimeoutRule ignores retries without timeout", "[rules][retry_timeout]") {
     RetryToTimeoutRule rule;
     
@@ -225,7 +349,8 @@ TEST_CASE("RetryToTimeoutRule ignores retries without timeout", "[rules][retry_t
     events.push_back(create_rule_test_event(3, Severity::INFO, "Success", now + std::chrono::seconds(10)));
     
     RuleContext ctx;
-    ctx.events = &events;
+    EventView view(events);
+    ctx.events = &view;
     
     auto findings = rule.evaluate(ctx);
     
@@ -237,7 +362,8 @@ TEST_CASE("RetryToTimeoutRule handles empty events", "[rules][retry_timeout]") {
     
     std::vector<Event> events;
     RuleContext ctx;
-    ctx.events = &events;
+    EventView view(events);
+    ctx.events = &view;
     
     auto findings = rule.evaluate(ctx);
     
@@ -277,7 +403,8 @@ TEST_CASE("ErrorBurstAfterChangeRule detects errors after deployment", "[rules][
     std::vector<Anomaly> anomalies = burst_detector.detect(events, stats);
     
     RuleContext ctx;
-    ctx.events = &events;
+    EventView view(events);
+    ctx.events = &view;
     ctx.stats = &stats;
     ctx.anomalies = &anomalies;
     
@@ -311,7 +438,8 @@ TEST_CASE("ErrorBurstAfterChangeRule ignores bursts without nearby changes", "[r
     std::vector<Anomaly> anomalies = burst_detector.detect(events, stats);
     
     RuleContext ctx;
-    ctx.events = &events;
+    EventView view(events);
+    ctx.events = &view;
     ctx.stats = &stats;
     ctx.anomalies = &anomalies;
     
@@ -337,7 +465,8 @@ TEST_CASE("ErrorBurstAfterChangeRule handles no change events", "[rules][error_b
     std::vector<Anomaly> anomalies = burst_detector.detect(events, stats);
     
     RuleContext ctx;
-    ctx.events = &events;
+    EventView view(events);
+    ctx.events = &view;
     ctx.stats = &stats;
     ctx.anomalies = &anomalies;
     
@@ -345,3 +474,40 @@ TEST_CASE("ErrorBurstAfterChangeRule handles no change events", "[rules][error_b
     
     REQUIRE(findings.empty());
 }
+
+TEST_CASE("ErrorBurstAfterChangeRule resolves burst evidence through the shared lookup", "[rules][error_burst_change][lookup]") {
+    ErrorBurstAfterChangeRule rule;
+    
+    std::vector<Event> events;
+    auto now = std::chrono::system_clock::now();
+    events.push_back(create_rule_test_event(1, Severity::INFO, "Deployment started", now));
+    for (int i = 0; i < 10; i++) {
+        events.push_back(create_rule_test_event(i + 2, Severity::ERROR, "Post-deploy error",
+            now + std::chrono::minutes(2) + std::chrono::seconds(i)));
+    }
+    
+    // The detector's evidence names the last errors of the burst; a scan
+    // would pick the first ones instead
+    Anomaly burst;
+    burst.type = Anomaly::Type::ERROR_BURST;
+    burst.start_time = now + std::chrono::minutes(2);
+    burst.end_time = now + std::chrono::minutes(3);
+    burst.evidence_ids = {9, 10, 11, 999};
+    std::vector<Anomaly> anomalies = {burst};
+    
+    EventLookup lookup(events);
+    RuleContext ctx;
+    EventView view(events);
+    ctx.events = &view;
+    ctx.anomalies = &anomalies;
+    ctx.lookup = &lookup;
+    
+    auto findings = rule.evaluate(ctx);
+    
+    REQUIRE(findings.size() == 1);
+    const auto& evidence = findings[0].evidence;
+    REQUIRE(evidence.size() == 4);  // The change plus three resolvable errors
+    REQUIRE(evidence[0].event_id == 1);
+    REQUIRE(evidence[1].event_id == 9);
+    REQUIRE(evidence[3].event_id == 11);
+}
@@ -2,6 +2,10 @@
 #include "logstory/analysis/stats.hpp"
 #include "logstory/analysis/stats_builder.hpp"
 #include "logstory/analysis/anomaly_detector.hpp"
+#include "logstory/core/thread_pool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <map>
 
 using namespace logstory::analysis;
 using namespace logstory::core;
@@ -56,6 +60,70 @@ TEST_CASE("TimeSeries handles empty series", "[stats][timeseries]") {
     REQUIRE_FALSE(ts.max_point().has_value());
 }
 
+TEST_CASE("TimeSeries keeps points in time order for out-of-order input", "[stats][timeseries]") {
+    TimeSeries ts(std::chrono::minutes(1));
+    
+    auto base = std::chrono::system_clock::time_point(std::chrono::hours(24 * 365 * 50));
+    ts.add_event(base + std::chrono::minutes(10));
+    ts.add_event(base + std::chrono::minutes(2));
+    ts.add_event(base + std::chrono::minutes(5));
+    ts.add_event(base + std::chrono::minutes(2));
+    ts.add_event(base + std::chrono::minutes(12));
+    ts.add_event(base + std::chrono::minutes(10));
+    
+    REQUIRE(ts.points.size() == 4);
+    REQUIRE(ts.total_count() == 6);
+    for (size_t i = 1; i < ts.points.size(); ++i) {
+        REQUIRE(ts.points[i - 1].timestamp < ts.points[i].timestamp);
+    }
+    REQUIRE(ts.points[0].timestamp == base + std::chrono::minutes(2));
+    REQUIRE(ts.points[0].count == 2);
+    REQUIRE(ts.points[2].count == 2);
+}
+
+TEST_CASE("TimeSeries falls back to sparse buckets for very wide ranges", "[stats][timeseries]") {
+    TimeSeries ts(std::chrono::minutes(1));
+    
+    auto base = std::chrono::system_clock::time_point(std::chrono::hours(24 * 365 * 50));
+    auto far = base + std::chrono::minutes(TimeSeries::kMaxDenseBuckets * 2);
+    ts.add_event(base);
+    ts.add_event(far);
+    ts.add_event(base + std::chrono::minutes(1));
+    ts.add_event(far);
+    
+    REQUIRE(ts.points.size() == 3);
+    REQUIRE(ts.points[0].timestamp == base);
+    REQUIRE(ts.points[1].timestamp == base + std::chrono::minutes(1));
+    REQUIRE(ts.points[2].count == 2);
+}
+
+TEST_CASE("TimeSeriesPyramid rolls up coarser levels and answers range counts", "[stats][timeseries][pyramid]") {
+    TimeSeries ts(std::chrono::minutes(1));
+    auto base = std::chrono::system_clock::time_point(std::chrono::hours(24 * 365 * 50));
+    for (int i = 0; i < 180; i++) {
+        ts.add_event(base + std::chrono::minutes(i));
+    }
+    ts.add_count(base + std::chrono::minutes(10), 4);
+    
+    auto pyramid = TimeSeriesPyramid::build(ts, {std::chrono::minutes(5), std::chrono::minutes(7),
+                                                 std::chrono::hours(1)});
+    
+    // Every multiple of the base bucket size gets a level, finest first
+    REQUIRE(pyramid.levels.size() == 4);
+    REQUIRE(pyramid.level(std::chrono::minutes(5))->points.size() == 36);
+    REQUIRE(pyramid.level(std::chrono::hours(1))->points.size() == 3);
+    REQUIRE(pyramid.level(std::chrono::hours(1))->points[0].count == 64);
+    REQUIRE(pyramid.level(std::chrono::hours(24)) == nullptr);
+    
+    REQUIRE(pyramid.range_count(base, base + std::chrono::minutes(20)) == 24);
+    REQUIRE(pyramid.range_count(base + std::chrono::minutes(11), base + std::chrono::minutes(11)) == 0);
+    REQUIRE(pyramid.range_count(base, base + std::chrono::hours(3), 3) == 184);
+    
+    REQUIRE(pyramid.level_for_span(std::chrono::minutes(179), 200).bucket_size == std::chrono::minutes(1));
+    REQUIRE(pyramid.level_for_span(std::chrono::minutes(179), 40).bucket_size == std::chrono::minutes(5));
+    REQUIRE(pyramid.level_for_span(std::chrono::hours(24 * 30), 10).bucket_size == std::chrono::hours(1));
+}
+
 // ============================================================================
 // Stats Tests
 // ============================================================================
@@ -195,6 +263,542 @@ TEST_CASE("StatsBuilder handles empty events", "[stats][builder]") {
     REQUIRE(stats.severity_counts.empty());
 }
 
+TEST_CASE("Stats merge of chunk partials matches a single build", "[stats][builder][merge]") {
+    StatsConfig config;
+    config.parallel_chunk_events = 7;
+    config.top_n_patterns = 3;
+    StatsBuilder builder(config);
+    
+    auto base = std::chrono::system_clock::from_time_t(1709719200);
+    std::vector<Event> events;
+    for (EventId i = 1; i <= 50; i++) {
+        Severity sev = (i % 5 == 0) ? Severity::ERROR : Severity::INFO;
+        std::string msg = (i % 3 == 0) ? "Connection failed after " + std::to_string(i) + " ms"
+                                       : "Request handled for user " + std::to_string(i);
+        Event e = create_test_event(i, sev, msg, base + std::chrono::seconds(i * 17));
+        e.src.source_path = (i % 2 == 0) ? "a.log" : "b.log";
+        events.push_back(e);
+    }
+    
+    Stats serial = builder.build(events);
+    
+    // Merge uneven partials in a different grouping
+    Stats left = builder.build_partial(events, 0, 13);
+    Stats right = builder.build_partial(events, 30, 50);
+    right.merge(builder.build_partial(events, 13, 30));
+    left.merge(right);
+    REQUIRE(left.frequent_patterns.empty());
+    builder.finalize(left);
+    
+    ThreadPool pool(4);
+    Stats parallel = builder.build_parallel(events, pool);
+    
+    for (const Stats* merged : {&left, &parallel}) {
+        REQUIRE(merged->total_events == serial.total_events);
+        REQUIRE(merged->severity_counts == serial.severity_counts);
+        REQUIRE(merged->source_counts == serial.source_counts);
+        REQUIRE(merged->start_time == serial.start_time);
+        REQUIRE(merged->end_time == serial.end_time);
+        
+        const auto& errors = merged->severity_time_series.at(Severity::ERROR);
+        const auto& serial_errors = serial.severity_time_series.at(Severity::ERROR);
+        REQUIRE(errors.points.size() == serial_errors.points.size());
+        for (size_t i = 0; i < errors.points.size(); i++) {
+            REQUIRE(errors.points[i].timestamp == serial_errors.points[i].timestamp);
+            REQUIRE(errors.points[i].count == serial_errors.points[i].count);
+        }
+        
+        REQUIRE(merged->frequent_patterns.size() == serial.frequent_patterns.size());
+        for (size_t i = 0; i < serial.frequent_patterns.size(); i++) {
+            REQUIRE(merged->frequent_patterns[i].pattern == serial.frequent_patterns[i].pattern);
+            REQUIRE(merged->frequent_patterns[i].count == serial.frequent_patterns[i].count);
+            REQUIRE(merged->frequent_patterns[i].max_severity == serial.frequent_patterns[i].max_severity);
+        }
+        REQUIRE(merged->severity_pyramids.size() == serial.severity_pyramids.size());
+    }
+}
+
+// ============================================================================
+// PartitionedStats Tests
+// ============================================================================
+
+// `count` events cycling through `services`; every error_every-th is an ERROR
+std::vector<Event> create_partitioned_events(size_t count, const std::vector<std::string>& services,
+                                             size_t error_every) {
+    auto base = std::chrono::system_clock::from_time_t(1709719200);
+    std::vector<Event> events;
+    for (size_t i = 0; i < count; i++) {
+        Severity sev = (i % error_every == 0) ? Severity::ERROR : Severity::INFO;
+        Event e = create_test_event(i + 1, sev, "Request handled", base + std::chrono::seconds(i * 11));
+        e.tags["service"] = services[i % services.size()];
+        e.src.source_path = (i % 2 == 0) ? "a.log" : "b.log";
+        events.push_back(e);
+    }
+    return events;
+}
+
+TEST_CASE("StatsBuilder partitions events by a tag or by source", "[stats][partition]") {
+    auto base = std::chrono::system_clock::from_time_t(1709719200);
+    std::vector<Event> events;
+    auto add = [&](Severity sev, const std::string& service, int second) {
+        Event e = create_test_event(events.size() + 1, sev, "msg", base + std::chrono::seconds(second));
+        if (!service.empty()) {
+            e.tags["service"] = service;
+        }
+        events.push_back(e);
+    };
+    add(Severity::INFO, "api", 0);
+    add(Severity::ERROR, "api", 70);
+    add(Severity::INFO, "api", 80);
+    add(Severity::ERROR, "checkout", 10);
+    add(Severity::WARN, "", 20);
+    
+    StatsConfig config;
+    config.partition_by = "service";
+    Stats stats = StatsBuilder(config).build(events);
+    
+    const auto& partitioned = stats.partitions;
+    REQUIRE(partitioned.dimension == "service");
+    REQUIRE(partitioned.partitions.size() == 2);
+    REQUIRE(partitioned.unkeyed_events == 1);
+    
+    const auto& api = partitioned.partitions.at("api");
+    REQUIRE(api.total_events == 3);
+    REQUIRE(api.count(Severity::ERROR) == 1);
+    REQUIRE(std::abs(api.error_rate() - 1.0 / 3.0) < 1e-9);
+    REQUIRE(api.start_time == base);
+    REQUIRE(api.end_time == base + std::chrono::seconds(80));
+    REQUIRE(api.severity_time_series.at(Severity::INFO).points.size() == 2);
+    REQUIRE(partitioned.partitions.at("checkout").error_rate() == 1.0);
+    REQUIRE(partitioned.label("api") == "service=api");
+    
+    // By source every event has a key; partitioning is off by default
+    config.partition_by = PartitionedStats::kSourceDimension;
+    Stats by_source = StatsBuilder(config).build(events);
+    REQUIRE(by_source.partitions.partitions.size() == 1);
+    REQUIRE(by_source.partitions.partitions.at("test.log").total_events == 5);
+    REQUIRE(by_source.partitions.label("test.log") == "test.log");
+    REQUIRE(StatsBuilder().build(events).partitions.empty());
+}
+
+TEST_CASE("build_parallel reduces partitions like a serial build", "[stats][partition][merge]") {
+    std::vector<std::string> services;
+    for (int i = 0; i < 13; i++) {
+        services.push_back("svc-" + std::to_string(i));
+    }
+    auto events = create_partitioned_events(500, services, 4);
+    
+    StatsConfig config;
+    config.partition_by = "service";
+    config.parallel_chunk_events = 37;
+    StatsBuilder builder(config);
+    
+    Stats serial = builder.build(events);
+    ThreadPool pool(4);
+    Stats parallel = builder.build_parallel(events, pool);
+    
+    REQUIRE(parallel.partitions.dimension == "service");
+    REQUIRE(parallel.partitions.partitions.size() == serial.partitions.partitions.size());
+    for (const auto& [key, expected] : serial.partitions.partitions) {
+        const auto& actual = parallel.partitions.partitions.at(key);
+        REQUIRE(actual.total_events == expected.total_events);
+        REQUIRE(actual.severity_counts == expected.severity_counts);
+        REQUIRE(actual.start_time == expected.start_time);
+        REQUIRE(actual.end_time == expected.end_time);
+        
+        const auto& series = actual.severity_time_series.at(Severity::INFO).points;
+        const auto& serial_series = expected.severity_time_series.at(Severity::INFO).points;
+        REQUIRE(series.size() == serial_series.size());
+        for (size_t i = 0; i < series.size(); i++) {
+            REQUIRE(series[i].timestamp == serial_series[i].timestamp);
+            REQUIRE(series[i].count == serial_series[i].count);
+        }
+    }
+    REQUIRE(parallel.partitions.top_by_error_rate(5) == serial.partitions.top_by_error_rate(5));
+}
+
+TEST_CASE("PartitionedStats ranks partitions by error rate", "[stats][partition]") {
+    PartitionedStats partitioned;
+    partitioned.dimension = "host";
+    auto fill = [&partitioned](const std::string& key, size_t errors, size_t total) {
+        auto& partition = partitioned.partitions[key];
+        partition.total_events = total;
+        partition.severity_counts[Severity::ERROR] = errors;
+    };
+    fill("a", 1, 10);    // 10%
+    fill("b", 5, 10);    // 50%
+    fill("c", 10, 20);   // 50%, more errors than b
+    fill("d", 3, 3);     // 100% but tiny
+    fill("e", 0, 100);
+    
+    REQUIRE(partitioned.top_by_error_rate(3) == std::vector<std::string>{"d", "c", "b"});
+    REQUIRE(partitioned.top_by_error_rate(3, 10) == std::vector<std::string>{"c", "b", "a"});
+    REQUIRE(partitioned.top_by_error_rate(10, 10).size() == 4);
+    REQUIRE(partitioned.top_by_error_rate(0).empty());
+}
+
+TEST_CASE("PartitionedStats folds the smallest partitions into other", "[stats][partition]") {
+    auto events = create_partitioned_events(100, {"a", "a", "a", "b", "b", "c", "d"}, 5);
+    
+    StatsConfig config;
+    config.partition_by = "service";
+    config.max_partitions = 3;
+    Stats stats = StatsBuilder(config).build(events);
+    
+    const auto& partitions = stats.partitions.partitions;
+    REQUIRE(partitions.size() == 3);
+    REQUIRE(partitions.count("a") == 1);
+    REQUIRE(partitions.count("b") == 1);
+    
+    const auto& other = partitions.at(PartitionedStats::kOtherPartition);
+    REQUIRE(partitions.at("a").total_events == 44);
+    REQUIRE(other.total_events == 28);  // 14 each of c and d
+    size_t total = 0;
+    for (const auto& [key, partition] : partitions) {
+        total += partition.total_events;
+    }
+    REQUIRE(total == events.size());
+    REQUIRE(stats.partitions.label(PartitionedStats::kOtherPartition) == "(other)");
+    
+    // "(other)" is not ranked against real partitions
+    auto top = stats.partitions.top_by_error_rate(10);
+    REQUIRE(std::find(top.begin(), top.end(), PartitionedStats::kOtherPartition) == top.end());
+}
+
+TEST_CASE("PartitionedStats caps partitions while building", "[stats][partition]") {
+    // One partition per request_id would mean 500 sets of series
+    auto events = create_partitioned_events(500, {"api"}, 5);
+    for (size_t i = 0; i < events.size(); i++) {
+        events[i].tags["request_id"] = "req-" + std::to_string(i);
+    }
+    
+    StatsConfig config;
+    config.partition_by = "request_id";
+    config.max_partitions = 10;
+    StatsBuilder builder(config);
+    
+    // A partial keeps every key exactly; finalize folds it down to the cap
+    Stats partial = builder.build_partial(events, 0, 250);
+    partial.merge(builder.build_partial(events, 250, 500));
+    REQUIRE(partial.partitions.partitions.size() == 500);
+    builder.finalize(partial);
+    REQUIRE(partial.partitions.partitions.size() == 10);
+    
+    // build() admits only the keys it keeps, so no series exist for the rest
+    Stats stats = builder.build(events);
+    REQUIRE(stats.partitions.admitted.has_value());
+    REQUIRE(stats.partitions.admitted->size() == 9);
+    REQUIRE(stats.partitions.partitions.size() == 10);
+    REQUIRE(stats.partitions.partitions.at(PartitionedStats::kOtherPartition).total_events == 491);
+}
+
+TEST_CASE("PartitionedStats keeps a large partition that arrives last", "[stats][partition]") {
+    // Eight small services first, then the busiest and most failing one
+    auto base = std::chrono::system_clock::from_time_t(1709719200);
+    std::vector<Event> events;
+    for (size_t s = 0; s < 8; s++) {
+        for (size_t i = 0; i < 10; i++) {
+            Event e = create_test_event(events.size() + 1, Severity::INFO, "Request handled",
+                                        base + std::chrono::seconds(events.size()));
+            e.tags["service"] = "s" + std::to_string(s);
+            events.push_back(e);
+        }
+    }
+    for (size_t i = 0; i < 360; i++) {
+        Event e = create_test_event(events.size() + 1, Severity::ERROR, "Checkout failed",
+                                    base + std::chrono::seconds(events.size()));
+        e.tags["service"] = "checkout";
+        events.push_back(e);
+    }
+    
+    StatsConfig config;
+    config.partition_by = "service";
+    config.max_partitions = 5;
+    config.parallel_chunk_events = 50;
+    ThreadPool pool(4);
+    Stats serial = StatsBuilder(config).build(events);
+    Stats parallel = StatsBuilder(config).build_parallel(events, pool);
+    
+    for (const Stats* stats : {&serial, &parallel}) {
+        const auto& partitions = stats->partitions.partitions;
+        REQUIRE(partitions.size() == 5);
+        REQUIRE(partitions.at("checkout").total_events == 360);
+        REQUIRE(partitions.at("checkout").count(Severity::ERROR) == 360);
+        REQUIRE(partitions.at(PartitionedStats::kOtherPartition).total_events == 50);
+        REQUIRE(stats->partitions.top_by_error_rate(1) == std::vector<std::string>{"checkout"});
+    }
+}
+
+TEST_CASE("build_parallel matches build per partition", "[stats][partition][parallel]") {
+    // Keys of very different sizes, interleaved so chunks see them unevenly
+    auto events = create_partitioned_events(2000, {"a", "a", "a", "a", "b", "b", "c", "d", "e", "f"}, 7);
+    for (size_t i = 0; i < events.size(); i += 97) {
+        events[i].tags["service"] = "rare-" + std::to_string(i);
+    }
+    
+    StatsConfig config;
+    config.partition_by = "service";
+    config.max_partitions = 4;
+    config.parallel_chunk_events = 64;
+    ThreadPool pool(4);
+    Stats serial = StatsBuilder(config).build(events);
+    Stats parallel = StatsBuilder(config).build_parallel(events, pool);
+    
+    const auto& expected = serial.partitions.partitions;
+    const auto& actual = parallel.partitions.partitions;
+    REQUIRE(expected.size() == 4);
+    REQUIRE(actual.size() == expected.size());
+    for (const auto& [key, partition] : expected) {
+        REQUIRE(actual.count(key) == 1);
+        const auto& other = actual.at(key);
+        REQUIRE(other.total_events == partition.total_events);
+        REQUIRE(other.severity_counts == partition.severity_counts);
+        REQUIRE(other.start_time == partition.start_time);
+        REQUIRE(other.end_time == partition.end_time);
+        for (const auto& [sev, series] : partition.severity_time_series) {
+            const auto& points = other.severity_time_series.at(sev).points;
+            REQUIRE(points.size() == series.points.size());
+            for (size_t i = 0; i < points.size(); i++) {
+                REQUIRE(points[i].timestamp == series.points[i].timestamp);
+                REQUIRE(points[i].count == series.points[i].count);
+            }
+        }
+    }
+}
+
+// ============================================================================
+// HeavyHitters Tests
+// ============================================================================
+
+TEST_CASE("HeavyHitters is exact below capacity", "[stats][heavy_hitters]") {
+    HeavyHitters hh(8);
+    hh.add("a", Severity::INFO, 5);
+    hh.add("b", Severity::ERROR);
+    hh.add("a", Severity::WARN);
+    
+    auto top = hh.top(10);
+    REQUIRE(top.size() == 2);
+    REQUIRE(top[0].key == "a");
+    REQUIRE(top[0].count == 6);
+    REQUIRE(top[0].error == 0);
+    REQUIRE(top[0].max_severity == Severity::WARN);
+    REQUIRE(hh.error_bound() == 0);
+    REQUIRE(hh.total() == 7);
+}
+
+TEST_CASE("HeavyHitters bounds counts for skewed high-cardinality input", "[stats][heavy_hitters]") {
+    // Three heavy keys among thousands of singletons
+    const size_t capacity = 32;
+    HeavyHitters hh(capacity);
+    std::map<std::string, size_t> truth;
+    for (int i = 0; i < 6000; i++) {
+        std::string key;
+        if (i % 4 == 0) key = "heavy-a";
+        else if (i % 10 == 1) key = "heavy-b";
+        else if (i % 25 == 2) key = "heavy-c";
+        else key = "rare-" + std::to_string(i);
+        truth[key]++;
+        hh.add(key, Severity::INFO);
+    }
+    
+    REQUIRE(hh.size() == capacity);
+    REQUIRE(hh.error_bound() <= hh.total() / capacity);
+    
+    auto top = hh.top(3);
+    REQUIRE(top[0].key == "heavy-a");
+    REQUIRE(top[1].key == "heavy-b");
+    REQUIRE(top[2].key == "heavy-c");
+    for (const auto& counter : top) {
+        REQUIRE(counter.guaranteed_count() <= truth[counter.key]);
+        REQUIRE(counter.count >= truth[counter.key]);
+        REQUIRE(counter.error <= hh.total() / capacity);
+    }
+}
+
+TEST_CASE("HeavyHitters merges shards with the same guarantees", "[stats][heavy_hitters]") {
+    const size_t capacity = 16;
+    HeavyHitters shards[3] = {HeavyHitters(capacity), HeavyHitters(capacity), HeavyHitters(capacity)};
+    std::map<std::string, size_t> truth;
+    for (int i = 0; i < 3000; i++) {
+        std::string key = (i % 3 == 0) ? "hot" : (i % 7 == 0) ? "warm" : "cold-" + std::to_string(i);
+        truth[key]++;
+        shards[i % 3 == 0 ? (i / 3) % 3 : i % 3].add(key, Severity::INFO);
+    }
+    
+    HeavyHitters merged = shards[0];
+    merged.merge(shards[1]);
+    merged.merge(shards[2]);
+    
+    REQUIRE(merged.total() == 3000);
+    REQUIRE(merged.size() <= capacity);
+    auto top = merged.top(2);
+    REQUIRE(top[0].key == "hot");
+    REQUIRE(top[1].key == "warm");
+    for (const auto& counter : top) {
+        REQUIRE(counter.guaranteed_count() <= truth[counter.key]);
+        REQUIRE(counter.count >= truth[counter.key]);
+    }
+    
+    REQUIRE(HeavyHitters::capacity_for_error(0.01) == 100);
+    REQUIRE(HeavyHitters::capacity_for_budget(1 << 20) > 1000);
+}
+
+// ============================================================================
+// HyperLogLog Tests
+// ============================================================================
+
+TEST_CASE("HyperLogLog counts exactly below the threshold", "[stats][hyperloglog]") {
+    HyperLogLog hll;
+    for (int round = 0; round < 3; round++) {
+        for (size_t i = 0; i < HyperLogLog::kExactThreshold; i++) {
+            hll.add("user-" + std::to_string(i));
+        }
+    }
+    REQUIRE(hll.is_exact());
+    REQUIRE(hll.estimate() == HyperLogLog::kExactThreshold);
+    
+    hll.add("one-more");
+    REQUIRE_FALSE(hll.is_exact());
+}
+
+TEST_CASE("HyperLogLog estimates large cardinalities and merges shards", "[stats][hyperloglog]") {
+    const size_t n = 100000;
+    HyperLogLog whole;
+    HyperLogLog shards[4];
+    for (size_t i = 0; i < n; i++) {
+        std::string value = "req-" + std::to_string(i);
+        whole.add(value);
+        shards[i % 4].add(value);
+        shards[(i + 1) % 4].add(value);  // Overlapping shards
+    }
+    
+    double error = std::abs(static_cast<double>(whole.estimate()) - n) / n;
+    REQUIRE(error < 0.05);
+    
+    HyperLogLog merged;
+    for (const auto& shard : shards) {
+        merged.merge(shard);
+    }
+    REQUIRE(merged.estimate() == whole.estimate());
+    
+    // Small exact sketches stay exact through a merge
+    HyperLogLog a, b;
+    a.add("x");
+    a.add("y");
+    b.add("y");
+    b.add("z");
+    a.merge(b);
+    REQUIRE(a.is_exact());
+    REQUIRE(a.estimate() == 3);
+}
+
+// ============================================================================
+// QuantileSketch Tests
+// ============================================================================
+
+TEST_CASE("QuantileSketch quantiles stay within relative accuracy", "[stats][quantile]") {
+    QuantileSketch sketch(0.01);
+    for (int i = 1; i <= 10000; i++) {
+        sketch.add(static_cast<double>(i));
+    }
+    
+    REQUIRE(sketch.count() == 10000);
+    REQUIRE(sketch.min() == 1.0);
+    REQUIRE(sketch.max() == 10000.0);
+    for (double q : {0.5, 0.95, 0.99}) {
+        double expected = q * 9999.0 + 1.0;
+        REQUIRE(std::abs(sketch.quantile(q) - expected) / expected <= 0.011);
+    }
+    REQUIRE(sketch.quantile(0.0) == 1.0);
+    REQUIRE(sketch.quantile(1.0) == 10000.0);
+    
+    QuantileSketch empty;
+    REQUIRE(empty.quantile(0.5) == 0.0);
+}
+
+TEST_CASE("QuantileSketch handles zero and negative values", "[stats][quantile]") {
+    QuantileSketch sketch;
+    for (int i = -50; i <= 50; i++) {
+        sketch.add(static_cast<double>(i));
+    }
+    REQUIRE(sketch.quantile(0.5) == 0.0);
+    REQUIRE(std::abs(sketch.quantile(0.0) + 50.0) <= 0.5);
+    REQUIRE(std::abs(sketch.quantile(0.25) + 25.0) <= 0.5);
+    REQUIRE(std::abs(sketch.quantile(0.75) - 25.0) <= 0.5);
+}
+
+TEST_CASE("QuantileSketch merges shards and bounds its bins", "[stats][quantile]") {
+    QuantileSketch whole;
+    QuantileSketch shards[3];
+    for (int i = 0; i < 30000; i++) {
+        double value = 1.0 + (i * 7919 % 100000) / 10.0;
+        whole.add(value);
+        shards[i % 3].add(value);
+    }
+    
+    QuantileSketch merged;
+    for (const auto& shard : shards) {
+        merged.merge(shard);
+    }
+    REQUIRE(merged.count() == whole.count());
+    REQUIRE(merged.min() == whole.min());
+    REQUIRE(merged.max() == whole.max());
+    for (double q : {0.1, 0.5, 0.95, 0.99}) {
+        REQUIRE(merged.quantile(q) == whole.quantile(q));
+    }
+    
+    // With few bins the low end collapses but high quantiles stay accurate
+    QuantileSketch small(0.01, 16);
+    for (int i = 1; i <= 100000; i++) {
+        small.add(static_cast<double>(i));
+    }
+    REQUIRE(std::abs(small.quantile(0.99) - 99000.0) / 99000.0 <= 0.011);
+    REQUIRE(small.quantile(0.01) >= 1.0);
+}
+
+TEST_CASE("StatsBuilder sketches numeric tags per bucket", "[stats][quantile]") {
+    auto base = std::chrono::system_clock::time_point(std::chrono::hours(480000));
+    std::vector<Event> events;
+    EventId id = 1;
+    for (int minute = 0; minute < 3; minute++) {
+        for (int i = 0; i < 20; i++) {
+            auto tp = base + std::chrono::minutes(minute) + std::chrono::seconds(i);
+            Event e = create_test_event(id++, Severity::INFO, "Request handled", tp);
+            // Minute 2 is ten times slower
+            e.tags["duration_ms"] = std::to_string((minute == 2 ? 1000 : 100) + i);
+            e.tags["request_id"] = std::to_string(id);
+            e.tags["status"] = "ok";
+            events.push_back(e);
+        }
+    }
+    
+    StatsBuilder builder;
+    Stats stats = builder.build(events);
+    
+    REQUIRE(stats.numeric_tags.size() == 1);  // request_id is an identifier
+    const auto& duration = stats.numeric_tags.at("duration_ms");
+    REQUIRE(duration.overall.count() == 60);
+    REQUIRE(duration.buckets.size() == 3);
+    REQUIRE(duration.buckets.begin()->first == base);
+    
+    auto changes = duration.changes(0.95, 2.0, 5);
+    REQUIRE(changes.size() == 1);
+    REQUIRE(changes[0].bucket == base + std::chrono::minutes(2));
+    REQUIRE(changes[0].before < 130.0);
+    REQUIRE(changes[0].after > 1000.0);
+    
+    // Parallel partials merge to the same sketches
+    StatsConfig config;
+    config.parallel_chunk_events = 7;
+    StatsBuilder parallel_builder(config);
+    ThreadPool pool(4);
+    Stats merged = parallel_builder.build_parallel(events, pool);
+    const auto& merged_duration = merged.numeric_tags.at("duration_ms");
+    REQUIRE(merged_duration.overall.count() == 60);
+    REQUIRE(merged_duration.overall.quantile(0.95) == duration.overall.quantile(0.95));
+    REQUIRE(merged_duration.buckets.size() == 3);
+}
+
 // ============================================================================
 // ErrorBurstDetector Tests
 // ============================================================================
@@ -231,6 +835,79 @@ TEST_CASE("ErrorBurstDetector detects error spike", "[anomaly][error_burst]") {
     REQUIRE(anomalies[0].confidence > 0.0);
 }
 
+TEST_CASE("ErrorBurstDetector scans the requested rollup resolution", "[anomaly][error_burst][pyramid]") {
+    std::vector<Event> events;
+    auto base = std::chrono::system_clock::time_point(std::chrono::hours(24 * 365 * 50));
+    
+    // One error per minute for two hours, plus a spread-out burst in hour three
+    EventId id = 1;
+    for (int i = 0; i < 120; i++) {
+        events.push_back(create_test_event(id++, Severity::ERROR, "Error",
+            base + std::chrono::minutes(i)));
+    }
+    for (int i = 0; i < 60; i++) {
+        for (int j = 0; j < 3; j++) {
+            events.push_back(create_test_event(id++, Severity::ERROR, "Burst error",
+                base + std::chrono::minutes(120 + i)));
+        }
+    }
+    
+    // Rollups are opt-in
+    REQUIRE(StatsBuilder().build(events).series_at(Severity::ERROR, std::chrono::hours(1)) == nullptr);
+    
+    StatsConfig stats_config;
+    stats_config.rollup_resolutions = {std::chrono::minutes(5), std::chrono::hours(1)};
+    Stats stats = StatsBuilder(stats_config).build(events);
+    REQUIRE(stats.series_at(Severity::ERROR, std::chrono::hours(1)) != nullptr);
+    
+    ErrorBurstConfig config;
+    config.min_errors_for_burst = 5;
+    config.threshold_multiplier = 1.5;
+    
+    // No single minute stands out enough at the base resolution
+    REQUIRE(ErrorBurstDetector(config).detect(events, stats).empty());
+    
+    config.resolution = std::chrono::hours(1);
+    auto hourly = ErrorBurstDetector(config).detect(events, stats);
+    REQUIRE(hourly.size() == 1);
+    REQUIRE(hourly[0].start_time == base + std::chrono::hours(2));
+    
+    config.resolution.reset();
+    config.max_buckets = 4;
+    REQUIRE(ErrorBurstDetector(config).detect(events, stats).size() == 1);
+    
+    // Span-based choice: the three-hour input fits 40 buckets at 5 minutes
+    REQUIRE(stats.series_for_span(Severity::ERROR, 200)->bucket_size == std::chrono::minutes(1));
+    REQUIRE(stats.series_for_span(Severity::ERROR, 40)->bucket_size == std::chrono::minutes(5));
+    REQUIRE(stats.series_for_span(Severity::ERROR, 4)->bucket_size == std::chrono::hours(1));
+    REQUIRE(stats.series_for_span(Severity::WARN, 4) == nullptr);
+    REQUIRE(StatsBuilder().build(events).series_for_span(Severity::ERROR, 4)->bucket_size ==
+            std::chrono::minutes(1));
+}
+
+TEST_CASE("ErrorBurstDetector merges consecutive hot buckets", "[anomaly][error_burst]") {
+    std::vector<Event> events;
+    auto base = std::chrono::system_clock::time_point(std::chrono::hours(24 * 365 * 50));
+    EventId id = 1;
+    for (int minute = 0; minute < 30; minute++) {
+        size_t count = (minute >= 10 && minute < 13) ? 20 : 1;
+        for (size_t i = 0; i < count; i++) {
+            events.push_back(create_test_event(id++, Severity::ERROR, "Error",
+                base + std::chrono::minutes(minute)));
+        }
+    }
+    
+    ErrorBurstConfig config;
+    config.min_errors_for_burst = 5;
+    Stats stats = StatsBuilder().build(events);
+    auto anomalies = ErrorBurstDetector(config).detect(events, stats);
+    
+    REQUIRE(anomalies.size() == 1);
+    REQUIRE(anomalies[0].start_time == base + std::chrono::minutes(10));
+    REQUIRE(anomalies[0].end_time == base + std::chrono::minutes(13));
+    REQUIRE(anomalies[0].description == "Error burst detected: 60 errors in 3 minutes");
+}
+
 TEST_CASE("ErrorBurstDetector ignores low error counts", "[anomaly][error_burst]") {
     ErrorBurstConfig config;
     config.min_errors_for_burst = 100;
@@ -267,6 +944,477 @@ TEST_CASE("ErrorBurstDetector handles no errors", "[anomaly][error_burst]") {
     REQUIRE(anomalies.empty());
 }
 
+// ============================================================================
+// RollingBurstDetector Tests
+// ============================================================================
+
+// Errors per minute from `counts`, starting at base
+std::vector<Event> create_rolling_burst_events(const std::vector<size_t>& counts,
+                                               std::chrono::system_clock::time_point base) {
+    std::vector<Event> events;
+    EventId id = 1;
+    for (size_t minute = 0; minute < counts.size(); minute++) {
+        for (size_t i = 0; i < counts[minute]; i++) {
+            events.push_back(create_test_event(id++, Severity::ERROR, "Error",
+                base + std::chrono::minutes(minute) + std::chrono::seconds(i % 60)));
+        }
+    }
+    return events;
+}
+
+TEST_CASE("RollingBurstDetector reports one anomaly per run of hot buckets", "[anomaly][rolling_burst]") {
+    auto base = std::chrono::system_clock::time_point(std::chrono::hours(24 * 365 * 50));
+    std::vector<size_t> counts(40, 1);
+    counts[30] = counts[31] = counts[32] = 20;
+    auto events = create_rolling_burst_events(counts, base);
+    
+    RollingBurstConfig config;
+    config.max_evidence = 5;
+    RollingBurstDetector detector(config);
+    
+    auto anomalies = detector.detect(events);
+    REQUIRE(anomalies.size() == 1);
+    REQUIRE(anomalies[0].type == Anomaly::Type::ERROR_BURST);
+    REQUIRE(anomalies[0].start_time == base + std::chrono::minutes(30));
+    REQUIRE(anomalies[0].end_time == base + std::chrono::minutes(33));
+    REQUIRE(anomalies[0].evidence_ids.size() == 5);
+    REQUIRE(anomalies[0].description.find("60 errors in 3 minutes") != std::string::npos);
+    REQUIRE(anomalies[0].confidence > 0.0);
+    
+    // The series path finds the same burst
+    Stats stats = StatsBuilder().build(events);
+    auto from_series = detector.detect(stats.severity_time_series.at(Severity::ERROR));
+    REQUIRE(from_series.size() == 1);
+    REQUIRE(from_series[0].start_time == anomalies[0].start_time);
+    REQUIRE(from_series[0].end_time == anomalies[0].end_time);
+}
+
+TEST_CASE("RollingBurstDetector finds bursts inside one partition", "[anomaly][rolling_burst][partition]") {
+    auto base = std::chrono::system_clock::time_point(std::chrono::hours(24 * 365 * 50));
+    std::vector<size_t> checkout_counts(40, 1);
+    checkout_counts[30] = checkout_counts[31] = checkout_counts[32] = 20;
+    auto events = create_rolling_burst_events(checkout_counts, base);
+    for (auto& e : events) {
+        e.tags["service"] = "checkout";
+    }
+    auto api = create_rolling_burst_events(std::vector<size_t>(40, 2), base);
+    for (auto& e : api) {
+        e.tags["service"] = "api";
+        events.push_back(e);
+    }
+    
+    StatsConfig config;
+    config.partition_by = "service";
+    Stats stats = StatsBuilder(config).build(events);
+    
+    RollingBurstDetector detector;
+    auto anomalies = detector.detect(stats.partitions);
+    REQUIRE(anomalies.size() == 1);
+    REQUIRE(anomalies[0].source == "service=checkout");
+    REQUIRE(anomalies[0].start_time == base + std::chrono::minutes(30));
+    REQUIRE(anomalies[0].description.rfind("Error burst detected in 'service=checkout': 60 errors", 0) == 0);
+    
+    REQUIRE(detector.detect(PartitionedStats()).empty());
+}
+
+TEST_CASE("RollingBurstDetector scans partitions at a coarser resolution", "[anomaly][rolling_burst][partition]") {
+    auto base = std::chrono::system_clock::time_point(std::chrono::hours(24 * 365 * 50));
+    std::vector<size_t> counts(120, 1);
+    counts[101] = counts[102] = counts[103] = 20;
+    auto events = create_rolling_burst_events(counts, base);
+    for (auto& e : events) {
+        e.tags["service"] = "checkout";
+    }
+    
+    StatsConfig config;
+    config.partition_by = "service";
+    Stats stats = StatsBuilder(config).build(events);
+    
+    auto anomalies = RollingBurstDetector().detect(stats.partitions, std::chrono::minutes(5));
+    REQUIRE(anomalies.size() == 1);
+    REQUIRE(anomalies[0].source == "service=checkout");
+    REQUIRE(anomalies[0].start_time == base + std::chrono::minutes(100));
+    REQUIRE(*anomalies[0].end_time - *anomalies[0].start_time == std::chrono::minutes(5));
+}
+
+TEST_CASE("RollingBurstDetector emits a burst when it closes", "[anomaly][rolling_burst]") {
+    auto base = std::chrono::system_clock::time_point(std::chrono::hours(24 * 365 * 50));
+    RollingBurstDetector detector;
+    
+    for (int minute = 0; minute < 20; minute++) {
+        REQUIRE_FALSE(detector.add_bucket(base + std::chrono::minutes(minute), 2).has_value());
+    }
+    REQUIRE(std::abs(detector.baseline() - 2.0) < 0.5);
+    
+    // Hot buckets extend the open burst without emitting it
+    REQUIRE_FALSE(detector.add_bucket(base + std::chrono::minutes(20), 40).has_value());
+    REQUIRE_FALSE(detector.add_bucket(base + std::chrono::minutes(21), 35).has_value());
+    REQUIRE(detector.baseline() < 10.0);
+    
+    auto closed = detector.add_bucket(base + std::chrono::minutes(22), 2);
+    REQUIRE(closed.has_value());
+    REQUIRE(closed->start_time == base + std::chrono::minutes(20));
+    REQUIRE(closed->end_time == base + std::chrono::minutes(22));
+    
+    // A burst still open at the end comes out of flush(); so does the burst
+    // ended by a silent gap
+    REQUIRE_FALSE(detector.add_bucket(base + std::chrono::minutes(23), 50).has_value());
+    auto gap_closed = detector.add_bucket(base + std::chrono::minutes(30), 60);
+    REQUIRE(gap_closed.has_value());
+    REQUIRE(gap_closed->end_time == base + std::chrono::minutes(24));
+    auto flushed = detector.flush();
+    REQUIRE(flushed.size() == 1);
+    REQUIRE(flushed[0].start_time == base + std::chrono::minutes(30));
+}
+
+TEST_CASE("RollingBurstDetector finds bursts a global baseline hides", "[anomaly][rolling_burst]") {
+    auto base = std::chrono::system_clock::time_point(std::chrono::hours(24 * 365 * 50));
+    
+    // A busy first hour, then a quiet hour with a short spike
+    std::vector<size_t> counts(120, 1);
+    for (size_t minute = 0; minute < 60; minute++) {
+        counts[minute] = 20;
+    }
+    counts[100] = 30;
+    auto events = create_rolling_burst_events(counts, base);
+    Stats stats = StatsBuilder().build(events);
+    
+    auto covers_spike = [&base](const Anomaly& a) {
+        return *a.start_time <= base + std::chrono::minutes(100) &&
+               *a.end_time > base + std::chrono::minutes(100);
+    };
+    
+    auto global = ErrorBurstDetector().detect(events, stats);
+    REQUIRE(std::none_of(global.begin(), global.end(), covers_spike));
+    
+    // The busy hour seeds the baseline rather than being reported
+    auto rolling = RollingBurstDetector().detect(stats.severity_time_series.at(Severity::ERROR));
+    REQUIRE(rolling.size() == 1);
+    REQUIRE(covers_spike(rolling[0]));
+}
+
+TEST_CASE("RollingBurstDetector warms up before judging a steady rate", "[anomaly][rolling_burst]") {
+    auto base = std::chrono::system_clock::time_point(std::chrono::hours(24 * 365 * 50));
+    auto events = create_rolling_burst_events(std::vector<size_t>(300, 50), base);
+    
+    RollingBurstDetector detector;
+    REQUIRE(detector.detect(events).empty());
+    Stats stats = StatsBuilder().build(events);
+    REQUIRE(detector.detect(stats.severity_time_series.at(Severity::ERROR)).empty());
+    
+    // A burst in the warm-up seeds the baseline instead of being reported
+    RollingBurstDetector early;
+    for (int minute = 0; minute < 10; minute++) {
+        REQUIRE_FALSE(early.add_bucket(base + std::chrono::minutes(minute), minute < 3 ? 40 : 2).has_value());
+    }
+    REQUIRE(early.flush().empty());
+    REQUIRE(std::abs(early.baseline() - 13.4) < 0.01);
+}
+
+// ============================================================================
+// MultiWindowBurstDetector Tests
+// ============================================================================
+
+TEST_CASE("MultiWindowBurstDetector reports a sharp spike at the short window", "[anomaly][multi_window]") {
+    auto base = std::chrono::system_clock::time_point(std::chrono::hours(24 * 365 * 50));
+    auto events = create_rolling_burst_events(std::vector<size_t>(60, 1), base);
+    
+    // 15 errors within 15 seconds in minute 40
+    EventId id = 1000;
+    for (int i = 0; i < 15; i++) {
+        events.push_back(create_test_event(id++, Severity::ERROR, "Spike",
+            base + std::chrono::minutes(40) + std::chrono::seconds(20 + i)));
+    }
+    
+    auto anomalies = MultiWindowBurstDetector().detect(events);
+    REQUIRE(anomalies.size() == 1);
+    REQUIRE(anomalies[0].window == std::chrono::seconds(30));
+    REQUIRE(*anomalies[0].start_time >= base + std::chrono::minutes(40));
+    REQUIRE(*anomalies[0].end_time <= base + std::chrono::minutes(41));
+    REQUIRE(anomalies[0].evidence_ids.size() == 10);
+    REQUIRE(anomalies[0].description.find("30s window") != std::string::npos);
+}
+
+TEST_CASE("MultiWindowBurstDetector catches a slow climb at long windows", "[anomaly][multi_window]") {
+    auto base = std::chrono::system_clock::time_point(std::chrono::hours(24 * 365 * 50));
+    std::vector<size_t> counts(60, 1);
+    for (size_t rate : {2, 2, 3, 3, 3, 4, 4, 4, 5, 5, 5, 6, 6, 6, 7}) {
+        counts.push_back(rate);
+    }
+    auto events = create_rolling_burst_events(counts, base);
+    
+    // No single minute has enough errors to matter
+    REQUIRE(RollingBurstDetector().detect(events).empty());
+    
+    auto anomalies = MultiWindowBurstDetector().detect(events);
+    REQUIRE(anomalies.size() == 1);
+    REQUIRE(anomalies[0].window >= std::chrono::minutes(5));
+    REQUIRE(*anomalies[0].start_time < base + std::chrono::minutes(70));
+    REQUIRE(*anomalies[0].end_time > base + std::chrono::minutes(70));
+    
+    // No errors, no bursts
+    REQUIRE(MultiWindowBurstDetector().detect(EventView()).empty());
+}
+
+// ============================================================================
+// MissingHeartbeatDetector Tests
+// ============================================================================
+
+// One event every `period` from `source`, skipping [gap_from, gap_to)
+std::vector<Event> create_heartbeat_events(const std::string& source, size_t count,
+                                           std::chrono::seconds period,
+                                           size_t gap_from = 0, size_t gap_to = 0,
+                                           EventId first_id = 1) {
+    auto base = std::chrono::system_clock::time_point() + std::chrono::hours(24 * 365 * 50);
+    std::vector<Event> events;
+    for (size_t i = 0; i < count; ++i) {
+        if (i >= gap_from && i < gap_to) {
+            continue;
+        }
+        Event e = create_test_event(first_id + i, Severity::INFO, "heartbeat ok",
+                                    base + period * static_cast<int>(i));
+        e.src.source_path = source;
+        events.push_back(e);
+    }
+    return events;
+}
+
+TEST_CASE("MissingHeartbeatDetector learns each source's period", "[anomaly][heartbeat]") {
+    MissingHeartbeatDetector detector;
+    for (const auto& e : create_heartbeat_events("api.log", 20, std::chrono::seconds(10))) {
+        REQUIRE_FALSE(detector.add_event(e).has_value());
+    }
+    REQUIRE(detector.period("api.log") == std::chrono::milliseconds(10000));
+    REQUIRE_FALSE(detector.period("other.log").has_value());
+    REQUIRE(detector.stream_count() == 1);
+}
+
+TEST_CASE("MissingHeartbeatDetector reports a silence when the source resumes", "[anomaly][heartbeat]") {
+    // 30s cadence, then 20 missing beats (10 minutes)
+    auto events = create_heartbeat_events("api.log", 60, std::chrono::seconds(30), 20, 40);
+    
+    auto anomalies = MissingHeartbeatDetector().detect(events);
+    REQUIRE(anomalies.size() == 1);
+    const auto& silence = anomalies[0];
+    REQUIRE(silence.type == Anomaly::Type::MISSING_HEARTBEAT);
+    REQUIRE(silence.evidence_ids == std::vector<EventId>{20, 41});
+    REQUIRE(*silence.end_time - *silence.start_time == std::chrono::minutes(10) + std::chrono::seconds(30));
+    REQUIRE(silence.description.find("api.log") != std::string::npos);
+    REQUIRE(silence.description.find("~30s") != std::string::npos);
+    REQUIRE(silence.confidence > 0.5);
+}
+
+TEST_CASE("MissingHeartbeatDetector reports sources that stop before the input ends", "[anomaly][heartbeat]") {
+    // db.log stops after 5 minutes while api.log keeps going for 30
+    auto events = create_heartbeat_events("api.log", 180, std::chrono::seconds(10));
+    auto db = create_heartbeat_events("db.log", 30, std::chrono::seconds(10), 0, 0, 1000);
+    events.insert(events.end(), db.begin(), db.end());
+    
+    auto anomalies = MissingHeartbeatDetector().detect(events);
+    REQUIRE(anomalies.size() == 1);
+    REQUIRE(anomalies[0].description.find("db.log") != std::string::npos);
+    REQUIRE(anomalies[0].evidence_ids == std::vector<EventId>{1029});
+    REQUIRE(*anomalies[0].end_time == events[179].ts->tp);
+    
+    HeartbeatConfig config;
+    config.report_trailing = false;
+    REQUIRE(MissingHeartbeatDetector(config).detect(events).empty());
+}
+
+TEST_CASE("MissingHeartbeatDetector ignores a rotated file handing over to the next", "[anomaly][heartbeat]") {
+    // app.log.1 holds the first 30 minutes and app.log the next 30, one
+    // event every 10s throughout
+    auto events = create_heartbeat_events("app.log.1", 360, std::chrono::seconds(10), 180, 360);
+    auto current = create_heartbeat_events("app.log", 360, std::chrono::seconds(10), 0, 180, 1000);
+    events.insert(events.end(), current.begin(), current.end());
+    REQUIRE(MissingHeartbeatDetector().detect(events).empty());
+    
+    // Compressed and dated rotations hand over too; a different file that
+    // stops early is still reported
+    for (auto& event : events) {
+        if (event.src.source_path == "app.log.1") {
+            event.src.source_path = "logs/app.log-20240306.gz";
+        } else {
+            event.src.source_path = "logs/app.log";
+        }
+    }
+    auto worker = create_heartbeat_events("worker-1.log", 60, std::chrono::seconds(10), 0, 0, 5000);
+    events.insert(events.end(), worker.begin(), worker.end());
+    auto anomalies = MissingHeartbeatDetector().detect(events);
+    REQUIRE(anomalies.size() == 1);
+    REQUIRE(anomalies[0].source == "worker-1.log");
+}
+
+TEST_CASE("MissingHeartbeatDetector tolerates jitter and slow sources", "[anomaly][heartbeat]") {
+    // Gaps alternate 5s and 25s: no gap exceeds min_silence
+    auto base = std::chrono::system_clock::time_point() + std::chrono::hours(24 * 365 * 50);
+    std::vector<Event> events;
+    auto tp = base;
+    for (EventId i = 1; i <= 40; ++i) {
+        events.push_back(create_test_event(i, Severity::INFO, "tick", tp));
+        tp += std::chrono::seconds(i % 2 == 0 ? 5 : 25);
+    }
+    REQUIRE(MissingHeartbeatDetector().detect(events).empty());
+    
+    // A 75s gap at a 15s cadence clears min_silence but not 5x the period
+    auto slow = create_heartbeat_events("slow.log", 30, std::chrono::seconds(15), 10, 14);
+    REQUIRE(MissingHeartbeatDetector().detect(slow).empty());
+    
+    // Sub-second chatter folds into 1s beats instead of a zero period
+    HeartbeatConfig config;
+    config.min_silence = std::chrono::seconds(10);
+    std::vector<Event> chatty;
+    for (EventId i = 0; i < 100; ++i) {
+        chatty.push_back(create_test_event(i + 1, Severity::INFO, "req",
+                                           base + std::chrono::milliseconds(200 * i)));
+    }
+    chatty.push_back(create_test_event(200, Severity::INFO, "req", base + std::chrono::seconds(35)));
+    auto anomalies = MissingHeartbeatDetector(config).detect(chatty);
+    REQUIRE(anomalies.size() == 1);
+    REQUIRE(anomalies[0].evidence_ids == std::vector<EventId>{100, 200});
+}
+
+TEST_CASE("MissingHeartbeatDetector keys streams by tag", "[anomaly][heartbeat]") {
+    HeartbeatConfig config;
+    config.key_tag = "service";
+    
+    auto events = create_heartbeat_events("all.log", 60, std::chrono::seconds(10));
+    for (size_t i = 0; i < events.size(); ++i) {
+        // "cart" logs on even ticks until tick 20, "auth" on odd ticks throughout
+        if (i % 2 == 0) {
+            events[i].tags["service"] = i < 20 ? "cart" : "";
+        } else {
+            events[i].tags["service"] = "auth";
+        }
+    }
+    
+    // One shared file never goes quiet
+    REQUIRE(MissingHeartbeatDetector().detect(events).empty());
+    
+    auto anomalies = MissingHeartbeatDetector(config).detect(events);
+    REQUIRE(anomalies.size() == 1);
+    REQUIRE(anomalies[0].description.find("service=cart") != std::string::npos);
+}
+
+// ============================================================================
+// ChangePointDetector Tests
+// ============================================================================
+
+// Series with one bucket per count, starting at a minute boundary
+TimeSeries create_change_point_series(const std::vector<size_t>& counts) {
+    auto base = std::chrono::system_clock::time_point() + std::chrono::hours(24 * 365 * 50);
+    TimeSeries series(std::chrono::minutes(1));
+    for (size_t i = 0; i < counts.size(); ++i) {
+        if (counts[i] > 0) {
+            series.add_count(base + std::chrono::minutes(i), counts[i]);
+        }
+    }
+    return series;
+}
+
+// `n` buckets of a repeating pattern
+std::vector<size_t> repeat_counts(const std::vector<size_t>& pattern, size_t n) {
+    std::vector<size_t> counts;
+    for (size_t i = 0; i < n; ++i) {
+        counts.push_back(pattern[i % pattern.size()]);
+    }
+    return counts;
+}
+
+TEST_CASE("ChangePointDetector finds a lasting rise in a low error rate", "[anomaly][change_point]") {
+    // ~0.2 errors per minute, then ~2 per minute for half an hour
+    auto counts = repeat_counts({0, 0, 1, 0, 0, 0, 1, 0, 0, 0}, 40);
+    auto after = repeat_counts({2, 3, 1, 2, 2}, 30);
+    counts.insert(counts.end(), after.begin(), after.end());
+    auto series = create_change_point_series(counts);
+    
+    auto shifts = ChangePointDetector().detect(series);
+    REQUIRE(shifts.size() == 1);
+    const auto& shift = shifts[0];
+    REQUIRE(shift.type == Anomaly::Type::LEVEL_SHIFT);
+    REQUIRE(*shift.start_time == series.points.front().timestamp + std::chrono::minutes(38));
+    REQUIRE(std::abs(shift.rate_before - 0.2) < 1e-9);
+    REQUIRE(shift.rate_after == 2.0);
+    REQUIRE(shift.description.find("rose from 0.20 to 2.00 per minute") != std::string::npos);
+}
+
+TEST_CASE("ChangePointDetector leaves short spikes to the burst detectors", "[anomaly][change_point]") {
+    auto counts = repeat_counts({0, 0, 1, 0, 0, 0, 1, 0, 0, 0}, 60);
+    counts[30] = 50;
+    counts[31] = 40;
+    REQUIRE(ChangePointDetector().detect(create_change_point_series(counts)).empty());
+}
+
+TEST_CASE("ChangePointDetector finds a lasting drop", "[anomaly][change_point]") {
+    auto counts = repeat_counts({98, 103, 100, 95, 104}, 30);
+    auto after = repeat_counts({31, 28, 30, 33, 28}, 30);
+    counts.insert(counts.end(), after.begin(), after.end());
+    
+    auto shifts = ChangePointDetector().detect(create_change_point_series(counts));
+    REQUIRE(shifts.size() == 1);
+    REQUIRE(std::abs(shifts[0].rate_before - 100.0) < 1e-9);
+    REQUIRE(shifts[0].rate_after < 35.0);
+    REQUIRE(shifts[0].description.find("fell") != std::string::npos);
+}
+
+TEST_CASE("ChangePointDetector streams buckets and fills gaps with zeros", "[anomaly][change_point]") {
+    auto base = std::chrono::system_clock::time_point() + std::chrono::hours(24 * 365 * 50);
+    ChangePointDetector detector;
+    std::vector<Anomaly> shifts;
+    
+    // Quiet for 20 minutes: only the first bucket is fed
+    auto first = detector.add_bucket(base, 0);
+    REQUIRE(first.empty());
+    for (int minute = 20; minute < 40; ++minute) {
+        for (auto& shift : detector.add_bucket(base + std::chrono::minutes(minute), 4)) {
+            shifts.push_back(std::move(shift));
+        }
+    }
+    REQUIRE(shifts.size() == 1);
+    REQUIRE(*shifts[0].start_time == base + std::chrono::minutes(20));
+    REQUIRE(shifts[0].rate_before == 0.0);
+    REQUIRE(shifts[0].rate_after == 4.0);
+    REQUIRE(shifts[0].confidence > 0.9);
+}
+
+TEST_CASE("ChangePointDetector scans stats and sources over their full range", "[anomaly][change_point]") {
+    auto base = std::chrono::system_clock::time_point() + std::chrono::hours(24 * 365 * 50);
+    std::vector<Event> events;
+    EventId id = 1;
+    for (int minute = 0; minute < 60; ++minute) {
+        auto tp = base + std::chrono::minutes(minute);
+        for (const char* source : {"a.log", "b.log"}) {
+            Event e = create_test_event(id++, Severity::INFO, "request served", tp);
+            e.src.source_path = source;
+            events.push_back(e);
+        }
+        // b.log starts failing halfway through
+        if (minute >= 30) {
+            for (int i = 0; i < 3; ++i) {
+                Event e = create_test_event(id++, Severity::ERROR, "upstream failed", tp);
+                e.src.source_path = "b.log";
+                events.push_back(e);
+            }
+        }
+    }
+    
+    Stats stats = StatsBuilder().build(events);
+    ChangePointDetector detector;
+    
+    // The ERROR series only starts at minute 30; the stats range pads it
+    auto shifts = detector.detect(stats);
+    REQUIRE(shifts.size() == 1);
+    REQUIRE(shifts[0].severity == Severity::ERROR);
+    REQUIRE(*shifts[0].start_time == base + std::chrono::minutes(30));
+    REQUIRE(shifts[0].rate_after == 3.0);
+    REQUIRE(shifts[0].description.find("ERROR rate rose") != std::string::npos);
+    
+    auto by_source = detector.detect_by_source(events, Severity::ERROR);
+    REQUIRE(by_source.size() == 1);
+    REQUIRE(by_source[0].source == "b.log");
+    REQUIRE(by_source[0].description.find("'b.log'") != std::string::npos);
+}
+
 // ============================================================================
 // RestartLoopDetector Tests
 // ============================================================================
@@ -291,6 +1439,43 @@ TEST_CASE("RestartLoopDetector detects restart loop", "[anomaly][restart_loop]")
     REQUIRE_FALSE(anomalies.empty());
     REQUIRE(anomalies[0].type == Anomaly::Type::RESTART_LOOP);
     REQUIRE(anomalies[0].evidence_ids.size() >= 3);
+    
+    // Restart candidates from precomputed feature bits
+    EventFeatures features;
+    features.build(events);
+    auto from_features = detector.detect(events, features);
+    REQUIRE(from_features.size() == anomalies.size());
+    REQUIRE(from_features[0].evidence_ids == anomalies[0].evidence_ids);
+}
+
+TEST_CASE("RestartLoopDetector keeps custom keywords on the features path", "[anomaly][restart_loop]") {
+    RestartLoopConfig config;
+    config.restart_keywords = {"respawn"};
+    RestartLoopDetector detector(config);
+    
+    std::vector<Event> events;
+    auto now = std::chrono::system_clock::now();
+    for (int i = 0; i < 3; i++) {
+        events.push_back(create_test_event(i + 1, Severity::INFO, "worker respawn",
+            now + std::chrono::minutes(i)));
+    }
+    
+    // Default feature bits know nothing of "respawn"; the detector scans instead
+    EventFeatures features;
+    features.build(events);
+    REQUIRE(features.positions(Feature::RESTART).empty());
+    auto anomalies = detector.detect(events, features);
+    REQUIRE(anomalies.size() == 1);
+    REQUIRE(anomalies[0].evidence_ids.size() == 3);
+    
+    // Bits extracted with the same keywords are used directly
+    EventFeatureConfig feature_config;
+    feature_config.restart_keywords = config.restart_keywords;
+    EventFeatures custom(feature_config);
+    custom.build(events);
+    REQUIRE(custom.matches_keywords(Feature::RESTART, config.restart_keywords));
+    REQUIRE(detector.detect(events, custom).size() == 1);
+    REQUIRE(RestartLoopConfig().restart_keywords == default_keywords(Feature::RESTART));
 }
 
 TEST_CASE("RestartLoopDetector ignores isolated restarts", "[anomaly][restart_loop]") {
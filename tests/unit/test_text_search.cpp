@@ -0,0 +1,80 @@
+#include <catch2/catch_test_macros.hpp>
+#include "logstory/core/text_search.hpp"
+#include <algorithm>
+#include <cctype>
+#include <string>
+
+using namespace logstory::core;
+
+namespace {
+
+// Reference result: lowercase copy + std::string::find
+size_t reference_find(const std::string& haystack, const std::string& lower_needle) {
+    std::string lower = haystack;
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return lower.find(lower_needle);
+}
+
+} // namespace
+
+TEST_CASE("find_ignore_case handles empty and oversized needles", "[text_search]") {
+    REQUIRE(find_ignore_case("anything", "") == 0);
+    REQUIRE(find_ignore_case("", "") == 0);
+    REQUIRE(find_ignore_case("", "a") == std::string_view::npos);
+    REQUIRE(find_ignore_case("err", "error") == std::string_view::npos);
+}
+
+TEST_CASE("find_ignore_case matches regardless of haystack case", "[text_search]") {
+    REQUIRE(find_ignore_case("Connection TIMEOUT after 30s", "timeout") == 11);
+    REQUIRE(find_ignore_case("ERROR", "error") == 0);
+    REQUIRE(find_ignore_case("x", "x") == 0);
+    REQUIRE(find_ignore_case("aX", "x") == 1);
+    REQUIRE(contains_ignore_case("Service ReStArTeD", "restarted"));
+    REQUIRE_FALSE(contains_ignore_case("Service restart", "restarted"));
+}
+
+TEST_CASE("find_ignore_case does not fold non-letters", "[text_search]") {
+    // '@' and '`' differ only in bit 0x20, as do '[' and '{'
+    REQUIRE_FALSE(contains_ignore_case("user`host", "user@host"));
+    REQUIRE_FALSE(contains_ignore_case("{x}", "[x]"));
+    REQUIRE(contains_ignore_case("USER@HOST", "user@host"));
+    REQUIRE(find_ignore_case("path [ERR:5]", "err:") == 6);
+}
+
+TEST_CASE("find_ignore_case finds matches across block boundaries", "[text_search]") {
+    const std::string needle = "timeout";
+    for (size_t len = needle.size(); len < 70; ++len) {
+        for (size_t pos = 0; pos + needle.size() <= len; ++pos) {
+            std::string haystack(len, '.');
+            haystack.replace(pos, needle.size(), "TimeOut");
+            REQUIRE(find_ignore_case(haystack, needle) == pos);
+        }
+        // Near misses on the first and last byte never match
+        std::string near_miss(len, '.');
+        near_miss.replace(len - needle.size(), needle.size(), "timeouX");
+        REQUIRE(find_ignore_case(near_miss, needle) == std::string_view::npos);
+    }
+}
+
+TEST_CASE("find_ignore_case agrees with lowercase-copy search", "[text_search]") {
+    const std::string haystack =
+        "2024-01-15 10:00:00 WARN Retrying request (attempt 3) ... retry OK; "
+        "RETRY budget exhausted, Timeout waiting for upstream [err:504] rEtRy";
+    for (const std::string needle : {"retry", "r", "ry", "timeout", "err:504]", "ok;",
+                                     "budget exhausted", "missing", "rEtRy"}) {
+        std::string lower = needle;
+        std::transform(lower.begin(), lower.end(), lower.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        REQUIRE(find_ignore_case(haystack, lower) == reference_find(haystack, lower));
+    }
+}
+
+TEST_CASE("equals_ignore_case compares ASCII case-insensitively", "[text_search]") {
+    REQUIRE(equals_ignore_case(".LOG", ".log"));
+    REQUIRE(equals_ignore_case("", ""));
+    REQUIRE_FALSE(equals_ignore_case(".log", ".logs"));
+    REQUIRE_FALSE(equals_ignore_case("@", "`"));
+    REQUIRE(ascii_lower('Q') == 'q');
+    REQUIRE(ascii_lower('[') == '[');
+}